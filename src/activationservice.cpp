@@ -0,0 +1,154 @@
+#include "activationservice.h"
+#include "config.h"
+#include <QDebug>
+#include <QMetaObject>
+#include <QMutexLocker>
+
+namespace
+{
+    constexpr int ConfirmPollMs = 2;
+}
+
+ActivationService::ActivationService(QObject *parent)
+    : QObject(parent), m_latestRequest(0)
+{
+    m_thread.setObjectName("ActivationService");
+    m_worker.moveToThread(&m_thread);
+    m_thread.start();
+}
+
+ActivationService::~ActivationService()
+{
+    // Abandon queued requests and let the one in progress stop at its next check
+    ++m_latestRequest;
+    m_thread.quit();
+    m_thread.wait();
+}
+
+void ActivationService::activate(HWND hwnd)
+{
+    QElapsedTimer clock;
+    clock.start();
+    const quint64 request = ++m_latestRequest;
+    const int confirmTimeoutMs = WinSelectorConfig::Activation::confirmTimeoutMs();
+
+    {
+        QMutexLocker locker(&m_metricsMutex);
+        ++m_metrics.requests;
+    }
+
+    QMetaObject::invokeMethod(&m_worker, [this, hwnd, request, clock, confirmTimeoutMs]()
+                              { run(hwnd, request, clock, confirmTimeoutMs); },
+                              Qt::QueuedConnection);
+}
+
+void ActivationService::run(HWND hwnd, quint64 request, QElapsedTimer clock, int confirmTimeoutMs)
+{
+    using Strategy = Win32Utils::ActivationStrategy;
+
+    bool success = false;
+    Strategy strategy = Strategy::Direct;
+    for (int i = 0; i < StrategyCount; ++i)
+    {
+        if (m_latestRequest.loadAcquire() != request)
+        {
+            QMutexLocker locker(&m_metricsMutex);
+            ++m_metrics.superseded;
+            return;
+        }
+        if (!Win32Utils::isValidWindow(hwnd))
+        {
+            break;
+        }
+
+        strategy = static_cast<Strategy>(i);
+        // A rejected request can still be followed by activation (the system
+        // flashes the taskbar button instead), so always confirm
+        Win32Utils::requestForeground(hwnd, strategy);
+        if (waitForForeground(hwnd, confirmTimeoutMs))
+        {
+            success = true;
+            break;
+        }
+    }
+
+    const qint64 latencyMs = clock.elapsed();
+    record(success, strategy, latencyMs);
+    if (!success)
+    {
+        qWarning() << "ActivationService: window did not come to the foreground after"
+                   << latencyMs << "ms";
+    }
+
+    // Delivered on the GUI thread through the queued connection
+    QMetaObject::invokeMethod(this, [this, hwnd, success, latencyMs]()
+                              { emit finished(hwnd, success, latencyMs); },
+                              Qt::QueuedConnection);
+}
+
+bool ActivationService::waitForForeground(HWND hwnd, int timeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (true)
+    {
+        if (Win32Utils::getForegroundWindow() == hwnd)
+        {
+            return true;
+        }
+        if (timer.elapsed() >= timeoutMs)
+        {
+            return false;
+        }
+        QThread::msleep(ConfirmPollMs);
+    }
+}
+
+void ActivationService::record(bool success, Win32Utils::ActivationStrategy strategy, qint64 latencyMs)
+{
+    QMutexLocker locker(&m_metricsMutex);
+    if (!success)
+    {
+        ++m_metrics.failed;
+        return;
+    }
+
+    ++m_metrics.succeeded;
+    ++m_metrics.succeededBy[static_cast<int>(strategy)];
+
+    int bucket = 0;
+    while (bucket < LatencyBucketCount - 1 && latencyMs >= LatencyBucketBoundsMs[bucket])
+    {
+        ++bucket;
+    }
+    ++m_metrics.latencyBuckets[bucket];
+}
+
+ActivationService::Metrics ActivationService::metrics() const
+{
+    QMutexLocker locker(&m_metricsMutex);
+    return m_metrics;
+}
+
+void ActivationService::report() const
+{
+    const Metrics m = metrics();
+    const quint64 completed = m.succeeded + m.failed;
+    const double successRate = completed ? 100.0 * m.succeeded / completed : 0.0;
+    qDebug() << "Activation -" << m.requests << "requests," << m.succeeded << "succeeded,"
+             << m.failed << "failed," << m.superseded << "superseded," << successRate << "% success";
+    qDebug() << "Activation strategies - direct:" << m.succeededBy[0]
+             << "altKeyUnlock:" << m.succeededBy[1] << "attachInput:" << m.succeededBy[2];
+
+    for (int i = 0; i < LatencyBucketCount; ++i)
+    {
+        if (i < LatencyBucketCount - 1)
+        {
+            qDebug() << "Activation latency <" << LatencyBucketBoundsMs[i] << "ms:" << m.latencyBuckets[i];
+        }
+        else
+        {
+            qDebug() << "Activation latency >=" << LatencyBucketBoundsMs[i - 1] << "ms:" << m.latencyBuckets[i];
+        }
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef ACTIVATIONSERVICE_H
+#define ACTIVATIONSERVICE_H
+
+#include "win32utils.h"
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QObject>
+#include <QThread>
+
+/**
+ * @brief Brings windows to the foreground on a worker thread
+ *
+ * Each request tries the Win32Utils::ActivationStrategy values in order until
+ * GetForegroundWindow() reports the target, so a foreground-lock refusal is
+ * retried with a stronger strategy instead of needing a second click. A newer
+ * request supersedes one still in progress. Click-to-foreground latency and the
+ * success rate per strategy are collected in Metrics.
+ */
+class ActivationService : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Upper bounds (exclusive, in milliseconds) of the latency histogram buckets;
+     * the last bucket collects everything slower
+     */
+    static constexpr int LatencyBucketBoundsMs[] = {8, 16, 32, 64, 128, 256, 512};
+    static constexpr int LatencyBucketCount = sizeof(LatencyBucketBoundsMs) / sizeof(int) + 1;
+    static constexpr int StrategyCount = static_cast<int>(Win32Utils::ActivationStrategy::Count);
+
+    /**
+     * @brief Activation counters since startup
+     */
+    struct Metrics
+    {
+        quint64 requests = 0;
+        quint64 succeeded = 0;
+        quint64 failed = 0;
+        quint64 superseded = 0;                      ///< Abandoned for a newer request
+        quint64 succeededBy[StrategyCount] = {};     ///< Successes per final strategy
+        quint64 latencyBuckets[LatencyBucketCount] = {};
+    };
+
+    /**
+     * @brief Construct a new ActivationService and start its worker thread
+     * @param parent Parent object
+     */
+    explicit ActivationService(QObject *parent = nullptr);
+
+    /**
+     * @brief Stop the worker thread
+     */
+    ~ActivationService();
+
+    /**
+     * @brief Queue activation of a window; returns immediately
+     * @param hwnd Window handle
+     */
+    void activate(HWND hwnd);
+
+    /**
+     * @brief Get a copy of the counters
+     * @return Metrics
+     */
+    Metrics metrics() const;
+
+    /**
+     * @brief Log the success rate and latency histogram
+     */
+    void report() const;
+
+signals:
+    /**
+     * @brief Emitted on the GUI thread when a request finished (not when superseded)
+     * @param hwnd Handle of the window
+     * @param success true if the window became the foreground window
+     * @param latencyMs Time from activate() to the result
+     */
+    void finished(HWND hwnd, bool success, qint64 latencyMs);
+
+private:
+    QThread m_thread;
+    QObject m_worker; ///< Context object living on m_thread
+    QAtomicInteger<quint64> m_latestRequest;
+    mutable QMutex m_metricsMutex;
+    Metrics m_metrics;
+
+    /**
+     * @brief Run the strategies for one request (worker thread)
+     * @param hwnd Window handle
+     * @param request Request number; work stops once a newer one exists
+     * @param clock Started when the request was made
+     * @param confirmTimeoutMs How long to wait for each strategy to take effect
+     */
+    void run(HWND hwnd, quint64 request, QElapsedTimer clock, int confirmTimeoutMs);
+
+    /**
+     * @brief Wait until a window is the foreground window
+     * @param hwnd Window handle
+     * @param timeoutMs Maximum time to wait
+     * @return true if it became the foreground window in time
+     */
+    static bool waitForForeground(HWND hwnd, int timeoutMs);
+
+    void record(bool success, Win32Utils::ActivationStrategy strategy, qint64 latencyMs);
+};
+
+#endif // ACTIVATIONSERVICE_H
@@ -0,0 +1,222 @@
+#include "activityjournal.h"
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtEndian>
+#include <cstring>
+
+namespace
+{
+    constexpr char FileMagic[4] = {'W', 'S', 'J', 'L'};
+    constexpr quint16 FileVersion = 1;
+    constexpr qsizetype FileHeaderSize = 8;
+    constexpr size_t RecordHeaderSize = ActivityJournal::RecordHeaderBytes;
+
+    QByteArray fileHeader()
+    {
+        QByteArray header(FileHeaderSize, '\0');
+        std::memcpy(header.data(), FileMagic, sizeof(FileMagic));
+        qToLittleEndian<quint16>(FileVersion, header.data() + 4);
+        return header;
+    }
+}
+
+ActivityJournal::ActivityJournal(const QString &path, int ringBytes)
+    : m_path(path), m_ring(static_cast<size_t>(qMax(ringBytes, MaxRecordBytes)))
+{
+}
+
+ActivityJournal::~ActivityJournal()
+{
+    flush();
+}
+
+void ActivityJournal::record(EventType type, quint64 handle, quint32 processId, QStringView text)
+{
+    // Every character takes at least one byte, so MaxTextBytes characters are
+    // enough; cut the rest without splitting a multi-byte sequence
+    m_textBuffer = text.left(MaxTextBytes).toUtf8();
+    if (m_textBuffer.size() > MaxTextBytes)
+    {
+        qsizetype end = MaxTextBytes;
+        while (end > 0 && (static_cast<uchar>(m_textBuffer.at(end)) & 0xC0) == 0x80)
+        {
+            --end;
+        }
+        m_textBuffer.truncate(end);
+    }
+
+    char header[RecordHeaderSize] = {};
+    qToLittleEndian<qint64>(QDateTime::currentMSecsSinceEpoch(), header);
+    qToLittleEndian<quint64>(handle, header + 8);
+    qToLittleEndian<quint32>(processId, header + 16);
+    header[20] = static_cast<char>(type);
+    qToLittleEndian<quint16>(static_cast<quint16>(m_textBuffer.size()), header + 22);
+
+    const size_t size = RecordHeaderSize + static_cast<size_t>(m_textBuffer.size());
+    if (m_ring.size() - m_used < size)
+    {
+        flush();
+    }
+    push(header, RecordHeaderSize);
+    push(m_textBuffer.constData(), static_cast<size_t>(m_textBuffer.size()));
+}
+
+void ActivityJournal::push(const char *data, size_t size)
+{
+    // Wraps at the end of the ring; flush() writes the pending bytes in order
+    const size_t first = qMin(size, m_ring.size() - m_head);
+    std::memcpy(m_ring.data() + m_head, data, first);
+    std::memcpy(m_ring.data(), data + first, size - first);
+    m_head = (m_head + size) % m_ring.size();
+    m_used += size;
+}
+
+bool ActivityJournal::flush()
+{
+    if (m_used == 0)
+    {
+        return true;
+    }
+
+    const size_t tail = (m_head + m_ring.size() - m_used) % m_ring.size();
+    const size_t first = qMin(m_used, m_ring.size() - tail);
+    const size_t second = m_used - first;
+    m_used = 0;
+
+    QFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        return false;
+    }
+    if (file.size() == 0 && file.write(fileHeader()) != FileHeaderSize)
+    {
+        return false;
+    }
+    bool ok = file.write(m_ring.data() + tail, static_cast<qint64>(first)) == static_cast<qint64>(first);
+    if (ok && second > 0)
+    {
+        ok = file.write(m_ring.data(), static_cast<qint64>(second)) == static_cast<qint64>(second);
+    }
+    return ok;
+}
+
+bool ActivityJournal::compact(qint64 retentionMs, qint64 maxBytes)
+{
+    flush();
+
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return !file.exists();
+    }
+    const QByteArray data = file.readAll();
+    file.close();
+
+    const qint64 cutoff = QDateTime::currentMSecsSinceEpoch() - retentionMs;
+    std::vector<qsizetype> keptOffsets;
+    const qsizetype end = decode(data,
+                                 [&](const Record &record, qsizetype offset)
+                                 {
+                                     if (record.timeMs >= cutoff)
+                                     {
+                                         keptOffsets.push_back(offset);
+                                     }
+                                     return true;
+                                 });
+    if (end < 0)
+    {
+        // Not a journal; start over rather than appending to garbage
+        return QFile::remove(m_path);
+    }
+
+    // Still too large: drop the oldest records until half the limit is left
+    auto keep = keptOffsets.begin();
+    if (maxBytes > 0)
+    {
+        while (keep != keptOffsets.end() && end - *keep > maxBytes / 2 && end - keptOffsets.front() > maxBytes)
+        {
+            ++keep;
+        }
+    }
+    const qsizetype keepFrom = keep != keptOffsets.end() ? *keep : end;
+
+    // Nothing to drop, and no truncated record (e.g. from a crash) at the end
+    if (keepFrom == FileHeaderSize && end == data.size())
+    {
+        return true;
+    }
+
+    QSaveFile out(m_path);
+    if (!out.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+    out.write(fileHeader());
+    out.write(data.constData() + keepFrom, end - keepFrom);
+    return out.commit();
+}
+
+qint64 ActivityJournal::fileSize() const
+{
+    return QFileInfo(m_path).size();
+}
+
+bool ActivityJournal::read(const QString &path, const std::function<bool(const Record &)> &visit)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    return decode(file.readAll(), [&visit](const Record &record, qsizetype) { return visit(record); }) >= 0;
+}
+
+qsizetype ActivityJournal::decode(const QByteArray &data,
+                                  const std::function<bool(const Record &, qsizetype)> &visit)
+{
+    if (data.size() < FileHeaderSize || std::memcmp(data.constData(), FileMagic, sizeof(FileMagic)) != 0 ||
+        qFromLittleEndian<quint16>(data.constData() + 4) != FileVersion)
+    {
+        return -1;
+    }
+
+    const qsizetype headerSize = static_cast<qsizetype>(RecordHeaderSize);
+    Record record;
+    qsizetype pos = FileHeaderSize;
+    while (pos + headerSize <= data.size())
+    {
+        const char *header = data.constData() + pos;
+        const qsizetype textBytes = qFromLittleEndian<quint16>(header + 22);
+        if (pos + headerSize + textBytes > data.size())
+        {
+            // Truncated last record, e.g. after a crash during a write
+            break;
+        }
+
+        record.timeMs = qFromLittleEndian<qint64>(header);
+        record.handle = qFromLittleEndian<quint64>(header + 8);
+        record.processId = qFromLittleEndian<quint32>(header + 16);
+        record.type = static_cast<EventType>(static_cast<quint8>(header[20]));
+        record.text = textBytes > 0 ? QString::fromUtf8(header + headerSize, textBytes) : QString();
+        if (!visit(record, pos))
+        {
+            break;
+        }
+        pos += headerSize + textBytes;
+    }
+    return pos;
+}
+
+const char *ActivityJournal::typeName(EventType type)
+{
+    switch (type)
+    {
+    case EventType::Appeared: return "appeared";
+    case EventType::Disappeared: return "disappeared";
+    case EventType::TitleChanged: return "title";
+    case EventType::Activated: return "activated";
+    default: return "unknown";
+    }
+}
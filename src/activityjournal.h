@@ -0,0 +1,131 @@
+#ifndef ACTIVITYJOURNAL_H
+#define ACTIVITYJOURNAL_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringView>
+#include <QtGlobal>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Append-only binary log of window lifetimes, title changes and activations
+ *
+ * Events are encoded into a fixed-size in-memory ring and appended to the journal
+ * file when flush() is called (periodically by MainWindow, or early when the ring
+ * fills up), so recording an event costs a memcpy and no I/O. compact() rewrites
+ * the file without records older than the retention period and keeps the file
+ * below its size limit.
+ *
+ * File layout: an 8-byte header ("WSJL", version, reserved), then records made of
+ * a 24-byte little-endian header (time, handle, process ID, type, text length)
+ * followed by the UTF-8 title for Appeared and TitleChanged, cut to at most
+ * MaxTextBytes. The class has no Win32 dependency and is shared with the
+ * WinSelectorJournal query tool.
+ */
+class ActivityJournal
+{
+public:
+    static constexpr int RecordHeaderBytes = 24;
+    static constexpr int MaxTextBytes = 2048;  ///< Longer titles are cut at a character boundary
+    static constexpr int MaxRecordBytes = RecordHeaderBytes + MaxTextBytes;
+
+    enum class EventType : quint8
+    {
+        Appeared = 1,     ///< Window got a tile; text is the title
+        Disappeared = 2,  ///< Window's tile was removed
+        TitleChanged = 3, ///< Text is the new title
+        Activated = 4     ///< Window became the foreground window
+    };
+
+    /**
+     * @brief One decoded record
+     */
+    struct Record
+    {
+        qint64 timeMs = 0; ///< Milliseconds since the Unix epoch
+        quint64 handle = 0;
+        quint32 processId = 0;
+        EventType type = EventType::Appeared;
+        QString text;
+    };
+
+    /**
+     * @brief Construct a journal writer
+     * @param path Journal file
+     * @param ringBytes Capacity of the in-memory ring; at least MaxRecordBytes, so
+     *                  that every record fits after a flush
+     */
+    explicit ActivityJournal(const QString &path, int ringBytes = 64 * 1024);
+
+    /**
+     * @brief Flush pending records
+     */
+    ~ActivityJournal();
+
+    /**
+     * @brief Record an event
+     * @param type Event type
+     * @param handle Window handle
+     * @param processId Owning process ID, 0 if unknown
+     * @param text Title for Appeared / TitleChanged, empty otherwise; only the
+     *             first MaxTextBytes of its UTF-8 form are stored
+     */
+    void record(EventType type, quint64 handle, quint32 processId, QStringView text = QStringView());
+
+    /**
+     * @brief Append the records in the ring to the file
+     * @return false on I/O error (the records are dropped)
+     */
+    bool flush();
+
+    /**
+     * @brief Drop records older than the retention period and keep the file small
+     * @param retentionMs Records older than now minus this are removed
+     * @param maxBytes If the file is still larger, the oldest records are dropped
+     *                 until it is at most half this size
+     * @return false on I/O error
+     */
+    bool compact(qint64 retentionMs, qint64 maxBytes);
+
+    /**
+     * @brief Get the size of the journal file
+     * @return Size in bytes, 0 if it does not exist
+     */
+    qint64 fileSize() const;
+
+    /**
+     * @brief Decode every record of a journal file in order
+     * @param path Journal file
+     * @param visit Called per record; return false to stop
+     * @return false if the file is missing or has an invalid header
+     */
+    static bool read(const QString &path, const std::function<bool(const Record &)> &visit);
+
+    /**
+     * @brief Get a printable name for an event type
+     * @param type Event type
+     * @return Type name
+     */
+    static const char *typeName(EventType type);
+
+private:
+    QString m_path;
+    std::vector<char> m_ring;
+    size_t m_head = 0; ///< Next write position
+    size_t m_used = 0; ///< Pending bytes ending at m_head
+    QByteArray m_textBuffer;
+
+    void push(const char *data, size_t size);
+
+    /**
+     * @brief Decode records from a buffer holding a whole file
+     * @param data File contents
+     * @param visit Called per record with its offset; return false to stop
+     * @return Offset where decoding stopped (after the last complete record unless
+     *         visit returned false), -1 if the header is invalid
+     */
+    static qsizetype decode(const QByteArray &data, const std::function<bool(const Record &, qsizetype)> &visit);
+};
+
+#endif // ACTIVITYJOURNAL_H
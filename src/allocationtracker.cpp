@@ -0,0 +1,172 @@
+#include "allocationtracker.h"
+#include <QDebug>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    constexpr int StageCount = static_cast<int>(AllocationTracker::Stage::Count);
+
+    // Only the GUI thread ever enters a non-idle stage, so the counters below are
+    // written from a single thread. Allocations on worker threads stay in Idle.
+    thread_local AllocationTracker::Stage t_currentStage = AllocationTracker::Stage::Idle;
+    AllocationTracker::Counters s_counters[StageCount];
+}
+
+AllocationTracker::StageScope::StageScope(Stage stage)
+    : m_previous(t_currentStage)
+{
+    t_currentStage = stage;
+}
+
+AllocationTracker::StageScope::~StageScope()
+{
+    t_currentStage = m_previous;
+}
+
+bool AllocationTracker::isEnabled()
+{
+#ifdef WINSELECTOR_ALLOC_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AllocationTracker::beginRefresh()
+{
+    for (Counters &counters : s_counters)
+    {
+        counters = Counters();
+    }
+}
+
+AllocationTracker::Counters AllocationTracker::counters(Stage stage)
+{
+    return s_counters[static_cast<int>(stage)];
+}
+
+AllocationTracker::Counters AllocationTracker::total()
+{
+    Counters sum;
+    // Idle is not part of a refresh
+    for (int i = static_cast<int>(Stage::Idle) + 1; i < StageCount; ++i)
+    {
+        sum.allocations += s_counters[i].allocations;
+        sum.bytes += s_counters[i].bytes;
+    }
+    return sum;
+}
+
+const char *AllocationTracker::stageName(Stage stage)
+{
+    switch (stage)
+    {
+    case Stage::Idle: return "idle";
+    case Stage::Scan: return "scan";
+    case Stage::Sort: return "sort";
+    case Stage::UpdateTiles: return "updateTiles";
+    case Stage::Layout: return "layout";
+    default: return "unknown";
+    }
+}
+
+bool AllocationTracker::reportRefresh(bool steadyState, int budget)
+{
+    if (!isEnabled())
+    {
+        return true;
+    }
+
+    for (int i = static_cast<int>(Stage::Idle) + 1; i < StageCount; ++i)
+    {
+        qDebug() << "Allocations in" << stageName(static_cast<Stage>(i)) << "-"
+                 << s_counters[i].allocations << "allocations," << s_counters[i].bytes << "bytes";
+    }
+
+    // The budget only applies to refreshes where nothing changed; a refresh that
+    // adds or retitles windows is expected to allocate.
+    const Counters sum = total();
+    if (steadyState && budget >= 0 && sum.allocations > static_cast<quint64>(budget))
+    {
+        qWarning() << "Steady-state refresh exceeded allocation budget:"
+                   << sum.allocations << "allocations (budget" << budget << ")";
+        return false;
+    }
+    return true;
+}
+
+void AllocationTracker::recordAllocation(std::size_t size)
+{
+    const Stage stage = t_currentStage;
+    if (stage == Stage::Idle)
+    {
+        return;
+    }
+    Counters &counters = s_counters[static_cast<int>(stage)];
+    ++counters.allocations;
+    counters.bytes += size;
+}
+
+#ifdef WINSELECTOR_ALLOC_TRACKING
+
+// Global allocation hooks. Only the plain (non-aligned) forms are replaced; the
+// aligned overloads keep their default implementation and are not counted.
+
+void *operator new(std::size_t size)
+{
+    AllocationTracker::recordAllocation(size);
+    if (void *p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    AllocationTracker::recordAllocation(size);
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept
+{
+    return ::operator new(size, tag);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept
+{
+    std::free(p);
+}
+
+#endif // WINSELECTOR_ALLOC_TRACKING
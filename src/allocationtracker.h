@@ -0,0 +1,102 @@
+#ifndef ALLOCATIONTRACKER_H
+#define ALLOCATIONTRACKER_H
+
+#include <QtGlobal>
+#include <cstddef>
+
+/**
+ * @brief Opt-in heap allocation counter for the refresh pipeline
+ *
+ * When the project is configured with -DWINSELECTOR_ALLOC_TRACKING=ON, the global
+ * operator new/delete are replaced (see allocationtracker.cpp) and every allocation
+ * made on the GUI thread while a stage is active is attributed to that stage.
+ * In normal builds the hooks are not compiled and all counters stay at zero.
+ */
+class AllocationTracker
+{
+public:
+    /**
+     * @brief Stages of MainWindow::refreshWindows() that are measured separately
+     */
+    enum class Stage
+    {
+        Idle,
+        Scan,
+        Sort,
+        UpdateTiles,
+        Layout,
+        Count
+    };
+
+    /**
+     * @brief Allocation counters for one stage
+     */
+    struct Counters
+    {
+        quint64 allocations = 0;
+        quint64 bytes = 0;
+    };
+
+    /**
+     * @brief RAII helper that attributes allocations to a stage while in scope
+     */
+    class StageScope
+    {
+    public:
+        explicit StageScope(Stage stage);
+        ~StageScope();
+
+        StageScope(const StageScope &) = delete;
+        StageScope &operator=(const StageScope &) = delete;
+
+    private:
+        Stage m_previous;
+    };
+
+    /**
+     * @brief Check whether the allocation hooks are compiled in
+     * @return true if allocations are being counted
+     */
+    static bool isEnabled();
+
+    /**
+     * @brief Reset all stage counters at the start of a refresh
+     */
+    static void beginRefresh();
+
+    /**
+     * @brief Get the counters of a stage since the last beginRefresh()
+     * @param stage Stage to query
+     * @return Allocation counters
+     */
+    static Counters counters(Stage stage);
+
+    /**
+     * @brief Get the sum of all stage counters since the last beginRefresh()
+     * @return Allocation counters
+     */
+    static Counters total();
+
+    /**
+     * @brief Get a printable name for a stage
+     * @param stage Stage to name
+     * @return Stage name
+     */
+    static const char *stageName(Stage stage);
+
+    /**
+     * @brief Log the per-stage counters and check them against an allocation budget
+     * @param steadyState true if the refresh did not change the window list
+     * @param budget Maximum allocations of a steady-state refresh; negative disables the check
+     * @return false if a steady-state refresh exceeded the budget
+     */
+    static bool reportRefresh(bool steadyState, int budget);
+
+    /**
+     * @brief Record one allocation (called from the operator new hooks)
+     * @param size Requested size in bytes
+     */
+    static void recordAllocation(std::size_t size);
+};
+
+#endif // ALLOCATIONTRACKER_H
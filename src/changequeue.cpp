@@ -0,0 +1,138 @@
+#include "changequeue.h"
+
+ChangeQueue::Entry *ChangeQueue::find(quintptr handle)
+{
+    auto it = m_positions.constFind(handle);
+    return it != m_positions.constEnd() ? &m_entries[it.value()] : nullptr;
+}
+
+void ChangeQueue::erase(quintptr handle)
+{
+    auto it = m_positions.find(handle);
+    if (it == m_positions.end())
+    {
+        return;
+    }
+
+    // Order between windows carries no meaning, so swap the last entry in
+    const size_t position = it.value();
+    m_positions.erase(it);
+    if (position != m_entries.size() - 1)
+    {
+        m_entries[position] = std::move(m_entries.back());
+        m_positions[m_entries[position].handle] = position;
+    }
+    m_entries.pop_back();
+}
+
+void ChangeQueue::added(quintptr handle, quint32 processId, const QString &processName, const QString &title)
+{
+    if (Entry *entry = find(handle))
+    {
+        // The subscriber still knows the old window of this handle
+        entry->state = entry->state == State::Removed ? State::Replaced : entry->state;
+        entry->processId = processId;
+        entry->processName = processName;
+        entry->title = title;
+        return;
+    }
+    m_positions.insert(handle, m_entries.size());
+    m_entries.push_back(Entry{handle, State::Added, processId, processName, title});
+}
+
+void ChangeQueue::removed(quintptr handle)
+{
+    Entry *entry = find(handle);
+    if (!entry)
+    {
+        m_positions.insert(handle, m_entries.size());
+        m_entries.push_back(Entry{handle, State::Removed, 0, QString(), QString()});
+    }
+    else if (entry->state == State::Added)
+    {
+        // Came and went between two deliveries
+        erase(handle);
+    }
+    else
+    {
+        entry->state = State::Removed;
+        entry->title.clear();
+        entry->processName.clear();
+    }
+
+    if (m_foreground == handle)
+    {
+        m_foregroundPending = false;
+    }
+}
+
+void ChangeQueue::titleChanged(quintptr handle, const QString &title)
+{
+    if (Entry *entry = find(handle))
+    {
+        if (entry->state != State::Removed)
+        {
+            entry->title = title;
+        }
+        return;
+    }
+    m_positions.insert(handle, m_entries.size());
+    m_entries.push_back(Entry{handle, State::Changed, 0, QString(), title});
+}
+
+void ChangeQueue::foregroundChanged(quintptr handle)
+{
+    m_foreground = handle;
+    m_foregroundPending = true;
+}
+
+QByteArray ChangeQueue::take()
+{
+    QByteArray lines;
+    for (const Entry &entry : m_entries)
+    {
+        switch (entry.state)
+        {
+        case State::Replaced:
+            lines += "removed\t" + handleText(entry.handle) + '\n';
+            Q_FALLTHROUGH();
+        case State::Added:
+            lines += addedLine(entry.handle, entry.processId, entry.processName, entry.title);
+            break;
+        case State::Changed:
+            lines += "title\t" + handleText(entry.handle) + '\t' + sanitized(entry.title).toUtf8() + '\n';
+            break;
+        case State::Removed:
+            lines += "removed\t" + handleText(entry.handle) + '\n';
+            break;
+        }
+    }
+    if (m_foregroundPending)
+    {
+        lines += "foreground\t" + handleText(m_foreground) + '\n';
+    }
+
+    m_entries.clear();
+    m_positions.clear();
+    m_foregroundPending = false;
+    return lines;
+}
+
+QByteArray ChangeQueue::addedLine(quintptr handle, quint32 processId, const QString &processName, const QString &title)
+{
+    return "added\t" + handleText(handle) + '\t' + QByteArray::number(processId) + '\t' +
+           sanitized(processName).toUtf8() + '\t' + sanitized(title).toUtf8() + '\n';
+}
+
+QByteArray ChangeQueue::handleText(quintptr handle)
+{
+    return "0x" + QByteArray::number(static_cast<quint64>(handle), 16);
+}
+
+QString ChangeQueue::sanitized(const QString &text)
+{
+    // Tabs and line breaks would break the line format
+    QString result = text;
+    result.replace('\t', ' ').replace('\n', ' ').replace('\r', ' ');
+    return result;
+}
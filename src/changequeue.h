@@ -0,0 +1,107 @@
+#ifndef CHANGEQUEUE_H
+#define CHANGEQUEUE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QtGlobal>
+#include <vector>
+
+/**
+ * @brief Pending window-model changes for one stream subscriber, coalesced per window
+ *
+ * Changes that the subscriber has not received yet are merged: a window added and
+ * removed again is never sent, several title changes collapse into the last one
+ * and only the latest foreground window is kept. The queue therefore never holds
+ * more than one entry per window, however slowly the subscriber reads.
+ *
+ * Changes are serialized as tab-separated UTF-8 lines:
+ *   added <handle> <pid> <process> <title>
+ *   removed <handle>
+ *   title <handle> <title>
+ *   foreground <handle>
+ * with handles written as 0x-prefixed hex. The class has no Win32 dependency.
+ */
+class ChangeQueue
+{
+public:
+    /**
+     * @brief Queue a new window
+     * @param handle Window handle
+     * @param processId Owning process ID
+     * @param processName Process executable name
+     * @param title Window title
+     */
+    void added(quintptr handle, quint32 processId, const QString &processName, const QString &title);
+
+    /**
+     * @brief Queue the removal of a window
+     * @param handle Window handle
+     */
+    void removed(quintptr handle);
+
+    /**
+     * @brief Queue a title change
+     * @param handle Window handle
+     * @param title New title
+     */
+    void titleChanged(quintptr handle, const QString &title);
+
+    /**
+     * @brief Queue a foreground change; only the latest one is delivered
+     * @param handle New foreground window
+     */
+    void foregroundChanged(quintptr handle);
+
+    /**
+     * @brief Check whether anything is pending
+     * @return true if take() would return nothing
+     */
+    bool isEmpty() const { return m_entries.empty() && !m_foregroundPending; }
+
+    /**
+     * @brief Serialize and remove all pending changes
+     * @return Change lines
+     */
+    QByteArray take();
+
+    /**
+     * @brief Serialize an "added" line, e.g. for the initial snapshot
+     * @param handle Window handle
+     * @param processId Owning process ID
+     * @param processName Process executable name
+     * @param title Window title
+     * @return Line including the trailing newline
+     */
+    static QByteArray addedLine(quintptr handle, quint32 processId, const QString &processName, const QString &title);
+
+private:
+    enum class State
+    {
+        Added,   ///< Not known to the subscriber yet
+        Changed, ///< Known; title changed
+        Removed, ///< Known; removed
+        Replaced ///< Known and removed, then a new window got the same handle
+    };
+
+    struct Entry
+    {
+        quintptr handle;
+        State state;
+        quint32 processId;
+        QString processName;
+        QString title;
+    };
+
+    std::vector<Entry> m_entries;
+    QHash<quintptr, size_t> m_positions;
+    quintptr m_foreground = 0;
+    bool m_foregroundPending = false;
+
+    Entry *find(quintptr handle);
+    void erase(quintptr handle);
+    static QByteArray handleText(quintptr handle);
+    static QString sanitized(const QString &text);
+};
+
+#endif // CHANGEQUEUE_H
@@ -0,0 +1,68 @@
+#include "closewatcher.h"
+#include "win32utils.h"
+#include <QList>
+
+CloseWatcher::CloseWatcher(QObject *parent)
+    : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &CloseWatcher::poll);
+}
+
+void CloseWatcher::watch(HWND hwnd, int timeoutMs)
+{
+    watch(QList<HWND>{hwnd}, timeoutMs);
+}
+
+void CloseWatcher::watch(const QList<HWND> &windows, int timeoutMs)
+{
+    if (windows.isEmpty())
+    {
+        return;
+    }
+    const QDeadlineTimer deadline(qMax(0, timeoutMs));
+    for (HWND hwnd : windows)
+    {
+        m_pending.insert(hwnd, deadline);
+    }
+
+    // A fresh close is most likely to finish soon; restart the fast polling
+    m_pollMs = InitialPollMs;
+    m_timer.start(m_pollMs);
+}
+
+void CloseWatcher::poll()
+{
+    QList<HWND> gone;
+    for (auto it = m_pending.begin(); it != m_pending.end();)
+    {
+        // A window hidden instead of destroyed (e.g. minimized to the tray) is
+        // also no longer listed by the scanner
+        if (!Win32Utils::isValidWindow(it.key()) || !IsWindowVisible(it.key()))
+        {
+            gone.append(it.key());
+            it = m_pending.erase(it);
+        }
+        else if (it.value().hasExpired())
+        {
+            it = m_pending.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if (!m_pending.isEmpty())
+    {
+        m_pollMs = qMin(m_pollMs * 2, MaxPollMs);
+        m_timer.start(m_pollMs);
+    }
+
+    // Emitted last: receivers may start new watches
+    if (!gone.isEmpty())
+    {
+        emit windowsGone(gone);
+    }
+}
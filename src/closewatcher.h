@@ -0,0 +1,72 @@
+#ifndef CLOSEWATCHER_H
+#define CLOSEWATCHER_H
+
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+#include <Windows.h>
+
+/**
+ * @brief Watches windows that were asked to close and reports when they are gone
+ *
+ * WM_CLOSE is asynchronous: a window may disappear within a few milliseconds or
+ * stay open behind a "save changes?" prompt. Every watched window is polled with
+ * IsWindow/IsWindowVisible on one shared timer whose interval starts short and
+ * doubles up to a cap, so closing several windows in a row costs one timer and
+ * no window scan. The windows found gone in one poll are reported together, so
+ * a batch close ends in one model update. A window that is still open when its
+ * watch expires is dropped silently and left to the regular refresh.
+ */
+class CloseWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Construct a new CloseWatcher
+     * @param parent Parent object
+     */
+    explicit CloseWatcher(QObject *parent = nullptr);
+
+    /**
+     * @brief Start watching a window that was just asked to close
+     * @param hwnd Window handle
+     * @param timeoutMs How long to keep watching before giving up
+     */
+    void watch(HWND hwnd, int timeoutMs);
+
+    /**
+     * @brief Start watching several windows that were just asked to close
+     * @param windows Window handles
+     * @param timeoutMs How long to keep watching before giving up
+     */
+    void watch(const QList<HWND> &windows, int timeoutMs);
+
+    /**
+     * @brief Check whether a window is being watched
+     * @param hwnd Window handle
+     * @return true if the window was asked to close and has not gone yet
+     */
+    bool isWatching(HWND hwnd) const { return m_pending.contains(hwnd); }
+
+signals:
+    /**
+     * @brief Emitted once per poll with the watched windows that were destroyed or hidden
+     * @param windows Handles of the windows
+     */
+    void windowsGone(const QList<HWND> &windows);
+
+private:
+    static constexpr int InitialPollMs = 10;
+    static constexpr int MaxPollMs = 200;
+
+    QTimer m_timer;
+    int m_pollMs = InitialPollMs;
+    QHash<HWND, QDeadlineTimer> m_pending;
+
+    void poll();
+};
+
+#endif // CLOSEWATCHER_H
@@ -0,0 +1,265 @@
+#include "commandserver.h"
+#include <QDebug>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTimer>
+
+CommandServer::CommandServer(Handler handler, QObject *parent)
+    : QObject(parent), m_handler(std::move(handler)), m_server(new QLocalServer(this))
+{
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(m_server, &QLocalServer::newConnection, this, &CommandServer::onNewConnection);
+}
+
+bool CommandServer::listen()
+{
+    // Remove a socket left behind by a crashed instance (no-op on Windows)
+    QLocalServer::removeServer(serverName());
+    if (!m_server->listen(serverName()))
+    {
+        qWarning() << "CommandServer: cannot listen on" << serverName() << "-" << m_server->errorString();
+        return false;
+    }
+    return true;
+}
+
+QString CommandServer::serverName()
+{
+    QString user = qEnvironmentVariable("USERNAME");
+    if (user.isEmpty())
+    {
+        user = qEnvironmentVariable("USER");
+    }
+    return "WinSelector-" + user;
+}
+
+void CommandServer::onNewConnection()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection())
+    {
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        if (socket->canReadLine())
+        {
+            onReadyRead(socket);
+        }
+    }
+}
+
+void CommandServer::onReadyRead(QLocalSocket *socket)
+{
+    if (!socket->canReadLine())
+    {
+        if (socket->bytesAvailable() > MaxRequestBytes)
+        {
+            socket->write(errorReply("request too long"));
+            socket->disconnectFromServer();
+        }
+        return;
+    }
+
+    const QString line = QString::fromUtf8(socket->readLine(MaxRequestBytes)).trimmed();
+    const qsizetype space = line.indexOf(' ');
+    const QString command = (space < 0 ? line : line.left(space)).toLower();
+    const QString argument = space < 0 ? QString() : line.mid(space + 1).trimmed();
+
+    if (command == QLatin1String("subscribe") && m_subscribers.size() >= MaxSubscribers)
+    {
+        socket->write(errorReply("too many subscribers"));
+        socket->disconnectFromServer();
+        return;
+    }
+
+    const QByteArray reply = m_handler(command, argument);
+    socket->write(reply);
+    if (command != QLatin1String("subscribe") || !reply.startsWith("OK\n"))
+    {
+        socket->disconnectFromServer();
+        return;
+    }
+
+    // Keep the connection; the reply carried the snapshot the changes apply to
+    m_subscribers.insert(socket, ChangeQueue());
+    disconnect(socket, &QLocalSocket::readyRead, this, nullptr);
+    connect(socket, &QLocalSocket::readyRead, socket, [socket]() { socket->readAll(); });
+    connect(socket, &QLocalSocket::bytesWritten, this, [this, socket]() { deliver(socket); });
+    connect(socket, &QLocalSocket::disconnected, this, [this, socket]() { m_subscribers.remove(socket); });
+}
+
+void CommandServer::publishAdded(quintptr handle, quint32 processId, const QString &processName, const QString &title)
+{
+    for (ChangeQueue &queue : m_subscribers)
+    {
+        queue.added(handle, processId, processName, title);
+    }
+    scheduleDelivery();
+}
+
+void CommandServer::publishRemoved(quintptr handle)
+{
+    for (ChangeQueue &queue : m_subscribers)
+    {
+        queue.removed(handle);
+    }
+    scheduleDelivery();
+}
+
+void CommandServer::publishTitleChanged(quintptr handle, const QString &title)
+{
+    for (ChangeQueue &queue : m_subscribers)
+    {
+        queue.titleChanged(handle, title);
+    }
+    scheduleDelivery();
+}
+
+void CommandServer::publishForeground(quintptr handle)
+{
+    for (ChangeQueue &queue : m_subscribers)
+    {
+        queue.foregroundChanged(handle);
+    }
+    scheduleDelivery();
+}
+
+void CommandServer::scheduleDelivery()
+{
+    // One write per subscriber for all changes of the current event loop pass
+    if (m_subscribers.isEmpty() || m_deliveryScheduled)
+    {
+        return;
+    }
+    m_deliveryScheduled = true;
+    QTimer::singleShot(0, this, &CommandServer::deliverAll);
+}
+
+void CommandServer::deliverAll()
+{
+    m_deliveryScheduled = false;
+    for (auto it = m_subscribers.cbegin(); it != m_subscribers.cend(); ++it)
+    {
+        deliver(it.key());
+    }
+}
+
+void CommandServer::deliver(QLocalSocket *socket)
+{
+    auto it = m_subscribers.find(socket);
+    if (it == m_subscribers.end() || it->isEmpty())
+    {
+        return;
+    }
+    // A slow reader keeps accumulating in its queue; bytesWritten() retries
+    if (socket->bytesToWrite() > MaxPendingWriteBytes)
+    {
+        return;
+    }
+    socket->write(it->take());
+}
+
+int CommandServer::sendCommand(const QString &command, QStringList &output, QString &error)
+{
+    QLocalSocket socket;
+    socket.connectToServer(serverName());
+    if (!socket.waitForConnected(ClientTimeoutMs))
+    {
+        error = "WinSelector is not running";
+        return 2;
+    }
+
+    socket.write(command.toUtf8() + '\n');
+    socket.waitForBytesWritten(ClientTimeoutMs);
+
+    // The server closes the connection after the reply
+    QByteArray reply;
+    while (socket.state() == QLocalSocket::ConnectedState && socket.waitForReadyRead(ClientTimeoutMs))
+    {
+        reply += socket.readAll();
+    }
+    reply += socket.readAll();
+    if (reply.isEmpty())
+    {
+        error = "No reply from WinSelector";
+        return 2;
+    }
+
+    QStringList lines = QString::fromUtf8(reply).split('\n');
+    if (!lines.isEmpty() && lines.last().isEmpty())
+    {
+        lines.removeLast();
+    }
+    const QString status = lines.takeFirst();
+    output = lines;
+    if (status == QLatin1String("OK"))
+    {
+        return 0;
+    }
+    error = status.startsWith(QLatin1String("ERROR ")) ? status.mid(6) : status;
+    return 1;
+}
+
+int CommandServer::subscribe(const std::function<void(const QString &line)> &onLine, QString &error)
+{
+    QLocalSocket socket;
+    socket.connectToServer(serverName());
+    if (!socket.waitForConnected(ClientTimeoutMs))
+    {
+        error = "WinSelector is not running";
+        return 2;
+    }
+
+    socket.write("subscribe\n");
+    socket.waitForBytesWritten(ClientTimeoutMs);
+
+    bool statusRead = false;
+    for (;;)
+    {
+        while (socket.canReadLine())
+        {
+            const QString line = QString::fromUtf8(socket.readLine()).chopped(1);
+            if (statusRead)
+            {
+                onLine(line);
+                continue;
+            }
+            statusRead = true;
+            if (line != QLatin1String("OK"))
+            {
+                error = line.startsWith(QLatin1String("ERROR ")) ? line.mid(6) : line;
+                return 1;
+            }
+        }
+        if (socket.state() != QLocalSocket::ConnectedState)
+        {
+            break;
+        }
+        // Only the status line has a deadline; the stream itself may stay quiet
+        if (!socket.waitForReadyRead(statusRead ? -1 : ClientTimeoutMs) && !statusRead)
+        {
+            break;
+        }
+    }
+
+    if (!statusRead)
+    {
+        error = "No reply from WinSelector";
+        return 2;
+    }
+    return 0;
+}
+
+QByteArray CommandServer::okReply(const QStringList &lines)
+{
+    QByteArray reply("OK\n");
+    for (const QString &line : lines)
+    {
+        reply += line.toUtf8();
+        reply += '\n';
+    }
+    return reply;
+}
+
+QByteArray CommandServer::errorReply(const QString &message)
+{
+    return "ERROR " + message.toUtf8() + '\n';
+}
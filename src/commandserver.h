@@ -0,0 +1,144 @@
+#ifndef COMMANDSERVER_H
+#define COMMANDSERVER_H
+
+#include "changequeue.h"
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <functional>
+
+class QLocalServer;
+class QLocalSocket;
+
+/**
+ * @brief Local command channel of the running instance, which also makes it the only one
+ *
+ * Clients connect to a per-user local socket (a named pipe on Windows), send one
+ * UTF-8 line "<command> [argument]" and receive a reply whose first line is "OK"
+ * or "ERROR <message>", followed by data lines; the server then closes the
+ * connection. Replies are produced by a handler that answers from the panel's
+ * in-memory model, so no command triggers a window scan.
+ *
+ * The client side (sendCommand()) is used by the "--send" mode of the executable
+ * and by startup to hand over to an instance that is already running.
+ *
+ * The "subscribe" command keeps the connection open instead: after the handler's
+ * snapshot, the server pushes window changes passed to the publish functions.
+ * Each subscriber has its own ChangeQueue, and the server only writes to a socket
+ * while its unsent output is below a small limit. A slow reader therefore gets
+ * fewer, coalesced updates rather than an ever-growing buffer, and never blocks
+ * the GUI thread.
+ */
+class CommandServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Produces the reply for one command
+     *
+     * Receives the command word (lower case) and the rest of the line, and returns
+     * the complete reply including the status line.
+     */
+    using Handler = std::function<QByteArray(const QString &command, const QString &argument)>;
+
+    /**
+     * @brief Construct a server; call listen() to start accepting clients
+     * @param handler Command handler
+     * @param parent Parent object
+     */
+    explicit CommandServer(Handler handler, QObject *parent = nullptr);
+
+    /**
+     * @brief Start listening on serverName()
+     * @return false if the channel could not be created
+     */
+    bool listen();
+
+    /**
+     * @brief Get the name of the local socket, unique per user
+     * @return Server name
+     */
+    static QString serverName();
+
+    /**
+     * @brief Send a command to the running instance and print the reply
+     * @param command Command line, e.g. "list notepad.exe"
+     * @param output Receives the reply data lines (without the status line)
+     * @param error Receives the error message, if any
+     * @return 0 on "OK", 1 on "ERROR", 2 if no instance is running or it did not answer
+     */
+    static int sendCommand(const QString &command, QStringList &output, QString &error);
+
+    /**
+     * @brief Receive the change stream of the running instance until it exits
+     * @param onLine Called for every snapshot and change line
+     * @param error Receives the error message, if any
+     * @return 0 when the instance closed the stream, 1 on "ERROR", 2 if no instance answered
+     */
+    static int subscribe(const std::function<void(const QString &line)> &onLine, QString &error);
+
+    /**
+     * @brief Publish a new window to all subscribers
+     * @param handle Window handle
+     * @param processId Owning process ID
+     * @param processName Process executable name
+     * @param title Window title
+     */
+    void publishAdded(quintptr handle, quint32 processId, const QString &processName, const QString &title);
+
+    /**
+     * @brief Publish the removal of a window to all subscribers
+     * @param handle Window handle
+     */
+    void publishRemoved(quintptr handle);
+
+    /**
+     * @brief Publish a title change to all subscribers
+     * @param handle Window handle
+     * @param title New title
+     */
+    void publishTitleChanged(quintptr handle, const QString &title);
+
+    /**
+     * @brief Publish a foreground change to all subscribers
+     * @param handle New foreground window, which need not be listed
+     */
+    void publishForeground(quintptr handle);
+
+    /**
+     * @brief Build a successful reply
+     * @param lines Data lines
+     * @return Reply bytes
+     */
+    static QByteArray okReply(const QStringList &lines = QStringList());
+
+    /**
+     * @brief Build an error reply
+     * @param message Error message
+     * @return Reply bytes
+     */
+    static QByteArray errorReply(const QString &message);
+
+private:
+    static constexpr int MaxRequestBytes = 4096;
+    static constexpr int ClientTimeoutMs = 2000;
+    static constexpr int MaxSubscribers = 16;
+    // Unsent bytes above which a subscriber only accumulates coalesced changes
+    static constexpr qint64 MaxPendingWriteBytes = 64 * 1024;
+
+    Handler m_handler;
+    QLocalServer *m_server;
+    QHash<QLocalSocket *, ChangeQueue> m_subscribers;
+    bool m_deliveryScheduled = false;
+
+    void onNewConnection();
+    void onReadyRead(QLocalSocket *socket);
+    void scheduleDelivery();
+    void deliverAll();
+    void deliver(QLocalSocket *socket);
+};
+
+#endif // COMMANDSERVER_H
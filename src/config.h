@@ -4,51 +4,140 @@
 #include "settings.h"
 
 // WinSelector Configuration
-// Values are now loaded from Settings.ini via Settings class
+// Values are loaded from Settings.ini via Settings class and follow edits of the
+// file; code that reads several values in a row can take snapshot() once instead
 
 namespace WinSelectorConfig
 {
+    inline const SettingsValues &snapshot() { return Settings::instance().current(); }
+
     // MainWindow Configuration
     namespace MainWindow
     {
-        inline int refreshIntervalMs() { return Settings::instance().mainWindowRefreshIntervalMs; }
-        inline int closeRefreshDelayMs() { return Settings::instance().mainWindowCloseRefreshDelayMs; }
-        inline int initialWidth() { return Settings::instance().mainWindowInitialWidth; }
-        inline int minimumWidth() { return Settings::instance().mainWindowMinimumWidth; }
-        inline int topOffset() { return Settings::instance().mainWindowTopOffset; }
-        inline int bottomOffset() { return Settings::instance().mainWindowBottomOffset; }
-        inline int iconRefreshIntervalMs() { return Settings::instance().mainWindowIconRefreshIntervalMs; }
+        inline int refreshIntervalMs() { return Settings::instance().current().mainWindowRefreshIntervalMs; }
+        inline int closeRefreshDelayMs() { return Settings::instance().current().mainWindowCloseRefreshDelayMs; }
+        inline int initialWidth() { return Settings::instance().current().mainWindowInitialWidth; }
+        inline int minimumWidth() { return Settings::instance().current().mainWindowMinimumWidth; }
+        inline int topOffset() { return Settings::instance().current().mainWindowTopOffset; }
+        inline int bottomOffset() { return Settings::instance().current().mainWindowBottomOffset; }
+        inline int iconRefreshIntervalMs() { return Settings::instance().current().mainWindowIconRefreshIntervalMs; }
     }
 
     // Layout Configuration
     namespace Layout
     {
-        inline int margin() { return Settings::instance().layoutMargin; }
-        inline int hSpacing() { return Settings::instance().layoutHSpacing; }
-        inline int vSpacing() { return Settings::instance().layoutVSpacing; }
+        inline int margin() { return Settings::instance().current().layoutMargin; }
+        inline int hSpacing() { return Settings::instance().current().layoutHSpacing; }
+        inline int vSpacing() { return Settings::instance().current().layoutVSpacing; }
     }
 
     // WindowScanner Configuration
     namespace WindowScanner
     {
-        inline int maxTitleLength() { return Settings::instance().windowScannerMaxTitleLength; }
+        inline int maxTitleLength() { return Settings::instance().current().windowScannerMaxTitleLength; }
+        inline int refreshBudgetMs() { return Settings::instance().current().windowScannerRefreshBudgetMs; }
     }
 
     // WindowTile Configuration
     namespace WindowTile
     {
-        inline int width() { return Settings::instance().tileWidth; }
-        inline int height() { return Settings::instance().tileHeight; }
-        inline int iconSize() { return Settings::instance().tileIconSize; }
-        inline int contentMargin() { return Settings::instance().tileContentMargin; }
-        inline int internalSpacing() { return Settings::instance().tileInternalSpacing; }
-        inline bool enableShiftClickClose() { return Settings::instance().tileEnableShiftClickClose; }
+        inline int width() { return Settings::instance().current().tileWidth; }
+        inline int height() { return Settings::instance().current().tileHeight; }
+        inline int iconSize() { return Settings::instance().current().tileIconSize; }
+        inline int contentMargin() { return Settings::instance().current().tileContentMargin; }
+        inline int internalSpacing() { return Settings::instance().current().tileInternalSpacing; }
+        inline bool enableShiftClickClose() { return Settings::instance().current().tileEnableShiftClickClose; }
     }
 
     // Display Configuration
     namespace Display
     {
-        inline int targetDisplayIndex() { return Settings::instance().targetDisplayIndex; }
+        inline int targetDisplayIndex() { return Settings::instance().current().targetDisplayIndex; }
+        inline bool panelPerScreen() { return Settings::instance().current().displayPanelPerScreen; }
+    }
+
+    // Filter Configuration
+    namespace Filter
+    {
+        inline QStringList excludeProcesses() { return Settings::instance().current().filterExcludeProcesses; }
+        inline QStringList excludeClasses() { return Settings::instance().current().filterExcludeClasses; }
+        inline QStringList excludeTitlePatterns() { return Settings::instance().current().filterExcludeTitlePatterns; }
+        inline QStringList includeProcesses() { return Settings::instance().current().filterIncludeProcesses; }
+        inline QStringList includeClasses() { return Settings::instance().current().filterIncludeClasses; }
+        inline QStringList includeTitlePatterns() { return Settings::instance().current().filterIncludeTitlePatterns; }
+        inline quint32 excludeStyleMask() { return Settings::instance().current().filterExcludeStyleMask; }
+        inline quint32 excludeExStyleMask() { return Settings::instance().current().filterExcludeExStyleMask; }
+    }
+
+    // Sort Configuration
+    namespace Sort
+    {
+        // true: most frequently and recently used applications first; false: alphabetical
+        inline bool byFrecency() { return Settings::instance().current().sortByFrecency; }
+        inline double frecencyHalfLifeHours() { return Settings::instance().current().sortFrecencyHalfLifeHours; }
+    }
+
+    // Journal Configuration
+    namespace Journal
+    {
+        inline bool enabled() { return Settings::instance().current().journalEnabled; }
+        inline int flushIntervalMs() { return Settings::instance().current().journalFlushIntervalMs; }
+        inline int retentionHours() { return Settings::instance().current().journalRetentionHours; }
+        inline int maxFileSizeKB() { return Settings::instance().current().journalMaxFileSizeKB; }
+    }
+
+    // Shared Table Configuration
+    namespace SharedTable
+    {
+        inline bool enabled() { return Settings::instance().current().sharedTableEnabled; }
+    }
+
+    // Search Configuration
+    namespace Search
+    {
+        inline bool openOnHotkey() { return Settings::instance().current().searchOpenOnHotkey; }
+    }
+
+    // Thumbnail Configuration
+    namespace Thumbnail
+    {
+        // Hover previews, captured off the GUI thread and cached up to CacheSizeKB
+        inline bool enabled() { return Settings::instance().current().thumbnailEnabled; }
+        inline int hoverDelayMs() { return Settings::instance().current().thumbnailHoverDelayMs; }
+        // Age after which a cached preview is shown but captured again (0 = never)
+        inline int maxAgeMs() { return Settings::instance().current().thumbnailMaxAgeMs; }
+        inline int cacheSizeKB() { return Settings::instance().current().thumbnailCacheSizeKB; }
+    }
+
+    // Grouping Configuration
+    namespace Grouping
+    {
+        // Processes with at least MinWindows windows are shown as one group tile
+        inline bool enabled() { return Settings::instance().current().groupingEnabled; }
+        inline int minWindows() { return Settings::instance().current().groupingMinWindows; }
+    }
+
+    // Activation Configuration
+    namespace Activation
+    {
+        // Time each foreground strategy gets to take effect before the next one is tried
+        inline int confirmTimeoutMs() { return Settings::instance().current().activationConfirmTimeoutMs; }
+    }
+
+    // Startup Configuration
+    namespace Startup
+    {
+        // Paint the first tiles from the window list saved at the last exit
+        inline bool useSnapshot() { return Settings::instance().current().startupUseSnapshot; }
+        inline int firstPaintBudgetMs() { return Settings::instance().current().startupFirstPaintBudgetMs; }
+    }
+
+    // Diagnostics Configuration
+    namespace Diagnostics
+    {
+        // Maximum allocations allowed in a refresh that changes nothing (default 32, -1 = no check).
+        // Only checked in builds configured with WINSELECTOR_ALLOC_TRACKING=ON.
+        inline int steadyStateAllocationBudget() { return Settings::instance().current().diagnosticsSteadyStateAllocationBudget; }
     }
 }
 
@@ -37,6 +37,13 @@ int FlowLayout::totalWidthForHeight(int height) const
     return doLayout(QRect(0, 0, 10000, height), true);
 }
 
+void FlowLayout::setSpacings(int hSpacing, int vSpacing)
+{
+    m_hSpace = hSpacing;
+    m_vSpace = vSpacing;
+    invalidate();
+}
+
 int FlowLayout::horizontalSpacing() const
 {
     if (m_hSpace >= 0)
@@ -162,6 +169,12 @@ int FlowLayout::doLayout(const QRect &rect, bool testOnly) const
 
     for (QLayoutItem *item : m_itemList)
     {
+        // Hidden tiles (e.g. filtered out by the search) take no space
+        if (item->isEmpty())
+        {
+            continue;
+        }
+
         QSize size = getItemSize(item, testOnly);
 
         // Check if we need to wrap to the next column
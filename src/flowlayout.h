@@ -58,6 +58,13 @@ public:
      * @return Vertical spacing in pixels
      */
     int verticalSpacing() const;
+
+    /**
+     * @brief Change the spacing between items
+     * @param hSpacing Horizontal spacing in pixels (-1 for the style default)
+     * @param vSpacing Vertical spacing in pixels (-1 for the style default)
+     */
+    void setSpacings(int hSpacing, int vSpacing);
     /**
      * @brief Get the expanding directions
      * @return Orientation flags
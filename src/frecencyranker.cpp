@@ -0,0 +1,165 @@
+#include "frecencyranker.h"
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr quint32 FileMagic = 0x57534652; // "WSFR"
+    // Version 1 did not store the decay rate its scores were built with
+    constexpr quint16 FileVersion = 2;
+
+    double logAddExp(double a, double b)
+    {
+        const double high = std::max(a, b);
+        const double low = std::min(a, b);
+        return high + std::log1p(std::exp(low - high));
+    }
+}
+
+FrecencyRanker::FrecencyRanker(double halfLifeSeconds)
+    : m_lambda(std::log(2.0) / std::max(halfLifeSeconds, 1.0))
+{
+}
+
+bool FrecencyRanker::recordActivation(const QString &key, qint64 timeSeconds)
+{
+    // e^(lambda * t) relative to the epoch, in the log domain
+    const double activation = m_lambda * static_cast<double>(timeSeconds);
+    m_latestActivation = std::max(m_latestActivation, timeSeconds);
+
+    auto it = m_scores.find(key);
+    const bool known = it != m_scores.end();
+    // A new key starts below the last entry
+    const int oldRank = known ? m_ranks.value(key) : size();
+    double logScore = activation;
+    if (known)
+    {
+        logScore = logAddExp(it.value(), activation);
+        m_order.erase(OrderKey(it.value(), key));
+        it.value() = logScore;
+    }
+    else
+    {
+        m_scores.insert(key, logScore);
+    }
+    const auto position = m_order.insert(OrderKey(logScore, key)).first;
+
+    // The score only grows, so the entries between the new and the old
+    // position each move down by one; the first of them held the new rank
+    int newRank = oldRank;
+    for (auto next = std::next(position); next != m_order.end(); ++next)
+    {
+        int &rank = m_ranks[next->second];
+        if (rank >= oldRank)
+        {
+            break;
+        }
+        newRank = std::min(newRank, rank);
+        ++rank;
+    }
+    m_ranks.insert(key, newRank);
+
+    if (known && newRank == oldRank)
+    {
+        return false;
+    }
+    ++m_revision;
+    return true;
+}
+
+int FrecencyRanker::rank(const QString &key) const
+{
+    return m_ranks.value(key, Unranked);
+}
+
+double FrecencyRanker::score(const QString &key, qint64 nowSeconds) const
+{
+    auto it = m_scores.constFind(key);
+    if (it == m_scores.constEnd())
+    {
+        return 0.0;
+    }
+    return std::exp(it.value() - m_lambda * static_cast<double>(nowSeconds));
+}
+
+bool FrecencyRanker::load(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    double savedLambda = 0.0;
+    qint64 latestActivation = 0;
+    quint32 count = 0;
+    in >> magic >> version;
+    if (magic != FileMagic || version != FileVersion)
+    {
+        return false;
+    }
+    in >> savedLambda >> latestActivation >> count;
+    if (in.status() != QDataStream::Ok || !std::isfinite(savedLambda) || savedLambda <= 0.0 ||
+        count > MaxSavedEntries)
+    {
+        return false;
+    }
+
+    // Keep every score's value at the newest activation: ln(score) + lambda * t
+    // is the same under both rates there, and adding one offset keeps the order
+    const double offset = (m_lambda - savedLambda) * static_cast<double>(latestActivation);
+
+    m_scores.clear();
+    m_order.clear();
+    m_ranks.clear();
+    m_latestActivation = latestActivation;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        QString key;
+        double logScore = 0.0;
+        in >> key >> logScore;
+        if (in.status() == QDataStream::Ok && !key.isEmpty() && std::isfinite(logScore) &&
+            !m_scores.contains(key))
+        {
+            m_scores.insert(key, logScore + offset);
+            m_order.insert(OrderKey(logScore + offset, key));
+        }
+    }
+
+    int rank = 0;
+    for (const OrderKey &entry : m_order)
+    {
+        m_ranks.insert(entry.second, rank++);
+    }
+    ++m_revision;
+    return in.status() == QDataStream::Ok;
+}
+
+bool FrecencyRanker::save(const QString &path) const
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    const quint32 count = static_cast<quint32>(std::min<size_t>(m_order.size(), MaxSavedEntries));
+    out << FileMagic << FileVersion << m_lambda << m_latestActivation << count;
+
+    // Best first, so truncation drops the least likely applications
+    quint32 written = 0;
+    for (auto it = m_order.begin(); it != m_order.end() && written < count; ++it, ++written)
+    {
+        out << it->second << it->first;
+    }
+    return file.commit();
+}
@@ -0,0 +1,102 @@
+#ifndef FRECENCYRANKER_H
+#define FRECENCYRANKER_H
+
+#include <QHash>
+#include <QString>
+#include <climits>
+#include <functional>
+#include <set>
+#include <utility>
+
+/**
+ * @brief Ranks applications by how often and how recently they were activated
+ *
+ * Each activation adds 1 to an application's score and every score decays
+ * exponentially with a configurable half-life. Scores are kept in the log domain
+ * relative to a fixed epoch: ln(sum of e^(lambda * t_i)). Decay multiplies every
+ * score by the same factor, so it never changes the order and no score has to be
+ * touched as time passes; an activation is a single log-add-exp. The order is
+ * kept in a balanced tree and the ranks in a hash next to it. An activation
+ * only moves its application up, so it renumbers just the entries it passes.
+ *
+ * The class has no Win32 dependency.
+ */
+class FrecencyRanker
+{
+public:
+    static constexpr int Unranked = INT_MAX;
+
+    /**
+     * @brief Construct an empty ranker
+     * @param halfLifeSeconds Time after which an activation counts half
+     */
+    explicit FrecencyRanker(double halfLifeSeconds);
+
+    /**
+     * @brief Record an activation
+     * @param key Application key (e.g. the process name)
+     * @param timeSeconds Time of the activation, in seconds since the Unix epoch
+     * @return true if the order changed, i.e. the application was new or moved up
+     */
+    bool recordActivation(const QString &key, qint64 timeSeconds);
+
+    /**
+     * @brief Get the rank of an application
+     * @param key Application key
+     * @return 0 for the highest score, Unranked if never activated
+     */
+    int rank(const QString &key) const;
+
+    /**
+     * @brief Get the decayed score of an application
+     * @param key Application key
+     * @param nowSeconds Current time, in seconds since the Unix epoch
+     * @return Score (number of recent activations, decayed), 0 if never activated
+     */
+    double score(const QString &key, qint64 nowSeconds) const;
+
+    /**
+     * @brief Get a counter that changes whenever the order changed
+     * @return Revision, never 0
+     */
+    quint64 revision() const { return m_revision; }
+
+    /**
+     * @brief Get the number of ranked applications
+     * @return Entry count
+     */
+    int size() const { return static_cast<int>(m_scores.size()); }
+
+    /**
+     * @brief Replace the scores with the contents of a file
+     *
+     * Scores saved with another half-life are rescaled so that every score
+     * keeps its value at the time of the last saved activation and decays
+     * with the current half-life from then on; the order is preserved.
+     * @param path File written by save()
+     * @return false if the file is missing, not a valid score file, or written
+     *         by a version that did not record the half-life
+     */
+    bool load(const QString &path);
+
+    /**
+     * @brief Write the scores to a file, keeping only the best MaxSavedEntries
+     * @param path Destination file
+     * @return false on I/O error
+     */
+    bool save(const QString &path) const;
+
+private:
+    static constexpr int MaxSavedEntries = 512;
+
+    using OrderKey = std::pair<double, QString>;
+
+    double m_lambda;                ///< Decay rate per second
+    qint64 m_latestActivation = 0;  ///< Time of the newest activation, in seconds since the Unix epoch
+    QHash<QString, double> m_scores;
+    std::set<OrderKey, std::greater<OrderKey>> m_order;
+    QHash<QString, int> m_ranks;  ///< Position of every key in m_order
+    quint64 m_revision = 1;
+};
+
+#endif // FRECENCYRANKER_H
@@ -0,0 +1,131 @@
+#include "activityjournal.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <climits>
+
+/**
+ * @brief Parse a time bound: an ISO 8601 date/time or a relative "-<n>h" / "-<n>m"
+ * @param text Option value
+ * @param ok Set to false if the value cannot be parsed
+ * @return Milliseconds since the Unix epoch
+ */
+static qint64 parseTime(const QString &text, bool *ok)
+{
+    *ok = true;
+    if (text.startsWith('-') && text.size() > 2)
+    {
+        const qint64 amount = text.mid(1, text.size() - 2).toLongLong(ok);
+        const QChar unit = text.back();
+        const qint64 unitMs = unit == 'h' ? 3600 * 1000 : unit == 'm' ? 60 * 1000 : 0;
+        if (*ok && unitMs > 0)
+        {
+            return QDateTime::currentMSecsSinceEpoch() - amount * unitMs;
+        }
+    }
+    const QDateTime time = QDateTime::fromString(text, Qt::ISODate);
+    *ok = time.isValid();
+    return time.toMSecsSinceEpoch();
+}
+
+/**
+ * @brief Command line tool that prints records from the WinSelector activity journal
+ * @param argc Command line argument count
+ * @param argv Command line argument values
+ * @return 0 on success, 1 on error
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("WinSelectorJournal");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Query the WinSelector window activity journal.");
+    parser.addHelpOption();
+    QCommandLineOption fileOption("file", "Journal file (default: Journal.dat).", "path", "Journal.dat");
+    QCommandLineOption sinceOption("since", "Only records at or after this time (ISO 8601 or -<n>h / -<n>m).", "time");
+    QCommandLineOption untilOption("until", "Only records before this time (ISO 8601 or -<n>h / -<n>m).", "time");
+    QCommandLineOption handleOption("handle", "Only records of this window handle (e.g. 0x1a2b).", "hwnd");
+    QCommandLineOption typeOption("type", "Only records of this type (appeared, disappeared, title, activated).", "type");
+    QCommandLineOption titleOption("title", "Only records whose title contains this text.", "text");
+    QCommandLineOption countOption("count", "Print only the number of matching records.");
+    parser.addOptions({fileOption, sinceOption, untilOption, handleOption, typeOption, titleOption, countOption});
+    parser.process(app);
+
+    QTextStream err(stderr);
+    bool ok = true;
+    const qint64 since = parser.isSet(sinceOption) ? parseTime(parser.value(sinceOption), &ok) : LLONG_MIN;
+    if (!ok)
+    {
+        err << "Invalid --since value\n";
+        return 1;
+    }
+    const qint64 until = parser.isSet(untilOption) ? parseTime(parser.value(untilOption), &ok) : LLONG_MAX;
+    if (!ok)
+    {
+        err << "Invalid --until value\n";
+        return 1;
+    }
+    const quint64 handle = parser.isSet(handleOption) ? parser.value(handleOption).toULongLong(&ok, 0) : 0;
+    if (!ok)
+    {
+        err << "Invalid --handle value\n";
+        return 1;
+    }
+    const QString type = parser.value(typeOption);
+    const QString title = parser.value(titleOption);
+    const bool countOnly = parser.isSet(countOption);
+
+    QTextStream out(stdout);
+    quint64 scanned = 0;
+    quint64 matched = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool valid = ActivityJournal::read(parser.value(fileOption),
+        [&](const ActivityJournal::Record &record)
+        {
+            ++scanned;
+            // Records are appended in time order
+            if (record.timeMs >= until)
+            {
+                return false;
+            }
+            if (record.timeMs < since || (handle != 0 && record.handle != handle) ||
+                (!type.isEmpty() && type != QLatin1String(ActivityJournal::typeName(record.type))) ||
+                (!title.isEmpty() && !record.text.contains(title, Qt::CaseInsensitive)))
+            {
+                return true;
+            }
+
+            ++matched;
+            if (!countOnly)
+            {
+                out << QDateTime::fromMSecsSinceEpoch(record.timeMs).toString(Qt::ISODateWithMs) << ' '
+                    << ActivityJournal::typeName(record.type) << " 0x" << QString::number(record.handle, 16)
+                    << " pid=" << record.processId;
+                if (!record.text.isEmpty())
+                {
+                    out << " \"" << record.text << '"';
+                }
+                out << '\n';
+            }
+            return true;
+        });
+
+    if (!valid)
+    {
+        err << "Cannot read journal " << parser.value(fileOption) << '\n';
+        return 1;
+    }
+    if (countOnly)
+    {
+        out << matched << '\n';
+    }
+    out.flush();
+    err << scanned << " records scanned, " << matched << " matched in " << timer.elapsed() << " ms\n";
+    return 0;
+}
@@ -0,0 +1,52 @@
+#include "lazyfieldstats.h"
+#include <QDebug>
+
+namespace
+{
+    constexpr int FieldCount = static_cast<int>(LazyFieldStats::Field::Count);
+
+    // Updated from the GUI thread only
+    quint64 s_deferred[FieldCount] = {};
+    quint64 s_requested[FieldCount] = {};
+}
+
+void LazyFieldStats::deferred(Field field)
+{
+    ++s_deferred[static_cast<int>(field)];
+}
+
+void LazyFieldStats::requested(Field field)
+{
+    ++s_requested[static_cast<int>(field)];
+}
+
+quint64 LazyFieldStats::deferredCount(Field field)
+{
+    return s_deferred[static_cast<int>(field)];
+}
+
+quint64 LazyFieldStats::requestedCount(Field field)
+{
+    return s_requested[static_cast<int>(field)];
+}
+
+void LazyFieldStats::report()
+{
+    for (int i = 0; i < FieldCount; ++i)
+    {
+        const Field field = static_cast<Field>(i);
+        qDebug() << "Lazy field" << fieldName(field) << "-" << s_deferred[i] << "deferred,"
+                 << s_requested[i] << "requested," << (s_deferred[i] - s_requested[i]) << "never requested";
+    }
+}
+
+const char *LazyFieldStats::fieldName(Field field)
+{
+    switch (field)
+    {
+    case Field::ProcessPath: return "processPath";
+    case Field::Icon: return "icon";
+    case Field::Tooltip: return "tooltip";
+    default: return "unknown";
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef LAZYFIELDSTATS_H
+#define LAZYFIELDSTATS_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Counters for window metadata that is resolved on first use
+ *
+ * Each lazily resolved field counts how many values were created unresolved
+ * and how many of them were actually requested later. The difference is work
+ * the scan no longer does up front.
+ */
+class LazyFieldStats
+{
+public:
+    enum class Field
+    {
+        ProcessPath,
+        Icon,
+        Tooltip,
+        Count
+    };
+
+    /**
+     * @brief Record that a value was created without resolving it
+     * @param field Field kind
+     */
+    static void deferred(Field field);
+
+    /**
+     * @brief Record that a deferred value was resolved because someone asked for it
+     * @param field Field kind
+     */
+    static void requested(Field field);
+
+    /**
+     * @brief Get the number of deferred values of a field
+     * @param field Field kind
+     * @return Deferred count
+     */
+    static quint64 deferredCount(Field field);
+
+    /**
+     * @brief Get the number of deferred values that were later requested
+     * @param field Field kind
+     * @return Requested count
+     */
+    static quint64 requestedCount(Field field);
+
+    /**
+     * @brief Log deferred / requested / never requested counts for every field
+     */
+    static void report();
+
+private:
+    static const char *fieldName(Field field);
+};
+
+#endif // LAZYFIELDSTATS_H
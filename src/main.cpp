@@ -1,8 +1,537 @@
 #include "mainwindow.h"
+#include "commandserver.h"
+#include "startupprofile.h"
+#include "thumbnailservice.h"
+#include "win32utils.h"
+#include "windowsearchindex.h"
+#include "windowscanner.h"
+#include "windowsnapshot.h"
 
 #include <QApplication>
-#include <QLocale>
-#include <QTranslator>
+#include <QElapsedTimer>
+#include <QIcon>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPixmap>
+#include <QTextStream>
+#include <algorithm>
+
+/**
+ * @brief Forward a command to the running instance and print the reply ("--send" mode)
+ * @param argc Command line argument count
+ * @param argv Command line argument values; argv[2..] form the command
+ * @return 0 on success, 1 if the command failed, 2 if no instance answered
+ */
+static int sendCommand(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    Win32Utils::attachParentConsole();
+
+    QTextStream out(stdout);
+    QString error;
+    const QString command = app.arguments().mid(2).join(' ');
+
+    // Streams until the running instance exits (or the user presses Ctrl+C)
+    if (command.trimmed().compare(QLatin1String("subscribe"), Qt::CaseInsensitive) == 0)
+    {
+        const int result = CommandServer::subscribe(
+            [&out](const QString &line)
+            {
+                out << line << '\n';
+                out.flush();
+            },
+            error);
+        if (result != 0)
+        {
+            QTextStream(stderr) << error << '\n';
+        }
+        return result;
+    }
+
+    QStringList output;
+    const int result = CommandServer::sendCommand(command, output, error);
+
+    for (const QString &line : std::as_const(output))
+    {
+        out << line << '\n';
+    }
+    out.flush();
+    if (result != 0)
+    {
+        QTextStream(stderr) << error << '\n';
+    }
+    return result;
+}
+
+/**
+ * @brief Scan the windows once and print them without starting the GUI ("--list" / "--json" mode)
+ * @param argc Command line argument count
+ * @param argv Command line argument values; "--timing" adds per-phase durations on stderr
+ * @return 0
+ */
+static int listWindows(int argc, char *argv[])
+{
+    QElapsedTimer timer;
+    timer.start();
+    QList<std::pair<const char *, qint64>> phases;
+    const auto endPhase = [&timer, &phases](const char *name) { phases.append({name, timer.nsecsElapsed()}); };
+
+    QCoreApplication app(argc, argv);
+    Win32Utils::attachParentConsole();
+    const QStringList arguments = app.arguments();
+    const bool json = arguments.contains(QLatin1String("--json"));
+    const bool timing = arguments.contains(QLatin1String("--timing"));
+    endPhase("startup");
+
+    // Loads Settings.ini for the [Filter] rules
+    WindowScanner scanner;
+    scanner.setUnbounded(true);
+    endPhase("settings");
+
+    // Icons are resolved lazily, so the scan never creates a pixmap here
+    QList<WindowInfo> &windows = scanner.scan();
+    endPhase("scan");
+
+    // Same order as the panel's alphabetical mode
+    std::sort(windows.begin(), windows.end(),
+              [](const WindowInfo &a, const WindowInfo &b)
+              {
+                  if (a.processName() != b.processName())
+                  {
+                      return a.processName() < b.processName();
+                  }
+                  return a.title != b.title ? a.title < b.title : a.hwnd < b.hwnd;
+              });
+    endPhase("sort");
+
+    QTextStream out(stdout);
+    if (json)
+    {
+        QJsonArray array;
+        for (const WindowInfo &info : std::as_const(windows))
+        {
+            array.append(QJsonObject{
+                {"handle", "0x" + QString::number(reinterpret_cast<quintptr>(info.hwnd), 16)},
+                {"pid", static_cast<qint64>(info.processId)},
+                {"process", info.processName()},
+                {"title", info.title}});
+        }
+        out << QJsonDocument(array).toJson(QJsonDocument::Indented);
+    }
+    else
+    {
+        // Tab-separated like "--send list": handle, process ID, process name, title
+        for (const WindowInfo &info : std::as_const(windows))
+        {
+            QString title = info.title;
+            title.replace('\t', ' ').replace('\n', ' ').replace('\r', ' ');
+            out << "0x" << QString::number(reinterpret_cast<quintptr>(info.hwnd), 16) << '\t' << info.processId
+                << '\t' << info.processName() << '\t' << title << '\n';
+        }
+    }
+    out.flush();
+    endPhase("output");
+
+    if (timing)
+    {
+        // On stderr so the listing itself stays machine-readable
+        QTextStream err(stderr);
+        qint64 previous = 0;
+        for (const auto &phase : std::as_const(phases))
+        {
+            err << phase.first << ": " << QString::number((phase.second - previous) / 1e6, 'f', 2) << " ms\n";
+            previous = phase.second;
+        }
+        const WindowScanner::ScanStats &stats = scanner.lastStats();
+        err << "total: " << QString::number(previous / 1e6, 'f', 2) << " ms (" << windows.size() << " windows, "
+            << stats.candidates << " candidates, " << stats.filtered << " filtered)\n";
+    }
+    return 0;
+}
+
+/**
+ * @brief Run the thumbnail pipeline on generated images and print its throughput ("--thumbnail-bench" mode)
+ *
+ * Uses SyntheticThumbnailSource, so it needs no windows: every request goes
+ * through the worker threads, the downscale and the byte-bounded cache.
+ * @param argc Command line argument count
+ * @param argv Command line argument values; argv[2] is the number of captures (default 500)
+ * @return 0 if the cache stayed within its byte limit, 1 otherwise
+ */
+static int benchmarkThumbnails(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    Win32Utils::attachParentConsole();
+    const QStringList arguments = app.arguments();
+    const int captures = arguments.size() > 2 ? qMax(1, arguments.at(2).toInt()) : 500;
+    const qsizetype cacheBytes = 4 * 1024 * 1024;
+
+    ThumbnailService service(std::make_unique<SyntheticThumbnailSource>(QSize(1920, 1080)),
+                             ThumbnailService::DefaultMaxSide, cacheBytes);
+    QElapsedTimer timer;
+    timer.start();
+
+    // Keeps the pool full; each capture is a new window, so the cache keeps evicting
+    quintptr nextHandle = 0;
+    int finished = 0;
+    qsizetype peakBytes = 0;
+    const auto feed = [&]()
+    {
+        while (nextHandle < quintptr(captures) && service.inFlight() < ThumbnailService::MaxInFlight)
+        {
+            service.request(++nextHandle, 0);
+        }
+    };
+    QObject::connect(&service, &ThumbnailService::thumbnailReady, &app,
+                     [&](quintptr)
+                     {
+                         peakBytes = qMax(peakBytes, service.cache().bytes());
+                         if (++finished == captures)
+                         {
+                             app.quit();
+                         }
+                         feed();
+                     });
+    feed();
+    app.exec();
+
+    const qint64 elapsedMs = qMax<qint64>(1, timer.elapsed());
+    const ThumbnailService::Metrics metrics = service.metrics();
+    QTextStream out(stdout);
+    out << captures << " captures in " << elapsedMs << " ms (" << captures * 1000 / elapsedMs << "/s)\n"
+        << "average capture " << metrics.captureNs / captures / 1000 << " us, downscale "
+        << metrics.downscaleNs / captures / 1000 << " us\n"
+        << "cache " << service.cache().count() << " thumbnails, peak " << peakBytes << " of " << cacheBytes
+        << " bytes\n";
+    return peakBytes <= cacheBytes ? 0 : 1;
+}
+
+namespace
+{
+    /**
+     * @brief WindowInfo as it was before process records were shared and icons referenced by ID
+     */
+    struct LegacyWindowInfo
+    {
+        HWND hwnd;
+        QString title;
+        QIcon icon;
+        QString processName;
+        DWORD processId;
+        QString processPath;
+    };
+
+    /**
+     * @brief Tile record of the per-window comparison that WindowSnapshot::diff() replaced
+     */
+    struct LegacyTileSlot
+    {
+        WindowInfo info;
+        quint64 generation = 0;
+    };
+
+    /**
+     * @brief Compare a scan record by record against the previous one, as updateTiles() used to
+     * @return Number of added, changed and removed windows
+     */
+    int legacyDiff(QHash<HWND, LegacyTileSlot> &previous, const QList<WindowInfo> &windows, quint64 generation)
+    {
+        int differences = 0;
+        for (const WindowInfo &info : windows)
+        {
+            const auto it = previous.find(info.hwnd);
+            if (it == previous.end())
+            {
+                ++differences;
+                continue;
+            }
+            it->generation = generation;
+            if (!(it->info == info) || it->info.iconId != info.iconId)
+            {
+                ++differences;
+            }
+        }
+        for (const LegacyTileSlot &slot : std::as_const(previous))
+        {
+            if (slot.generation != generation)
+            {
+                ++differences;
+            }
+        }
+        return differences;
+    }
+
+    /**
+     * @brief Fill a snapshot the way WindowScanner::scan() does
+     * @param changedIndex Window reported as retitled, or -1
+     */
+    void fillSnapshot(WindowSnapshot &snapshot, const QList<WindowInfo> &windows, qsizetype changedIndex)
+    {
+        snapshot.clear();
+        snapshot.reserve(windows.size());
+        for (qsizetype i = 0; i < windows.size(); ++i)
+        {
+            const WindowInfo &info = windows.at(i);
+            snapshot.append(reinterpret_cast<quintptr>(info.hwnd), info.processId, info.iconId, i == changedIndex);
+        }
+        snapshot.finalize();
+    }
+
+    /**
+     * @brief Heap bytes held by the character data of a string
+     */
+    qsizetype stringBytes(const QString &string)
+    {
+        return string.isNull() ? 0 : string.capacity() * qsizetype(sizeof(QChar)) + 16;
+    }
+
+    /**
+     * @brief Average time of a step over a number of runs
+     * @return Microseconds per run
+     */
+    template <typename Step>
+    double averageMicroseconds(int runs, Step step)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < runs; ++i)
+        {
+            step();
+        }
+        return timer.nsecsElapsed() / 1000.0 / runs;
+    }
+}
+
+/**
+ * @brief Measure the window list operations of a refresh on generated windows ("--scan-bench" mode)
+ *
+ * Builds the same windows once as WindowInfo records and once in the layout
+ * WindowInfo had before process records were shared (LegacyWindowInfo), then
+ * times copying and sorting both lists the way the panel does. It also times
+ * WindowSnapshot::diff() against the record-by-record comparison it replaced,
+ * for an unchanged scan and for a scan with one retitled window. Needs no windows.
+ * @param argc Command line argument count
+ * @param argv Command line argument values; argv[2] is the number of windows (default 1000)
+ * @return 0
+ */
+static int benchmarkScan(int argc, char *argv[])
+{
+    QGuiApplication app(argc, argv);
+    Win32Utils::attachParentConsole();
+    const QStringList arguments = app.arguments();
+    const int count = arguments.size() > 2 ? qMax(1, arguments.at(2).toInt()) : 1000;
+    const int runs = qMax(1, 200000 / count);
+    constexpr int WindowsPerProcess = 8;
+
+    QPixmap pixmap(32, 32);
+    pixmap.fill(Qt::darkCyan);
+
+    QList<WindowInfo> windows;
+    QList<LegacyWindowInfo> legacy;
+    windows.reserve(count);
+    legacy.reserve(count);
+    WindowInfo::ProcessRef process;
+    for (int i = 0; i < count; ++i)
+    {
+        // Reverse process order so the sort has work to do
+        const int processIndex = (count - 1 - i) / WindowsPerProcess;
+        if (i % WindowsPerProcess == 0)
+        {
+            process = WindowInfo::ProcessRef(new ProcessRecord);
+            process->processId = DWORD(1000 + processIndex);
+            process->name = QStringLiteral("application%1.exe").arg(processIndex);
+            process->path = QStringLiteral("C:\\Program Files\\Application %1\\application%1.exe").arg(processIndex);
+            process->pathResolved = true;
+        }
+        WindowInfo info;
+        info.hwnd = reinterpret_cast<HWND>(quintptr(0x10000 + i * 16));
+        info.processId = process->processId;
+        info.iconId = Win32Utils::IconId(i + 1);
+        info.title = QStringLiteral("Document %1 - Application %2").arg(count - i).arg(processIndex);
+        info.process = process;
+        windows.append(info);
+
+        // Every window used to carry its own icon and its own copy of the process strings
+        legacy.append(LegacyWindowInfo{info.hwnd, info.title, QIcon(pixmap),
+                                       QString(process->name.constData(), process->name.size()), process->processId,
+                                       QString(process->path.constData(), process->path.size())});
+    }
+
+    qsizetype bytes = qsizetype(sizeof(WindowInfo)) * count;
+    qsizetype legacyBytes = qsizetype(sizeof(LegacyWindowInfo)) * count;
+    for (int i = 0; i < count; ++i)
+    {
+        bytes += stringBytes(windows.at(i).title);
+        if (i % WindowsPerProcess == 0)
+        {
+            bytes += qsizetype(sizeof(ProcessRecord)) + stringBytes(windows.at(i).processName()) +
+                     stringBytes(windows.at(i).process->path);
+        }
+        legacyBytes += stringBytes(legacy.at(i).title) + stringBytes(legacy.at(i).processName) +
+                       stringBytes(legacy.at(i).processPath);
+    }
+
+    // Same order as the panel's alphabetical mode
+    const auto lessThan = [](const WindowInfo &a, const WindowInfo &b)
+    {
+        if (a.processName() != b.processName())
+        {
+            return a.processName() < b.processName();
+        }
+        return a.title != b.title ? a.title < b.title : a.hwnd < b.hwnd;
+    };
+    const auto legacyLessThan = [](const LegacyWindowInfo &a, const LegacyWindowInfo &b)
+    {
+        if (a.processName != b.processName)
+        {
+            return a.processName < b.processName;
+        }
+        return a.title != b.title ? a.title < b.title : a.hwnd < b.hwnd;
+    };
+
+    const double copyUs = averageMicroseconds(runs, [&]()
+                                              {
+                                                  QList<WindowInfo> copy = windows;
+                                                  copy.detach();
+                                              });
+    const double legacyCopyUs = averageMicroseconds(runs, [&]()
+                                                    {
+                                                        QList<LegacyWindowInfo> copy = legacy;
+                                                        copy.detach();
+                                                    });
+    const double sortUs = averageMicroseconds(runs, [&]()
+                                              {
+                                                  QList<WindowInfo> copy = windows;
+                                                  std::sort(copy.begin(), copy.end(), lessThan);
+                                              });
+    const double legacySortUs = averageMicroseconds(runs, [&]()
+                                                    {
+                                                        QList<LegacyWindowInfo> copy = legacy;
+                                                        std::sort(copy.begin(), copy.end(), legacyLessThan);
+                                                    });
+
+    // Scan-to-scan comparison
+    const int diffRuns = qMax(1, 20000000 / count);
+    QList<WindowInfo> retitled = windows;
+    retitled[count / 2].title += QLatin1Char('*');
+    QHash<HWND, LegacyTileSlot> tiles;
+    tiles.reserve(count);
+    for (const WindowInfo &info : std::as_const(windows))
+    {
+        tiles.insert(info.hwnd, LegacyTileSlot{info, 0});
+    }
+    quint64 generation = 0;
+    int differences = 0;
+    const double legacyDiffUs = averageMicroseconds(diffRuns, [&]()
+                                                    { differences += legacyDiff(tiles, windows, ++generation); });
+    const double legacyChangedDiffUs = averageMicroseconds(diffRuns, [&]()
+                                                           { differences += legacyDiff(tiles, retitled, ++generation); });
+
+    WindowSnapshot before;
+    WindowSnapshot after;
+    WindowSnapshot changed;
+    fillSnapshot(before, windows, -1);
+    fillSnapshot(after, windows, -1);
+    fillSnapshot(changed, windows, count / 2);
+    SnapshotDiff diff;
+    const double diffUs = averageMicroseconds(diffRuns, [&]()
+                                              {
+                                                  WindowSnapshot::diff(before, after, diff);
+                                                  differences += int(diff.changed.size());
+                                              });
+    const double changedDiffUs = averageMicroseconds(diffRuns, [&]()
+                                                     {
+                                                         WindowSnapshot::diff(before, changed, diff);
+                                                         differences += int(diff.changed.size());
+                                                     });
+
+    QTextStream out(stdout);
+    out << count << " windows, " << runs << " runs each (diff " << diffRuns << "); before = LegacyWindowInfo\n"
+        << "record size: " << sizeof(WindowInfo) << " bytes (before " << sizeof(LegacyWindowInfo) << ")\n"
+        << "records + strings: " << bytes / 1024 << " KB (before " << legacyBytes / 1024 << " KB)\n"
+        << "copy list: " << QString::number(copyUs, 'f', 1) << " us (before "
+        << QString::number(legacyCopyUs, 'f', 1) << " us)\n"
+        << "copy + sort: " << QString::number(sortUs, 'f', 1) << " us (before "
+        << QString::number(legacySortUs, 'f', 1) << " us)\n"
+        << "diff, unchanged: " << QString::number(diffUs, 'f', 2) << " us (before "
+        << QString::number(legacyDiffUs, 'f', 2) << " us)\n"
+        << "diff, one title changed: " << QString::number(changedDiffUs, 'f', 2) << " us (before "
+        << QString::number(legacyChangedDiffUs, 'f', 2) << " us)\n";
+    // Keeps the compiler from dropping the measured loops
+    return differences < 0 ? 1 : 0;
+}
+
+/**
+ * @brief Time the search box on generated window titles ("--search-bench" mode)
+ *
+ * Builds a WindowSearchIndex from generated titles and process names, then
+ * types each query one character at a time: once with every keystroke scanning
+ * the whole index (fresh), and once as the search box does while the window
+ * list is unchanged, each keystroke re-checking only the previous matches
+ * (narrowing). Needs no windows.
+ * @param argc Command line argument count
+ * @param argv Command line argument values; argv[2] is the number of windows (default 5000)
+ * @return 0 if the queries matched any window, 1 otherwise
+ */
+static int benchmarkSearch(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    Win32Utils::attachParentConsole();
+    const QStringList arguments = app.arguments();
+    const int count = arguments.size() > 2 ? qMax(1, arguments.at(2).toInt()) : 5000;
+    const int runs = qMax(1, 500000 / count);
+
+    const QStringList words = {QStringLiteral("Report"),  QStringLiteral("Invoice"), QStringLiteral("Budget"),
+                               QStringLiteral("Meeting"), QStringLiteral("Notes"),   QStringLiteral("Draft"),
+                               QStringLiteral("Summary"), QStringLiteral("Design"),  QStringLiteral("Review"),
+                               QStringLiteral("Backlog"), QStringLiteral("Release"), QStringLiteral("Schedule")};
+    const QStringList applications = {QStringLiteral("Notepad"), QStringLiteral("Explorer"),
+                                      QStringLiteral("Word"),    QStringLiteral("Excel"),
+                                      QStringLiteral("Visual Studio Code"), QStringLiteral("Firefox"),
+                                      QStringLiteral("Terminal"), QStringLiteral("Outlook")};
+    WindowSearchIndex index;
+    for (int i = 0; i < count; ++i)
+    {
+        const QString &application = applications.at(i % applications.size());
+        const QString title = QStringLiteral("%1 %2 %3 - %4")
+                                  .arg(words.at(i % words.size()), words.at(i / words.size() % words.size()))
+                                  .arg(i)
+                                  .arg(application);
+        QString processName = application.toLower();
+        processName.remove(QLatin1Char(' '));
+        index.upsert(quintptr(0x10000 + i * 16), title, processName + QLatin1String(".exe"));
+    }
+
+    // Prefix, word prefix, substring and fuzzy matches
+    const QStringList queries = {QStringLiteral("meeting"), QStringLiteral("studio"), QStringLiteral("view 12"),
+                                 QStringLiteral("rptxl")};
+    size_t matches = 0;
+    QTextStream out(stdout);
+    out << count << " windows, " << runs << " runs each\n";
+    for (const QString &query : queries)
+    {
+        const auto type = [&](bool narrowing)
+        {
+            index.search(QStringView());
+            for (qsizetype length = 1; length <= query.size(); ++length)
+            {
+                // An empty query drops the previous matches, so the next one scans the whole index
+                if (!narrowing)
+                {
+                    index.search(QStringView());
+                }
+                matches += index.search(QStringView(query).left(length)).size();
+            }
+        };
+        const double freshUs = averageMicroseconds(runs, [&]() { type(false); });
+        const double narrowingUs = averageMicroseconds(runs, [&]() { type(true); });
+        out << "\"" << query << "\" (" << query.size() << " keystrokes, " << index.search(query).size()
+            << " matches): fresh " << QString::number(freshUs, 'f', 1) << " us, narrowing "
+            << QString::number(narrowingUs, 'f', 1) << " us\n";
+    }
+    return matches > 0 ? 0 : 1;
+}
 
 /**
  * @brief Main entry point of the application
@@ -12,20 +541,47 @@
  */
 int main(int argc, char *argv[])
 {
+    // Thin client: no widgets, just one round trip to the running instance
+    if (argc > 1 && qstrcmp(argv[1], "--send") == 0)
+    {
+        return sendCommand(argc, argv);
+    }
+    // Headless: no widgets, no instance check, just one scan
+    if (argc > 1 && (qstrcmp(argv[1], "--list") == 0 || qstrcmp(argv[1], "--json") == 0))
+    {
+        return listWindows(argc, argv);
+    }
+    if (argc > 1 && qstrcmp(argv[1], "--thumbnail-bench") == 0)
+    {
+        return benchmarkThumbnails(argc, argv);
+    }
+    if (argc > 1 && qstrcmp(argv[1], "--scan-bench") == 0)
+    {
+        return benchmarkScan(argc, argv);
+    }
+    if (argc > 1 && qstrcmp(argv[1], "--search-bench") == 0)
+    {
+        return benchmarkSearch(argc, argv);
+    }
+
+    StartupProfile::start();
     QApplication a(argc, argv);
+    StartupProfile::mark("application");
 
-    QTranslator translator;
-    const QStringList uiLanguages = QLocale::system().uiLanguages();
-    for (const QString &locale : uiLanguages)
+    // Single instance: show the running panel instead of opening a second one
     {
-        const QString baseName = "WinSelector_" + QLocale(locale).name();
-        if (translator.load(":/i18n/" + baseName))
+        QStringList output;
+        QString error;
+        if (CommandServer::sendCommand("show", output, error) != 2)
         {
-            a.installTranslator(&translator);
-            break;
+            return 0;
         }
     }
+    StartupProfile::mark("instance check");
+
+    // The translation is installed by MainWindow after the first paint
     MainWindow w;
     w.show();
+    StartupProfile::mark("window shown");
     return a.exec();
 }
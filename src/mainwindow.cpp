@@ -4,45 +4,551 @@
 #include "ui_mainwindow.h"
 #include "config.h"
 #include "win32utils.h"
+#include "allocationtracker.h"
+#include "lazyfieldstats.h"
+#include "commandserver.h"
+#include "sharedwindowtable.h"
+#include "settingswatcher.h"
+#include "screenpanel.h"
+#include "thumbnailservice.h"
+#include "startupcache.h"
+#include "startupprofile.h"
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QKeyEvent>
+#include <QLabel>
+#include <QLineEdit>
+#include <QLocale>
+#include <QTranslator>
+#include <QVBoxLayout>
 #include <QScreen>
 #include <QGuiApplication>
 #include <algorithm>
-#include <QMap>
+#include <utility>
 #include <QMenu>
 #include <QAction>
 #include <QApplication>
 #include <QMenuBar>
 #include <QStatusBar>
+#include <QDateTime>
+#include <QRegularExpression>
+
+namespace
+{
+    const char FrecencyFileName[] = "Frecency.dat";
+    const char JournalFileName[] = "Journal.dat";
+    const char StartupCacheFileName[] = "Startup.dat";
+
+    constexpr int PreviewGap = 8;
+
+    // Group size at which windows of one process share a group tile; 0 = off
+    int groupingMinimumSize()
+    {
+        return WinSelectorConfig::Grouping::enabled() ? WinSelectorConfig::Grouping::minWindows() : 0;
+    }
+
+    // Thumbnail source reading real windows
+    class WindowThumbnailSource : public ThumbnailSource
+    {
+    public:
+        QImage capture(quintptr handle) override
+        {
+            return Win32Utils::captureWindow(reinterpret_cast<HWND>(handle));
+        }
+    };
+
+    // Empty a layout without deleting its tiles
+    void clearLayout(QLayout *layout)
+    {
+        QLayoutItem *item;
+        while ((item = layout->takeAt(0)))
+        {
+            if (item->widget() && !qobject_cast<WindowTile *>(item->widget()))
+            {
+                // Delete any non-WindowTile widgets (shouldn't happen normally)
+                delete item->widget();
+            }
+            delete item;
+        }
+    }
+
+    // Shared table rows carry the tile state flags unchanged
+    static_assert(quint32(SharedWindowTableLayout::Active) == ShellWindowState::Active &&
+                      quint32(SharedWindowTableLayout::Flashing) == ShellWindowState::Flashing &&
+                      quint32(SharedWindowTableLayout::Minimized) == ShellWindowState::Minimized,
+                  "Shared table flags must match ShellWindowState");
+}
 
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), ui(new Ui::MainWindow)
+    : QMainWindow(parent), ui(new Ui::MainWindow),
+      m_frecency(WinSelectorConfig::Sort::frecencyHalfLifeHours() * 3600.0)
 {
     ui->setupUi(this);
+    setupScreens(); // Before setupUi(), which places the window on the target screen
     setupUi();
-    createTrayIcon();
+
+    // Screens are looked up again only when they change, never per refresh
+    auto watchScreen = [this](QScreen *screen)
+    {
+        connect(screen, &QScreen::availableGeometryChanged, this, [this]() { onScreensChanged(); });
+    };
+    for (QScreen *screen : QGuiApplication::screens())
+    {
+        watchScreen(screen);
+    }
+    connect(qGuiApp, &QGuiApplication::screenAdded, this, [this, watchScreen](QScreen *screen)
+            {
+                watchScreen(screen);
+                onScreensChanged();
+            });
+    connect(qGuiApp, &QGuiApplication::screenRemoved, this, &MainWindow::onScreensChanged);
+    connect(qGuiApp, &QGuiApplication::primaryScreenChanged, this, [this]() { onScreensChanged(); });
+
+    connect(&m_closeWatcher, &CloseWatcher::windowsGone, this, &MainWindow::onWindowsClosed);
+    connect(&m_activationService, &ActivationService::finished, this,
+            [this](HWND hwnd, bool success, qint64) { onActivationFinished(hwnd, success); });
 
     m_refreshTimer = new QTimer(this);
     connect(m_refreshTimer, &QTimer::timeout, this, &MainWindow::refreshWindows);
     m_refreshTimer->start(WinSelectorConfig::MainWindow::refreshIntervalMs());
 
+    m_minimizeTimer = new QTimer(this);
+    m_minimizeTimer->setSingleShot(true);
+    connect(m_minimizeTimer, &QTimer::timeout, this, &MainWindow::checkMinimized);
+
     m_iconRefreshTimer = new QTimer(this);
     connect(m_iconRefreshTimer, &QTimer::timeout, this, []() { Win32Utils::clearIconCache(); });
     m_iconRefreshTimer->start(WinSelectorConfig::MainWindow::iconRefreshIntervalMs());
 
-    refreshWindows();
+    if (WinSelectorConfig::Sort::byFrecency())
+    {
+        m_frecency.load(FrecencyFileName);
+        m_frecencyLoaded = true;
+    }
+    m_groups.setMinimumSize(groupingMinimumSize());
+
+    // The pool threads are only started by the first hover
+    m_thumbnails = new ThumbnailService(std::make_unique<WindowThumbnailSource>(), ThumbnailService::DefaultMaxSide,
+                                        qsizetype(WinSelectorConfig::Thumbnail::cacheSizeKB()) * 1024, this);
+    connect(m_thumbnails, &ThumbnailService::thumbnailReady, this, &MainWindow::onThumbnailReady);
+    m_previewTimer = new QTimer(this);
+    m_previewTimer->setSingleShot(true);
+    connect(m_previewTimer, &QTimer::timeout, this, &MainWindow::showPreview);
+
+    m_commandServer = new CommandServer([this](const QString &command, const QString &argument)
+                                        { return handleCommand(command, argument); },
+                                        this);
+    m_commandServer->listen();
+
+    // Push-based highlight; refreshWindows() still resynchronizes the
+    // foreground window in case a notification was missed
+    m_shellHookMessage = Win32Utils::registerShellHook((HWND)winId());
 
     // Register global hotkey (Home key)
     // ID 1 for toggle visibility
     Win32Utils::registerHotKey((HWND)winId(), 1, 0, Settings::instance().getToggleVisibilityKeyVk());
+    StartupProfile::mark("window setup");
+
+    // First paint from the tiles saved at the last exit; the scan that
+    // reconciles them runs in finishStartup()
+    if (WinSelectorConfig::Startup::useSnapshot() && restoreSnapshot())
+    {
+        m_reconcileRestored = true;
+        adjustWindowGeometry();
+        StartupProfile::mark("snapshot restore");
+    }
+    else
+    {
+        refreshWindows();
+        StartupProfile::mark("first scan");
+    }
+
+    // Everything else waits for the first paint of the tiles, or a second if
+    // the window is never exposed
+    m_containerWidget->installEventFilter(this);
+    QTimer::singleShot(1000, this, &MainWindow::finishStartup);
 }
 
 MainWindow::~MainWindow() 
 { 
     Win32Utils::unregisterHotKey((HWND)winId(), 1);
+    if (m_shellHookMessage)
+    {
+        Win32Utils::unregisterShellHook((HWND)winId());
+    }
+    if (m_frecencyDirty && !m_frecency.save(FrecencyFileName))
+    {
+        qWarning() << "Failed to save" << FrecencyFileName;
+    }
+    if (WinSelectorConfig::Startup::useSnapshot())
+    {
+        saveSnapshot();
+    }
+    delete m_journal; // Flushes the remaining records
+    delete m_sharedTable;
+    LazyFieldStats::report();
+    m_activationService.report();
+    m_thumbnails->report();
     delete ui; 
 }
 
+bool MainWindow::restoreSnapshot()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    std::vector<StartupCache::Entry> entries;
+    if (!StartupCache::load(StartupCacheFileName, entries))
+    {
+        return false;
+    }
+
+    const int budgetMs = WinSelectorConfig::Startup::firstPaintBudgetMs();
+    const quintptr foreground = reinterpret_cast<quintptr>(Win32Utils::getForegroundWindow());
+    QHash<quint32, WindowInfo::ProcessRef> processes;
+    QList<WindowInfo> restored;
+    for (const StartupCache::Entry &entry : entries)
+    {
+        if (budgetMs > 0 && timer.elapsed() >= budgetMs)
+        {
+            break;
+        }
+
+        // Handles are reused, so the window must still belong to the same process
+        HWND hwnd = reinterpret_cast<HWND>(entry.handle);
+        if (!Win32Utils::isValidWindow(hwnd) ||
+            Win32Utils::getWindowProcessId(hwnd) != entry.processId)
+        {
+            continue;
+        }
+
+        WindowInfo info;
+        info.hwnd = hwnd;
+        info.processId = entry.processId;
+        info.title = entry.title;
+        WindowInfo::ProcessRef &process = processes[entry.processId];
+        if (!process)
+        {
+            process = new ProcessRecord;
+            process->processId = entry.processId;
+            process->name = entry.processName;
+        }
+        info.process = process;
+        if (!entry.icon.isNull())
+        {
+            // Replaced by the real icon at the next icon cache refresh
+            info.iconId = Win32Utils::seedWindowIcon(hwnd, QIcon(QPixmap::fromImage(entry.icon)));
+        }
+
+        m_windowState.setMinimized(entry.handle, Win32Utils::isWindowMinimized(hwnd), m_changedStates);
+        if (entry.handle == foreground)
+        {
+            m_windowState.setForeground(foreground, m_changedStates);
+        }
+        // Grouped first, so no tile is created for a group that ends up collapsed
+        m_groups.add(entry.handle, info.processName(), m_windowState.flags(entry.handle));
+        restored.append(info);
+    }
+    m_changedStates.clear();
+
+    for (const WindowInfo &info : std::as_const(restored))
+    {
+        if (!windowInfo(info.hwnd))
+        {
+            addWindow(info);
+            m_windowOrder.append(info.hwnd);
+        }
+    }
+    syncGroups();
+    rebuildTileOrder();
+    placeTiles(true);
+
+    if (!m_windowOrder.isEmpty())
+    {
+        qDebug() << "Restored" << m_windowOrder.size() << "of" << entries.size() << "windows," << m_tiles.size()
+                 << "tiles in" << timer.elapsed() << "ms";
+    }
+    return !m_windowOrder.isEmpty();
+}
+
+void MainWindow::saveSnapshot()
+{
+    const int iconSize = WinSelectorConfig::WindowTile::iconSize();
+    std::vector<StartupCache::Entry> entries;
+    entries.reserve(m_windowOrder.size());
+    for (HWND hwnd : std::as_const(m_windowOrder))
+    {
+        const WindowInfo &info = *windowInfo(hwnd);
+        StartupCache::Entry entry;
+        entry.handle = reinterpret_cast<quintptr>(info.hwnd);
+        entry.processId = info.processId;
+        entry.processName = info.processName();
+        entry.title = info.title;
+        // Runs in the destructor: an icon no tile has shown yet is not worth a
+        // query to a window that may hang; StartupCache borrows the process icon
+        const QIcon icon = Win32Utils::resolvedIconById(info.iconId);
+        if (!icon.isNull())
+        {
+            entry.icon = icon.pixmap(iconSize).toImage();
+        }
+        entries.push_back(std::move(entry));
+    }
+    if (!StartupCache::save(StartupCacheFileName, entries))
+    {
+        qWarning() << "Failed to save" << StartupCacheFileName;
+    }
+}
+
+void MainWindow::finishStartup()
+{
+    if (std::exchange(m_startupFinished, true))
+    {
+        return;
+    }
+    StartupProfile::mark("first paint");
+
+    setupJournal();
+    setupSharedTable();
+    StartupProfile::mark("journal and shared table");
+
+    if (m_reconcileRestored)
+    {
+        // Drops restored windows that closed meanwhile and adds the rest
+        refreshWindows();
+        StartupProfile::mark("reconcile scan");
+    }
+
+    loadTranslation();
+    createTrayIcon();
+    StartupProfile::mark("tray and translation");
+
+    // Completes Settings.ini with the defaults of missing keys; done before
+    // the watcher starts so the write does not trigger a reload
+    Settings::instance().writeDefaults();
+    connect(new SettingsWatcher(this), &SettingsWatcher::changed, this, &MainWindow::onSettingsChanged);
+    StartupProfile::mark("settings watcher");
+
+    StartupProfile::report();
+}
+
+void MainWindow::loadTranslation()
+{
+    m_translator = new QTranslator(this);
+    const QStringList uiLanguages = QLocale::system().uiLanguages();
+    for (const QString &locale : uiLanguages)
+    {
+        const QString baseName = "WinSelector_" + QLocale(locale).name();
+        if (m_translator->load(":/i18n/" + baseName))
+        {
+            QCoreApplication::installTranslator(m_translator);
+            return;
+        }
+    }
+}
+
+WindowTile *MainWindow::createTile(const WindowInfo &info)
+{
+    WindowTile *tile = new WindowTile(info, m_containerWidget);
+    connect(tile, &WindowTile::activated, this, &MainWindow::activateWindow);
+    connect(tile, &WindowTile::closed, this, &MainWindow::closeWindow);
+    connect(tile, &WindowTile::launchRequested, this, &MainWindow::launchProcess);
+    connect(tile, &WindowTile::hoverChanged, this, &MainWindow::onTileHovered);
+    connect(tile, &WindowTile::selectionToggled, this, &MainWindow::toggleSelection);
+    connect(tile, &WindowTile::actionRequested, this, &MainWindow::onTileAction);
+    // Existing tiles are updated by onSettingsChanged()
+    tile->setEnableShiftClickClose(WinSelectorConfig::WindowTile::enableShiftClickClose());
+    m_tiles.insert(info.hwnd, tile);
+    return tile;
+}
+
+void MainWindow::addWindow(const WindowInfo &info)
+{
+    const quintptr handle = reinterpret_cast<quintptr>(info.hwnd);
+    m_groups.add(handle, info.processName(), m_windowState.flags(handle));
+    if (m_groups.isCollapsed(handle))
+    {
+        m_collapsedWindows.insert(info.hwnd, info);
+    }
+    else
+    {
+        applyWindowState(createTile(info));
+    }
+    m_searchIndex.upsert(handle, info.title, info.processName());
+}
+
+const WindowInfo *MainWindow::windowInfo(HWND hwnd) const
+{
+    if (const WindowTile *tile = m_tiles.value(hwnd))
+    {
+        return &tile->getInfo();
+    }
+    const auto it = m_collapsedWindows.constFind(hwnd);
+    return it != m_collapsedWindows.cend() ? &it.value() : nullptr;
+}
+
+bool MainWindow::updateWindowInfo(const WindowInfo &info)
+{
+    const quintptr handle = reinterpret_cast<quintptr>(info.hwnd);
+    if (WindowTile *tile = m_tiles.value(info.hwnd))
+    {
+        tile->setInfo(info);
+    }
+    else
+    {
+        m_collapsedWindows.insert(info.hwnd, info);
+    }
+    m_searchIndex.upsert(handle, info.title, info.processName());
+
+    // A placeholder got its process name, or the handle now belongs to another
+    // process. syncGroups() restyles both groups; a window that left a
+    // collapsed group for no group at all is materialized here
+    if (m_groups.setKey(handle, info.processName(), m_windowState.flags(handle)))
+    {
+        return setTileMaterialized(info.hwnd, !m_groups.isCollapsed(handle));
+    }
+    // The group tile shows the icon of one of the windows
+    m_groups.touch(handle);
+    return false;
+}
+
+bool MainWindow::syncGroups()
+{
+    bool tilesChanged = false;
+    const QList<QString> dirty = m_groups.takeDirty();
+    for (const QString &key : dirty)
+    {
+        const WindowGroups::Group *group = m_groups.find(key);
+        const bool grouped = group && m_groups.isGrouped(*group);
+        if (grouped)
+        {
+            // The group tile carries the info of its first window with the
+            // process name as title
+            WindowInfo info = *windowInfo(reinterpret_cast<HWND>(group->members.first()));
+            info.title = key;
+
+            WindowTile *&tile = m_groupTiles[key];
+            if (!tile)
+            {
+                tile = new WindowTile(info, m_containerWidget);
+                connect(tile, &WindowTile::groupToggled, this, &MainWindow::onGroupToggled);
+                connect(tile, &WindowTile::launchRequested, this, &MainWindow::launchProcess);
+                connect(tile, &WindowTile::groupActionRequested, this, &MainWindow::onGroupAction);
+                tilesChanged = true;
+            }
+            tile->setGroup(group->count(), group->expanded);
+            tile->setInfo(info);
+            tile->setActive(group->active > 0);
+            tile->setFlashing(group->flashing > 0);
+            tile->setMinimized(group->minimized == group->count());
+        }
+        else if (WindowTile *tile = m_groupTiles.take(key))
+        {
+            discardTile(tile);
+            tilesChanged = true;
+        }
+
+        if (group)
+        {
+            const bool collapsed = grouped && !group->expanded;
+            for (quintptr handle : group->members)
+            {
+                tilesChanged |= setTileMaterialized(reinterpret_cast<HWND>(handle), !collapsed);
+            }
+        }
+    }
+    return tilesChanged;
+}
+
+bool MainWindow::setTileMaterialized(HWND hwnd, bool materialized)
+{
+    if (materialized)
+    {
+        const auto it = m_collapsedWindows.constFind(hwnd);
+        if (it == m_collapsedWindows.cend())
+        {
+            return false;
+        }
+        WindowTile *tile = createTile(it.value());
+        m_collapsedWindows.erase(it);
+        applyWindowState(tile);
+        return true;
+    }
+
+    WindowTile *tile = m_tiles.take(hwnd);
+    if (!tile)
+    {
+        return false;
+    }
+    m_collapsedWindows.insert(hwnd, tile->getInfo());
+    m_selection.removeOne(hwnd);
+    if (hwnd == m_previewWindow)
+    {
+        hidePreview();
+    }
+    discardTile(tile);
+    return true;
+}
+
+void MainWindow::discardTile(WindowTile *tile)
+{
+    if (QLayout *layout = tile->parentWidget()->layout())
+    {
+        layout->removeWidget(tile);
+    }
+    m_orderedTiles.removeOne(tile);
+    delete tile;
+}
+
+void MainWindow::rebuildTileOrder()
+{
+    // Windows of one process are adjacent in the sorted order, so the group
+    // tile goes before the first of them
+    m_orderedTiles.clear();
+    QString previousProcess;
+    for (HWND hwnd : std::as_const(m_windowOrder))
+    {
+        if (!m_groupTiles.isEmpty())
+        {
+            const QString &process = windowInfo(hwnd)->processName();
+            if (process != previousProcess)
+            {
+                previousProcess = process;
+                if (WindowTile *groupTile = m_groupTiles.value(process))
+                {
+                    m_orderedTiles.append(groupTile);
+                }
+            }
+        }
+        if (WindowTile *tile = m_tiles.value(hwnd))
+        {
+            m_orderedTiles.append(tile);
+        }
+    }
+}
+
+void MainWindow::onGroupToggled(const QString &processName)
+{
+    const WindowGroups::Group *group = m_groups.find(processName);
+    if (!group)
+    {
+        return;
+    }
+    m_groups.setExpanded(processName, !group->expanded);
+    if (syncGroups())
+    {
+        rebuildTileOrder();
+        placeTiles(true);
+    }
+    if (m_searchEdit->isVisible())
+    {
+        applySearchFilter(); // Also adjusts the geometry
+    }
+    else
+    {
+        adjustWindowGeometry();
+    }
+}
+
 void MainWindow::setupUi()
 {
     // Window flags
@@ -57,17 +563,32 @@ void MainWindow::setupUi()
         statusBar()->hide();
     }
 
-    // Layout
-    m_containerWidget = new QWidget(this);
+    // Layout: search box (hidden until opened) above the tiles
+    QWidget *central = new QWidget(this);
+    QVBoxLayout *centralLayout = new QVBoxLayout(central);
+    centralLayout->setContentsMargins(0, 0, 0, 0);
+    centralLayout->setSpacing(0);
+
+    m_searchEdit = new QLineEdit(central);
+    m_searchEdit->setPlaceholderText(tr("Search windows"));
+    m_searchEdit->setClearButtonEnabled(true);
+    m_searchEdit->installEventFilter(this);
+    m_searchEdit->hide();
+    connect(m_searchEdit, &QLineEdit::textChanged, this, &MainWindow::applySearchFilter);
+    connect(m_searchEdit, &QLineEdit::returnPressed, this, &MainWindow::activateBestMatch);
+    centralLayout->addWidget(m_searchEdit);
+
+    m_containerWidget = new QWidget(central);
     m_flowLayout = new FlowLayout(m_containerWidget,
                                   WinSelectorConfig::Layout::margin(),
                                   WinSelectorConfig::Layout::hSpacing(),
                                   WinSelectorConfig::Layout::vSpacing());
     m_flowLayout->setRTL(true);
-    setCentralWidget(m_containerWidget);
+    centralLayout->addWidget(m_containerWidget, 1);
+    setCentralWidget(central);
 
     // Position on right edge of target screen
-    QScreen *screen = getTargetScreen();
+    QScreen *screen = m_targetScreen;
     QRect screenGeom = screen->geometry();
 
     // Apply offset settings
@@ -84,132 +605,612 @@ void MainWindow::setupUi()
 
 void MainWindow::refreshWindows()
 {
-    QList<WindowInfo> windows = fetchAndSortWindows();
-    updateTiles(windows);
-    adjustWindowGeometry();
+    AllocationTracker::beginRefresh();
+
+    const QList<WindowInfo> &windows = fetchAndSortWindows();
+
+    bool changed = false;
+    {
+        AllocationTracker::StageScope scope(AllocationTracker::Stage::UpdateTiles);
+        changed = updateTiles(windows, m_scanner.lastDiff());
+    }
+    if (changed && m_searchEdit->isVisible())
+    {
+        applySearchFilter();
+    }
+    {
+        AllocationTracker::StageScope scope(AllocationTracker::Stage::Layout);
+        adjustWindowGeometry();
+    }
+
+    AllocationTracker::reportRefresh(!changed, WinSelectorConfig::Diagnostics::steadyStateAllocationBudget());
 }
 
-QList<WindowInfo> MainWindow::fetchAndSortWindows()
+QList<WindowInfo> &MainWindow::fetchAndSortWindows()
 {
-    QList<WindowInfo> windows = WindowScanner::getWindows();
+    AllocationTracker::StageScope scanScope(AllocationTracker::Stage::Scan);
+    QList<WindowInfo> &windows = m_scanner.scan();
 
-    // Sort by process name first, then by window title
+    AllocationTracker::StageScope sortScope(AllocationTracker::Stage::Sort);
+
+    const bool byFrecency = WinSelectorConfig::Sort::byFrecency();
+    if (byFrecency)
+    {
+        // Ranks are cached per process record and re-read only after an activation
+        const quint64 revision = m_frecency.revision();
+        for (WindowInfo &info : windows)
+        {
+            if (info.process && info.process->frecencyRevision != revision)
+            {
+                info.process->frecencyRank = m_frecency.rank(info.processName().toCaseFolded());
+                info.process->frecencyRevision = revision;
+            }
+        }
+    }
+
+    // Sort by frecency rank if enabled, then by process name, then by window title
     std::sort(windows.begin(), windows.end(),
-              [](const WindowInfo &a, const WindowInfo &b)
+              [byFrecency](const WindowInfo &a, const WindowInfo &b)
               {
-                  if (a.processName != b.processName)
+                  if (byFrecency && a.process != b.process)
+                  {
+                      const int rankA = a.process ? a.process->frecencyRank : FrecencyRanker::Unranked;
+                      const int rankB = b.process ? b.process->frecencyRank : FrecencyRanker::Unranked;
+                      if (rankA != rankB)
+                      {
+                          return rankA < rankB;
+                      }
+                  }
+                  // Windows of one process share a record, so the name
+                  // comparison is skipped for the common case
+                  if (a.process != b.process && a.processName() != b.processName())
                   {
-                      return a.processName < b.processName;
+                      return a.processName() < b.processName();
                   }
-                  return a.title < b.title;
+                  if (a.title != b.title)
+                  {
+                      return a.title < b.title;
+                  }
+                  // Keep identical entries in a stable order across scans
+                  return a.hwnd < b.hwnd;
               });
 
     return windows;
 }
 
-void MainWindow::updateTiles(const QList<WindowInfo> &windows)
+bool MainWindow::updateTiles(const QList<WindowInfo> &windows, const SnapshotDiff &diff)
 {
-    // Map existing tiles by HWND for reuse
-    QMap<HWND, WindowTile *> existingTiles;
-    QLayoutItem *item;
-    while ((item = m_flowLayout->takeAt(0)))
+    // Tile states are pushed by shell notifications; resynchronize the
+    // foreground window in case one was missed
+    m_windowState.setForeground(reinterpret_cast<quintptr>(Win32Utils::getForegroundWindow()), m_changedStates);
+
+    // Tiles restored from the startup cache are not in the previous snapshot,
+    // so the diff reports none of them as removed or changed
+    const bool reconcile = m_reconcileRestored;
+    if (reconcile)
     {
-        if (WindowTile *tile = qobject_cast<WindowTile *>(item->widget()))
-        {
-            existingTiles.insert(tile->getInfo().hwnd, tile);
-        }
-        else if (item->widget())
+        const std::vector<quintptr> &handles = m_scanner.snapshot().handles();
+        const QList<HWND> restored = m_windowOrder;
+        for (HWND hwnd : restored)
         {
-            // Delete any non-WindowTile widgets (shouldn't happen normally)
-            delete item->widget();
+            if (!std::binary_search(handles.begin(), handles.end(), reinterpret_cast<quintptr>(hwnd)))
+            {
+                removeTile(hwnd);
+            }
         }
-        delete item;
+        m_reconcileRestored = false;
+    }
+
+    // A tile may have been removed by onWindowsClosed() ahead of the scan, and
+    // an activation may have changed the frecency order
+    const bool rankingChanged = std::exchange(m_rankingChanged, false);
+    if (diff.isEmpty() && !rankingChanged && m_windowOrder.size() == windows.size())
+    {
+        // Same windows with the same content, so the sorted order is unchanged
+        // too; only the tile states and the monitor of a window can differ
+        applyChangedStates();
+        return placeTiles(false);
     }
 
-    // Re-populate layout with current windows
-    HWND foregroundHwnd = Win32Utils::getForegroundWindow();
+    // Delete tiles for windows that no longer exist
+    for (quintptr handle : diff.removed)
+    {
+        removeTile(reinterpret_cast<HWND>(handle));
+    }
+
+    bool orderChanged = windows.size() != m_windowOrder.size();
+    bool regrouped = false;
 
-    for (const WindowInfo &info : windows)
+    for (qsizetype i = 0; i < windows.size(); ++i)
     {
-        WindowTile *tile = nullptr;
-        if (existingTiles.contains(info.hwnd))
+        const WindowInfo &info = windows.at(i);
+        const WindowInfo *known = windowInfo(info.hwnd);
+
+        if (!known)
+        {
+            // New window: a tile unless its group is collapsed
+            m_windowState.setMinimized(reinterpret_cast<quintptr>(info.hwnd),
+                                       Win32Utils::isWindowMinimized(info.hwnd), m_changedStates);
+            addWindow(info);
+            if (m_journal)
+            {
+                m_journal->record(ActivityJournal::EventType::Appeared, reinterpret_cast<quintptr>(info.hwnd),
+                                  info.processId, info.title);
+            }
+            m_commandServer->publishAdded(reinterpret_cast<quintptr>(info.hwnd), info.processId,
+                                          info.processName(), info.title);
+        }
+        else if (reconcile)
+        {
+            // First sight of a restored window for the journal
+            if (m_journal)
+            {
+                m_journal->record(ActivityJournal::EventType::Appeared, reinterpret_cast<quintptr>(info.hwnd),
+                                  info.processId, info.title);
+            }
+            if (known->title != info.title)
+            {
+                m_commandServer->publishTitleChanged(reinterpret_cast<quintptr>(info.hwnd), info.title);
+            }
+            regrouped |= updateWindowInfo(info);
+        }
+        else if (std::binary_search(diff.changed.begin(), diff.changed.end(),
+                                    reinterpret_cast<quintptr>(info.hwnd)))
         {
+            if (known->title != info.title)
+            {
+                if (m_journal)
+                {
+                    m_journal->record(ActivityJournal::EventType::TitleChanged,
+                                      reinterpret_cast<quintptr>(info.hwnd), info.processId, info.title);
+                }
+                m_commandServer->publishTitleChanged(reinterpret_cast<quintptr>(info.hwnd), info.title);
+            }
             // Reuse existing tile
-            tile = existingTiles.take(info.hwnd);
-            tile->setInfo(info);
-            tile->setVisible(true);
+            regrouped |= updateWindowInfo(info);
         }
-        else
+
+        if (!orderChanged && m_windowOrder.at(i) != info.hwnd)
         {
-            // Create new tile for new window
-            tile = new WindowTile(info, m_containerWidget);
-            connect(tile, &WindowTile::activated, this, &MainWindow::activateWindow);
-            connect(tile, &WindowTile::closed, this, &MainWindow::closeWindow);
-            connect(tile, &WindowTile::launchRequested, this, &MainWindow::launchProcess);
+            orderChanged = true;
         }
+    }
 
-        // Apply shift+click close setting
-        tile->setEnableShiftClickClose(WinSelectorConfig::WindowTile::enableShiftClickClose());
-        tile->setActive(info.hwnd == foregroundHwnd);
-        m_flowLayout->addWidget(tile);
+    if (orderChanged)
+    {
+        m_windowOrder.clear();
+        for (const WindowInfo &info : windows)
+        {
+            m_windowOrder.append(info.hwnd);
+        }
     }
+    // Groups that grew past or shrank below Grouping/MinWindows
+    const bool tilesChanged = syncGroups() || regrouped;
 
-    // Delete tiles for windows that no longer exist
-    for (WindowTile *tile : existingTiles)
+    applyChangedStates();
+    scheduleSharedTablePublish();
+
+    if (orderChanged || tilesChanged)
     {
-        // Clear icon cache for closed windows
-        Win32Utils::clearIconCache(tile->getInfo().hwnd);
-        delete tile;
+        rebuildTileOrder();
     }
-}
+    placeTiles(orderChanged || tilesChanged);
 
-int MainWindow::layoutHeightForWindowHeight(int windowHeight) const
-{
-    const int nonLayoutHeight = height() - m_containerWidget->height();
-    return qMax(0, windowHeight - nonLayoutHeight);
+    return true;
 }
 
-void MainWindow::adjustWindowGeometry()
+bool MainWindow::placeTiles(bool orderChanged)
 {
-    QScreen *screen = getTargetScreen();
-    QRect availableGeom = screen->availableGeometry();
-
-    // Apply offset settings
-    int topOffset = WinSelectorConfig::MainWindow::topOffset();
-    int bottomOffset = WinSelectorConfig::MainWindow::bottomOffset();
-    int adjustedY = availableGeom.y() + topOffset;
-    int adjustedHeight = availableGeom.height() - topOffset - bottomOffset;
-    int layoutHeight = layoutHeightForWindowHeight(adjustedHeight);
-    int requiredWidth = m_flowLayout->totalWidthForHeight(layoutHeight);
-
-    // Ensure minimum width to avoid tiny window when empty
-    if (requiredWidth < WinSelectorConfig::MainWindow::minimumWidth())
+    // One monitor lookup per window, however many panels there are
+    bool moved = false;
+    if (!m_screenPanels.isEmpty())
     {
-        requiredWidth = WinSelectorConfig::MainWindow::minimumWidth();
+        for (WindowTile *tile : std::as_const(m_orderedTiles))
+        {
+            QWidget *container = containerForWindow(tile->getInfo().hwnd);
+            if (tile->parentWidget() != container)
+            {
+                tile->parentWidget()->layout()->removeWidget(tile);
+                tile->setParent(container);
+                moved = true;
+            }
+        }
+    }
+    if (!orderChanged && !moved)
+    {
+        return false;
     }
 
-    setGeometry(availableGeom.x() + availableGeom.width() - requiredWidth,
-                adjustedY,
-                requiredWidth,
-                adjustedHeight);
-
-    // Force layout update using the actual host widget geometry
-    m_flowLayout->setGeometry(m_containerWidget->contentsRect());
+    // Rebuild the layout order without deleting the tiles themselves
+    clearLayout(m_flowLayout);
+    for (ScreenPanel *panel : std::as_const(m_screenPanels))
+    {
+        clearLayout(panel->flowLayout());
+    }
+    for (WindowTile *tile : std::as_const(m_orderedTiles))
+    {
+        tile->parentWidget()->layout()->addWidget(tile);
+        tile->setVisible(matchesSearch(tile));
+    }
+    return true;
 }
 
-void MainWindow::activateWindow(HWND hwnd)
+QWidget *MainWindow::containerForWindow(HWND hwnd)
 {
-    Win32Utils::activateWindow(hwnd);
+    if (m_screenPanels.isEmpty())
+    {
+        return m_containerWidget;
+    }
+
+    const HMONITOR monitor = Win32Utils::getWindowMonitor(hwnd);
+    QWidget *&container = m_monitorContainers[monitor];
+    if (!container)
+    {
+        // QScreen::name() is the GDI device name on Windows
+        const QString deviceName = Win32Utils::getMonitorDeviceName(monitor);
+        container = m_containerWidget;
+        for (ScreenPanel *panel : std::as_const(m_screenPanels))
+        {
+            if (panel->targetScreen()->name() == deviceName)
+            {
+                container = panel->container();
+                break;
+            }
+        }
+    }
+    return container;
 }
 
-void MainWindow::closeWindow(HWND hwnd)
+void MainWindow::setupScreens(QScreen *removed)
 {
-    Win32Utils::closeWindow(hwnd);
-    // Clear icon cache for this window
+    QList<QScreen *> screens = QGuiApplication::screens();
+    screens.removeOne(removed);
+    m_targetScreen = getTargetScreen(screens);
+    m_monitorContainers.clear();
+
+    // Drop panels whose screen is gone or became the target, or all of them
+    // when the option was turned off
+    const bool perScreen = WinSelectorConfig::Display::panelPerScreen();
+    for (auto it = m_screenPanels.begin(); it != m_screenPanels.end();)
+    {
+        if (perScreen && it.key() != m_targetScreen && screens.contains(it.key()))
+        {
+            ++it;
+            continue;
+        }
+        ScreenPanel *panel = it.value();
+        const QList<WindowTile *> tiles =
+            panel->container()->findChildren<WindowTile *>(Qt::FindDirectChildrenOnly);
+        for (WindowTile *tile : tiles)
+        {
+            panel->flowLayout()->removeWidget(tile);
+            tile->setParent(m_containerWidget);
+        }
+        delete panel;
+        it = m_screenPanels.erase(it);
+    }
+
+    if (!perScreen)
+    {
+        return;
+    }
+    for (QScreen *screen : std::as_const(screens))
+    {
+        if (screen != m_targetScreen && !m_screenPanels.contains(screen))
+        {
+            ScreenPanel *panel = new ScreenPanel(screen, this);
+            m_screenPanels.insert(screen, panel);
+            panel->setVisible(isVisible());
+        }
+    }
+}
+
+void MainWindow::onScreensChanged(QScreen *removed)
+{
+    setupScreens(removed);
+    placeTiles(true);
+    adjustWindowGeometry();
+}
+
+void MainWindow::setVisible(bool visible)
+{
+    if (!visible && m_previewWindow)
+    {
+        hidePreview();
+    }
+    QMainWindow::setVisible(visible);
+    for (ScreenPanel *panel : std::as_const(m_screenPanels))
+    {
+        panel->setVisible(visible);
+    }
+}
+
+bool MainWindow::removeTile(HWND hwnd)
+{
+    WindowTile *tile = m_tiles.take(hwnd);
+    const auto collapsed = m_collapsedWindows.constFind(hwnd);
+    if (!tile && collapsed == m_collapsedWindows.cend())
+    {
+        return false;
+    }
+
+    // A restored window that closed before the first scan never appeared in the journal
+    if (m_journal && !m_reconcileRestored)
+    {
+        m_journal->record(ActivityJournal::EventType::Disappeared, reinterpret_cast<quintptr>(hwnd),
+                          tile ? tile->getInfo().processId : collapsed->processId);
+    }
+    m_commandServer->publishRemoved(reinterpret_cast<quintptr>(hwnd));
+    scheduleSharedTablePublish();
+
+    // Clear icon cache for closed windows
     Win32Utils::clearIconCache(hwnd);
-    // Refresh after a short delay
-    QTimer::singleShot(WinSelectorConfig::MainWindow::closeRefreshDelayMs(),
-                       this, &MainWindow::refreshWindows);
+    m_thumbnails->forget(reinterpret_cast<quintptr>(hwnd));
+    if (hwnd == m_previewWindow)
+    {
+        hidePreview();
+    }
+    m_windowState.forget(reinterpret_cast<quintptr>(hwnd));
+    m_searchIndex.remove(reinterpret_cast<quintptr>(hwnd));
+    m_groups.remove(reinterpret_cast<quintptr>(hwnd));
+    m_windowOrder.removeOne(hwnd);
+    m_selection.removeOne(hwnd);
+    if (tile)
+    {
+        discardTile(tile);
+    }
+    else
+    {
+        m_collapsedWindows.erase(collapsed);
+    }
+    return true;
+}
+
+void MainWindow::adjustWindowGeometry()
+{
+    setGeometry(ScreenPanel::panelGeometry(m_targetScreen, m_flowLayout, height() - m_containerWidget->height()));
+
+    // Force layout update using the actual host widget geometry
+    m_flowLayout->setGeometry(m_containerWidget->contentsRect());
+
+    for (ScreenPanel *panel : std::as_const(m_screenPanels))
+    {
+        panel->adjustGeometry();
+    }
+}
+
+void MainWindow::activateWindow(HWND hwnd)
+{
+    m_activationService.activate(hwnd);
+}
+
+void MainWindow::onActivationFinished(HWND hwnd, bool success)
+{
+    if (!success)
+    {
+        return;
+    }
+    if (m_shellHookMessage == 0)
+    {
+        // Otherwise counted from the shell's activation notification
+        recordActivation(hwnd);
+    }
+    m_windowState.setForeground(reinterpret_cast<quintptr>(hwnd), m_changedStates);
+    applyChangedStates();
+}
+
+void MainWindow::closeWindow(HWND hwnd)
+{
+    if (Win32Utils::closeWindow(hwnd))
+    {
+        m_closeWatcher.watch(hwnd, WinSelectorConfig::MainWindow::closeRefreshDelayMs());
+    }
+}
+
+void MainWindow::onWindowsClosed(const QList<HWND> &windows)
+{
+    bool removed = false;
+    for (HWND hwnd : windows)
+    {
+        removed |= removeTile(hwnd);
+    }
+    if (!removed)
+    {
+        return;
+    }
+    if (syncGroups())
+    {
+        rebuildTileOrder();
+        placeTiles(true);
+    }
+    adjustWindowGeometry();
+}
+
+void MainWindow::toggleSelection(HWND hwnd)
+{
+    WindowTile *tile = m_tiles.value(hwnd);
+    if (!tile)
+    {
+        return;
+    }
+    const bool selected = !tile->isSelected();
+    tile->setSelected(selected);
+    if (selected)
+    {
+        m_selection.append(hwnd);
+    }
+    else
+    {
+        m_selection.removeOne(hwnd);
+    }
+}
+
+void MainWindow::clearSelection()
+{
+    for (HWND hwnd : std::as_const(m_selection))
+    {
+        if (WindowTile *tile = m_tiles.value(hwnd))
+        {
+            tile->setSelected(false);
+        }
+    }
+    m_selection.clear();
+}
+
+void MainWindow::onTileAction(HWND hwnd, WindowTile::Action action)
+{
+    QList<HWND> windows;
+    if (action == WindowTile::Action::MinimizeOthers)
+    {
+        for (HWND other : std::as_const(m_windowOrder))
+        {
+            if (other != hwnd &&
+                !(m_windowState.flags(reinterpret_cast<quintptr>(other)) & ShellWindowState::Minimized))
+            {
+                windows.append(other);
+            }
+        }
+    }
+    else if (m_selection.contains(hwnd))
+    {
+        windows = m_selection;
+    }
+    else
+    {
+        windows.append(hwnd);
+    }
+    applyBatch(windows, action);
+}
+
+void MainWindow::onGroupAction(const QString &processName, WindowTile::Action action)
+{
+    const WindowGroups::Group *group = m_groups.find(processName);
+    if (!group)
+    {
+        return;
+    }
+    QList<HWND> windows;
+    windows.reserve(group->count());
+    for (quintptr handle : group->members)
+    {
+        windows.append(reinterpret_cast<HWND>(handle));
+    }
+    applyBatch(windows, action);
+}
+
+void MainWindow::applyBatch(const QList<HWND> &windows, WindowTile::Action action)
+{
+    if (action == WindowTile::Action::Close)
+    {
+        // One watch for all of them; the tiles go in one pass as the windows disappear
+        m_closeWatcher.watch(Win32Utils::closeWindows(windows), WinSelectorConfig::MainWindow::closeRefreshDelayMs());
+    }
+    else
+    {
+        const Win32Utils::ShowCommand command = action == WindowTile::Action::Restore
+                                                    ? Win32Utils::ShowCommand::Restore
+                                                    : Win32Utils::ShowCommand::Minimize;
+        Win32Utils::showWindows(windows, command);
+        // Shell notifications are not sent for every window of a batch;
+        // the states are read back together once they settled
+        for (HWND hwnd : windows)
+        {
+            queueMinimizeCheck(hwnd);
+        }
+    }
+    clearSelection();
+}
+
+void MainWindow::queueMinimizeCheck(HWND hwnd)
+{
+    m_minimizeChecks.insert(hwnd);
+    if (!m_minimizeTimer->isActive())
+    {
+        m_minimizeTimer->start(MinimizeSettleMs);
+    }
+}
+
+void MainWindow::checkMinimized()
+{
+    for (HWND hwnd : std::as_const(m_minimizeChecks))
+    {
+        m_windowState.setMinimized(reinterpret_cast<quintptr>(hwnd), Win32Utils::isWindowMinimized(hwnd),
+                                   m_changedStates);
+    }
+    m_minimizeChecks.clear();
+    applyChangedStates();
+}
+
+void MainWindow::onTileHovered(HWND hwnd, bool hovered)
+{
+    if (!hovered)
+    {
+        if (hwnd == m_previewWindow)
+        {
+            hidePreview();
+        }
+        return;
+    }
+    if (!WinSelectorConfig::Thumbnail::enabled())
+    {
+        return;
+    }
+
+    // Capture during the hover delay so the image is usually ready when it ends
+    m_previewWindow = hwnd;
+    m_thumbnails->request(reinterpret_cast<quintptr>(hwnd), WinSelectorConfig::Thumbnail::maxAgeMs());
+    m_previewTimer->start(WinSelectorConfig::Thumbnail::hoverDelayMs());
+}
+
+void MainWindow::showPreview()
+{
+    WindowTile *tile = m_tiles.value(m_previewWindow);
+    if (!tile)
+    {
+        return;
+    }
+    // A stale thumbnail is shown until the new capture replaces it
+    const QImage image = m_thumbnails->thumbnail(reinterpret_cast<quintptr>(m_previewWindow));
+    if (image.isNull())
+    {
+        return;
+    }
+
+    if (!m_preview)
+    {
+        m_preview = new QLabel(this, Qt::ToolTip | Qt::FramelessWindowHint);
+        m_preview->setAttribute(Qt::WA_ShowWithoutActivating);
+        m_preview->setAttribute(Qt::WA_TransparentForMouseEvents);
+    }
+    m_preview->setPixmap(QPixmap::fromImage(image));
+    m_preview->adjustSize();
+
+    // Left of the tile, since panels sit at the right edge, and within its screen
+    const QRect area = tile->screen()->availableGeometry();
+    QPoint position = tile->mapToGlobal(QPoint(-m_preview->width() - PreviewGap, 0));
+    position.setX(qMax(area.left(), position.x()));
+    position.setY(qBound(area.top(), position.y(), area.bottom() - m_preview->height()));
+    m_preview->move(position);
+    m_preview->show();
+}
+
+void MainWindow::hidePreview()
+{
+    m_previewTimer->stop();
+    m_previewWindow = nullptr;
+    if (m_preview)
+    {
+        m_preview->hide();
+    }
+}
+
+void MainWindow::onThumbnailReady(quintptr handle)
+{
+    // While the hover delay runs, showPreview() picks the image up when it ends
+    if (handle == reinterpret_cast<quintptr>(m_previewWindow) && !m_previewTimer->isActive())
+    {
+        showPreview();
+    }
 }
 
 void MainWindow::launchProcess(const QString &processPath)
@@ -260,13 +1261,396 @@ bool MainWindow::nativeEvent(const QByteArray &eventType, void *message, qintptr
             return true;
         }
     }
+    else if (m_shellHookMessage != 0 && msg->message == m_shellHookMessage)
+    {
+        handleShellHook(msg->wParam, msg->lParam);
+        return true;
+    }
     return QMainWindow::nativeEvent(eventType, message, result);
 }
 
+void MainWindow::handleShellHook(WPARAM code, LPARAM lParam)
+{
+    const HWND hwnd = Win32Utils::shellHookWindow(code, lParam);
+    ShellHook::Event event = ShellHook::decode(static_cast<quint32>(code), reinterpret_cast<quintptr>(hwnd));
+    if (event.type == ShellHook::EventType::None)
+    {
+        return;
+    }
+
+    if (event.type == ShellHook::EventType::MinimizeChanged)
+    {
+        // Sent before the window changes state; read the result once it settled
+        queueMinimizeCheck(hwnd);
+        return;
+    }
+
+    if (event.type == ShellHook::EventType::Activated)
+    {
+        recordActivation(hwnd);
+        if (m_journal)
+        {
+            const WindowInfo *info = windowInfo(hwnd);
+            m_journal->record(ActivityJournal::EventType::Activated, reinterpret_cast<quintptr>(hwnd),
+                              info ? info->processId : 0);
+        }
+    }
+    m_windowState.apply(event, m_changedStates);
+    applyChangedStates();
+
+    if (event.type == ShellHook::EventType::Destroyed)
+    {
+        // Drop the tile and its group membership now instead of at the next scan
+        onWindowsClosed({hwnd});
+    }
+}
+
+QByteArray MainWindow::handleCommand(const QString &command, const QString &argument)
+{
+    if (command == QLatin1String("ping"))
+    {
+        return CommandServer::okReply();
+    }
+
+    if (command == QLatin1String("show"))
+    {
+        if (!isVisible())
+        {
+            toggleVisibility();
+        }
+        else
+        {
+            raise();
+        }
+        return CommandServer::okReply();
+    }
+
+    if (command == QLatin1String("list"))
+    {
+        // "notepad" matches notepad.exe
+        QString process = argument;
+        if (!process.isEmpty() && !process.endsWith(QLatin1String(".exe"), Qt::CaseInsensitive))
+        {
+            process += QLatin1String(".exe");
+        }
+
+        QStringList lines;
+        for (HWND hwnd : std::as_const(m_windowOrder))
+        {
+            const WindowInfo &info = *windowInfo(hwnd);
+            if (!process.isEmpty() && info.processName().compare(process, Qt::CaseInsensitive) != 0)
+            {
+                continue;
+            }
+            // Tab-separated: handle, process ID, process name, title
+            QString title = info.title;
+            title.replace('\t', ' ').replace('\n', ' ').replace('\r', ' ');
+            lines.append(QString("0x%1\t%2\t%3\t%4")
+                             .arg(QString::number(reinterpret_cast<quintptr>(info.hwnd), 16))
+                             .arg(info.processId)
+                             .arg(info.processName(), title));
+        }
+        return CommandServer::okReply(lines);
+    }
+
+    if (command == QLatin1String("subscribe"))
+    {
+        // Snapshot in stream format; the CommandServer pushes changes from here on
+        ChangeQueue snapshot;
+        for (HWND hwnd : std::as_const(m_windowOrder))
+        {
+            const WindowInfo &info = *windowInfo(hwnd);
+            snapshot.added(reinterpret_cast<quintptr>(info.hwnd), info.processId, info.processName(), info.title);
+        }
+        snapshot.foregroundChanged(m_windowState.foreground());
+        return "OK\n" + snapshot.take();
+    }
+
+    if (command == QLatin1String("activate"))
+    {
+        const QRegularExpression pattern(argument, QRegularExpression::CaseInsensitiveOption);
+        if (argument.isEmpty() || !pattern.isValid())
+        {
+            return CommandServer::errorReply("invalid title pattern");
+        }
+        // First match in panel order
+        for (HWND hwnd : std::as_const(m_windowOrder))
+        {
+            const WindowInfo &info = *windowInfo(hwnd);
+            if (pattern.match(info.title).hasMatch())
+            {
+                activateWindow(info.hwnd);
+                return CommandServer::okReply({"0x" + QString::number(reinterpret_cast<quintptr>(info.hwnd), 16)});
+            }
+        }
+        return CommandServer::errorReply("no matching window");
+    }
+
+    return CommandServer::errorReply("unknown command: " + command);
+}
+
+void MainWindow::setupJournal()
+{
+    if (!WinSelectorConfig::Journal::enabled())
+    {
+        if (m_journal)
+        {
+            m_journalTimer->stop();
+            delete m_journal; // Flushes the remaining records
+            m_journal = nullptr;
+        }
+        return;
+    }
+
+    if (!m_journal)
+    {
+        m_journal = new ActivityJournal(JournalFileName);
+        // Also repairs a record truncated by a crash before anything is appended
+        m_journal->compact(WinSelectorConfig::Journal::retentionHours() * 3600LL * 1000,
+                           WinSelectorConfig::Journal::maxFileSizeKB() * 1024LL);
+    }
+
+    if (!m_journalTimer)
+    {
+        m_journalTimer = new QTimer(this);
+        connect(m_journalTimer, &QTimer::timeout, this, &MainWindow::flushJournal);
+    }
+    m_journalTimer->start(WinSelectorConfig::Journal::flushIntervalMs());
+}
+
+void MainWindow::setupSharedTable()
+{
+    if (!WinSelectorConfig::SharedTable::enabled())
+    {
+        delete m_sharedTable;
+        m_sharedTable = nullptr;
+        return;
+    }
+    if (m_sharedTable)
+    {
+        return;
+    }
+
+    m_sharedTable = new SharedWindowTable;
+    if (!m_sharedTable->create())
+    {
+        delete m_sharedTable;
+        m_sharedTable = nullptr;
+        return;
+    }
+    scheduleSharedTablePublish();
+}
+
+void MainWindow::onSettingsChanged(quint32 changes)
+{
+    if (changes & Settings::RefreshInterval)
+    {
+        m_refreshTimer->setInterval(WinSelectorConfig::MainWindow::refreshIntervalMs());
+    }
+    if (changes & Settings::IconRefreshInterval)
+    {
+        m_iconRefreshTimer->setInterval(WinSelectorConfig::MainWindow::iconRefreshIntervalMs());
+    }
+    if (changes & Settings::Shortcut)
+    {
+        Win32Utils::unregisterHotKey((HWND)winId(), 1);
+        Win32Utils::registerHotKey((HWND)winId(), 1, 0, Settings::instance().getToggleVisibilityKeyVk());
+    }
+    if (changes & Settings::Journal)
+    {
+        setupJournal();
+    }
+    if (changes & Settings::SharedTable)
+    {
+        setupSharedTable();
+    }
+
+    if (changes & Settings::TileBehavior)
+    {
+        const bool enableShiftClickClose = WinSelectorConfig::WindowTile::enableShiftClickClose();
+        for (WindowTile *tile : std::as_const(m_orderedTiles))
+        {
+            tile->setEnableShiftClickClose(enableShiftClickClose);
+        }
+    }
+    if (changes & Settings::TileGeometry)
+    {
+        for (WindowTile *tile : std::as_const(m_orderedTiles))
+        {
+            tile->applySettings();
+        }
+    }
+    if (changes & Settings::Layout)
+    {
+        const int margin = WinSelectorConfig::Layout::margin();
+        m_flowLayout->setContentsMargins(margin, margin, margin, margin);
+        m_flowLayout->setSpacings(WinSelectorConfig::Layout::hSpacing(), WinSelectorConfig::Layout::vSpacing());
+        for (ScreenPanel *panel : std::as_const(m_screenPanels))
+        {
+            panel->flowLayout()->setContentsMargins(margin, margin, margin, margin);
+            panel->flowLayout()->setSpacings(WinSelectorConfig::Layout::hSpacing(),
+                                             WinSelectorConfig::Layout::vSpacing());
+        }
+    }
+    if (changes & Settings::Thumbnail)
+    {
+        m_thumbnails->setCacheBytes(qsizetype(WinSelectorConfig::Thumbnail::cacheSizeKB()) * 1024);
+        if (!WinSelectorConfig::Thumbnail::enabled())
+        {
+            hidePreview();
+        }
+    }
+    if (changes & Settings::PanelGeometry)
+    {
+        // Target display or per-screen option; tiles follow at once
+        setupScreens();
+        placeTiles(true);
+    }
+    if (changes & Settings::Grouping)
+    {
+        m_groups.setMinimumSize(groupingMinimumSize());
+        if (syncGroups())
+        {
+            rebuildTileOrder();
+            placeTiles(true);
+        }
+        if (m_searchEdit->isVisible())
+        {
+            applySearchFilter();
+        }
+    }
+
+    bool rescan = false;
+    if (changes & Settings::Filter)
+    {
+        m_scanner.reloadFilter();
+        rescan = true;
+    }
+    if (changes & Settings::Sort)
+    {
+        // The half-life is fixed when the scores are created; it applies from the next start
+        if (WinSelectorConfig::Sort::byFrecency() && !m_frecencyLoaded)
+        {
+            m_frecency.load(FrecencyFileName);
+            m_frecencyLoaded = true;
+        }
+        m_rankingChanged = true;
+        rescan = true;
+    }
+
+    // Either way the panel is laid out once, however many values changed
+    if (rescan)
+    {
+        refreshWindows();
+    }
+    else if (changes & (Settings::PanelGeometry | Settings::Layout | Settings::TileGeometry | Settings::Grouping))
+    {
+        adjustWindowGeometry();
+    }
+}
+
+void MainWindow::flushJournal()
+{
+    if (!m_journal->flush())
+    {
+        qWarning() << "Failed to write" << JournalFileName;
+    }
+    const qint64 maxBytes = WinSelectorConfig::Journal::maxFileSizeKB() * 1024LL;
+    if (m_journal->fileSize() > maxBytes)
+    {
+        m_journal->compact(WinSelectorConfig::Journal::retentionHours() * 3600LL * 1000, maxBytes);
+    }
+}
+
+void MainWindow::recordActivation(HWND hwnd)
+{
+    if (!WinSelectorConfig::Sort::byFrecency())
+    {
+        return;
+    }
+    // Only listed windows count; the panel itself and unlisted windows do not
+    const WindowInfo *info = windowInfo(hwnd);
+    if (!info || info->processName().isEmpty())
+    {
+        return;
+    }
+    m_frecencyDirty = true;
+    // An activation that leaves the application order alone needs no re-sort
+    if (m_frecency.recordActivation(info->processName().toCaseFolded(), QDateTime::currentSecsSinceEpoch()))
+    {
+        m_rankingChanged = true;
+    }
+}
+
+void MainWindow::applyChangedStates()
+{
+    if (!m_changedStates.empty())
+    {
+        scheduleSharedTablePublish();
+    }
+    for (quintptr handle : m_changedStates)
+    {
+        m_groups.setFlags(handle, m_windowState.flags(handle));
+        if (WindowTile *tile = m_tiles.value(reinterpret_cast<HWND>(handle)))
+        {
+            applyWindowState(tile);
+        }
+    }
+    if (!m_changedStates.empty() && syncGroups())
+    {
+        // Only restyles group tiles, unless a group changed size meanwhile
+        rebuildTileOrder();
+        placeTiles(true);
+        adjustWindowGeometry();
+    }
+    m_changedStates.clear();
+
+    const quintptr foreground = m_windowState.foreground();
+    if (foreground != m_publishedForeground)
+    {
+        m_publishedForeground = foreground;
+        m_commandServer->publishForeground(foreground);
+    }
+}
+
+void MainWindow::scheduleSharedTablePublish()
+{
+    // Tile changes, removals and state changes of one refresh share one publication
+    if (!m_sharedTable || m_sharedTablePending)
+    {
+        return;
+    }
+    m_sharedTablePending = true;
+    QTimer::singleShot(0, this, &MainWindow::publishSharedTable);
+}
+
+void MainWindow::publishSharedTable()
+{
+    m_sharedTablePending = false;
+    m_sharedTable->beginPublish();
+    for (HWND hwnd : std::as_const(m_windowOrder))
+    {
+        const WindowInfo &info = *windowInfo(hwnd);
+        const quintptr handle = reinterpret_cast<quintptr>(hwnd);
+        m_sharedTable->append(handle, info.processId, m_windowState.flags(handle), info.processName(), info.title);
+    }
+    m_sharedTable->endPublish(m_windowState.foreground(), QDateTime::currentMSecsSinceEpoch());
+}
+
+void MainWindow::applyWindowState(WindowTile *tile)
+{
+    const quint8 flags = m_windowState.flags(reinterpret_cast<quintptr>(tile->getInfo().hwnd));
+    tile->setActive(flags & ShellWindowState::Active);
+    tile->setFlashing(flags & ShellWindowState::Flashing);
+    tile->setMinimized(flags & ShellWindowState::Minimized);
+}
+
 void MainWindow::toggleVisibility()
 {
     if (isVisible())
     {
+        closeSearch();
+        clearSelection();
         hide();
     }
     else
@@ -274,12 +1658,128 @@ void MainWindow::toggleVisibility()
         show();
         raise();
         Win32Utils::activateWindow((HWND)winId());
+        if (WinSelectorConfig::Search::openOnHotkey())
+        {
+            openSearch();
+        }
+    }
+}
+
+void MainWindow::openSearch()
+{
+    m_searchEdit->clear();
+    m_searchEdit->show();
+    centralWidget()->layout()->activate();
+    adjustWindowGeometry();
+    m_searchEdit->setFocus();
+}
+
+void MainWindow::closeSearch()
+{
+    if (m_searchEdit->isHidden())
+    {
+        return;
+    }
+    m_searchEdit->hide();
+    // Shows every tile again through applySearchFilter()
+    m_searchEdit->clear();
+    centralWidget()->layout()->activate();
+    adjustWindowGeometry();
+}
+
+void MainWindow::applySearchFilter()
+{
+    const QString query = m_searchEdit->text();
+    m_searchFiltering = m_searchEdit->isVisible() && !query.isEmpty();
+
+    m_searchScores.clear();
+    if (m_searchFiltering)
+    {
+        for (const WindowSearchIndex::Match &match : m_searchIndex.search(query))
+        {
+            m_searchScores.insert(reinterpret_cast<HWND>(match.handle), match.score);
+        }
+    }
+
+    // Only touch tiles whose visibility actually changes
+    for (WindowTile *tile : std::as_const(m_orderedTiles))
+    {
+        const bool visible = matchesSearch(tile);
+        if (tile->isHidden() == visible)
+        {
+            tile->setVisible(visible);
+        }
+    }
+    adjustWindowGeometry();
+}
+
+bool MainWindow::matchesSearch(const WindowTile *tile) const
+{
+    if (!m_searchFiltering)
+    {
+        return true;
+    }
+    // A group tile stays visible while any of its windows matches
+    if (tile->isGroupHeader())
+    {
+        const WindowGroups::Group *group = m_groups.find(tile->getInfo().processName());
+        return group && std::any_of(group->members.cbegin(), group->members.cend(), [this](quintptr handle)
+                                    { return m_searchScores.contains(reinterpret_cast<HWND>(handle)); });
+    }
+    return m_searchScores.contains(tile->getInfo().hwnd);
+}
+
+void MainWindow::activateBestMatch()
+{
+    // Highest score wins; ties go to the window listed first, also inside a
+    // collapsed group
+    HWND best = nullptr;
+    int bestScore = 0;
+    for (HWND hwnd : std::as_const(m_windowOrder))
+    {
+        const int score = m_searchScores.value(hwnd, 0);
+        if (score > bestScore)
+        {
+            best = hwnd;
+            bestScore = score;
+        }
+    }
+
+    if (best)
+    {
+        closeSearch();
+        activateWindow(best);
+    }
+}
+
+bool MainWindow::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_searchEdit && event->type() == QEvent::KeyPress &&
+        static_cast<QKeyEvent *>(event)->key() == Qt::Key_Escape)
+    {
+        closeSearch();
+        return true;
+    }
+    if (watched == m_containerWidget && event->type() == QEvent::Paint && !m_startupFinished)
+    {
+        // Let this paint reach the screen before the deferred work starts
+        QTimer::singleShot(0, this, &MainWindow::finishStartup);
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+void MainWindow::changeEvent(QEvent *event)
+{
+    if (event->type() == QEvent::LanguageChange)
+    {
+        ui->retranslateUi(this);
+        m_searchEdit->setPlaceholderText(tr("Search windows"));
     }
+    QMainWindow::changeEvent(event);
 }
 
-QScreen* MainWindow::getTargetScreen()
+QScreen* MainWindow::getTargetScreen(const QList<QScreen*> &screens)
 {
-    QList<QScreen*> screens = QGuiApplication::screens();
     int targetIndex = WinSelectorConfig::Display::targetDisplayIndex();
     
     // Return the target screen if the index is valid
@@ -288,6 +1788,8 @@ QScreen* MainWindow::getTargetScreen()
         return screens[targetIndex];
     }
     
-    // Fallback to primary screen if index is out of range
-    return QGuiApplication::primaryScreen();
+    // Fallback to primary screen if index is out of range (or to the first
+    // remaining one while the primary screen is being removed)
+    QScreen *primary = QGuiApplication::primaryScreen();
+    return screens.contains(primary) || screens.isEmpty() ? primary : screens.first();
 }
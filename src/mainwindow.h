@@ -1,12 +1,29 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include "activationservice.h"
+#include "activityjournal.h"
+#include "closewatcher.h"
+#include "frecencyranker.h"
+#include "shellhookstate.h"
+#include "windowgroups.h"
+#include "windowtile.h"
+#include "windowsearchindex.h"
 #include "windowscanner.h"
+#include <QHash>
+#include <QSet>
 #include <QMainWindow>
 #include <QTimer>
 #include <QSystemTrayIcon>
 
+class CommandServer;
+class SharedWindowTable;
 class FlowLayout;
+class QLineEdit;
+class QTranslator;
+class ScreenPanel;
+class ThumbnailService;
+class QLabel;
 
 QT_BEGIN_NAMESPACE
 namespace Ui
@@ -36,26 +53,232 @@ public:
      */
     ~MainWindow();
 
+    /**
+     * @brief Show or hide the panel together with the per-screen panels
+     * @param visible true to show
+     */
+    void setVisible(bool visible) override;
+
 protected:
     /**
      * @brief Handle native window events (for global hotkeys)
      */
     bool nativeEvent(const QByteArray &eventType, void *message, qintptr *result) override;
 
+    /**
+     * @brief Close the search box on Escape
+     */
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+    /**
+     * @brief Retranslate the texts set in code once the translator is installed
+     */
+    void changeEvent(QEvent *event) override;
+
 private:
     Ui::MainWindow *ui;
     FlowLayout *m_flowLayout;
     QTimer *m_refreshTimer;
     QTimer *m_iconRefreshTimer;
     QWidget *m_containerWidget;
+    WindowScanner m_scanner;
+    CloseWatcher m_closeWatcher;
+    ActivationService m_activationService;
+
+    // Foreground / attention / minimized state pushed by shell hook notifications
+    static constexpr int MinimizeSettleMs = 100;
+    UINT m_shellHookMessage = 0;
+    ShellWindowState m_windowState;
+    std::vector<quintptr> m_changedStates;
+    QTimer *m_minimizeTimer;
+    QSet<HWND> m_minimizeChecks;
+
+    // Windows selected with Ctrl+click for the batch operations, in selection order
+    QList<HWND> m_selection;
+
+    // Optional most-used-first ordering (Sort/Mode=Frecency)
+    FrecencyRanker m_frecency;
+    bool m_frecencyLoaded = false;  ///< Scores were read from Frecency.dat
+    bool m_frecencyDirty = false;   ///< Not yet saved
+    bool m_rankingChanged = false;  ///< Tiles may need reordering at the next refresh
+
+    // Command channel for scripts; also keeps this the only instance and
+    // streams window changes to subscribers
+    CommandServer *m_commandServer;
+    quintptr m_publishedForeground = 0;
+
+    // Window list in shared memory (SharedTable/Enabled); null when disabled
+    SharedWindowTable *m_sharedTable = nullptr;
+    bool m_sharedTablePending = false;
+
+    // Window activity journal (Journal/Enabled); null when disabled
+    ActivityJournal *m_journal = nullptr;
+    QTimer *m_journalTimer = nullptr;
+
+    // Type-to-filter search; the index follows tile creation, updates and removal
+    QLineEdit *m_searchEdit;
+    WindowSearchIndex m_searchIndex;
+    QHash<HWND, int> m_searchScores;
+    bool m_searchFiltering = false;  ///< m_searchScores decides which tiles are shown
+
+    // All listed windows in display order. Windows inside a collapsed process
+    // group (Grouping/*) keep only their info; the others have a tile
+    QList<HWND> m_windowOrder;
+    QHash<HWND, WindowInfo> m_collapsedWindows;
+    WindowGroups m_groups;
+    QHash<QString, WindowTile *> m_groupTiles;
+
+    // Tiles kept across refreshes, by window, and all tiles including the
+    // group tiles in layout order
+    QHash<HWND, WindowTile *> m_tiles;
+    QList<WindowTile *> m_orderedTiles;
+
+    // One panel per additional screen (Display/PanelPerScreen), all fed from the
+    // same scan; windows on the target screen stay in this window. Monitor
+    // handles are resolved to tile containers once, until the screens change
+    QScreen *m_targetScreen = nullptr;
+    QHash<QScreen *, ScreenPanel *> m_screenPanels;
+    QHash<HMONITOR, QWidget *> m_monitorContainers;
+
+    // Hover previews (Thumbnail/*); captured on the service's worker threads,
+    // only ever on hover and never from refreshWindows()
+    ThumbnailService *m_thumbnails;
+    QTimer *m_previewTimer;
+    QLabel *m_preview = nullptr; ///< Created on first use
+    HWND m_previewWindow = nullptr;
+
+    // Startup: tiles restored from Startup.dat until the first scan reconciles them;
+    // the rest of the initialization runs after the first paint
+    bool m_reconcileRestored = false;
+    bool m_startupFinished = false;
+    QTranslator *m_translator = nullptr;
 
     void setupUi();
 
+    /**
+     * @brief Create the tiles saved at the last exit whose windows still exist
+     *
+     * Stops when Startup/FirstPaintBudgetMs is used up; the first scan adds the rest.
+     * @return true if any tile was created
+     */
+    bool restoreSnapshot();
+
+    /**
+     * @brief Save the current tiles for the next start (Startup/UseSnapshot)
+     */
+    void saveSnapshot();
+
+    /**
+     * @brief Run the initialization deferred until after the first paint
+     *
+     * Reconciles restored tiles with a full scan, then installs the translation,
+     * tray icon, journal, shared table, default settings and settings watcher.
+     */
+    void finishStartup();
+
+    /**
+     * @brief Install the translation matching the system UI languages
+     */
+    void loadTranslation();
+
+    /**
+     * @brief Create a tile and connect it; the caller adds it to the layout
+     * @param info Window shown by the tile
+     * @return New tile
+     */
+    WindowTile *createTile(const WindowInfo &info);
+
+    /**
+     * @brief Take in a new window: a tile, or only its info if its group is collapsed
+     *
+     * The caller sets the window's minimized state first and appends it to m_windowOrder.
+     * @param info New window
+     */
+    void addWindow(const WindowInfo &info);
+
+    /**
+     * @brief Get the info of a listed window, with or without a tile
+     * @param hwnd Window handle
+     * @return Info, or nullptr if the window is not listed
+     */
+    const WindowInfo *windowInfo(HWND hwnd) const;
+
+    /**
+     * @brief Store new info of a listed window on its tile or in m_collapsedWindows
+     *
+     * Moves the window to another group if its process name changed.
+     * @param info Window information
+     * @return true if the window got or lost its tile because it changed groups
+     */
+    bool updateWindowInfo(const WindowInfo &info);
+
+    /**
+     * @brief Bring the group tiles and collapsed windows in line with the changed groups
+     *
+     * Creates, updates and deletes group tiles and creates or deletes the tiles of
+     * windows whose group was collapsed or expanded. Only groups reported by
+     * WindowGroups::takeDirty() are visited.
+     * @return true if tiles were created or deleted, so m_orderedTiles must be rebuilt
+     */
+    bool syncGroups();
+
+    /**
+     * @brief Create or delete the tile of a listed window
+     * @param hwnd Window handle
+     * @param materialized true if the window needs a tile
+     * @return true if a tile was created or deleted
+     */
+    bool setTileMaterialized(HWND hwnd, bool materialized);
+
+    /**
+     * @brief Take a tile out of its layout and delete it
+     * @param tile Window or group tile
+     */
+    void discardTile(WindowTile *tile);
+
+    /**
+     * @brief Rebuild m_orderedTiles from m_windowOrder, each group tile before its windows
+     */
+    void rebuildTileOrder();
+
+    /**
+     * @brief Expand or collapse the group of a clicked group tile
+     * @param processName Process name of the group
+     */
+    void onGroupToggled(const QString &processName);
+
     /**
      * @brief Toggle the visibility of the window tiles
      */
     void toggleVisibility();
 
+    /**
+     * @brief Show the search box and give it keyboard focus
+     */
+    void openSearch();
+
+    /**
+     * @brief Hide the search box and show all tiles again
+     */
+    void closeSearch();
+
+    /**
+     * @brief Show only the tiles matching the search text
+     */
+    void applySearchFilter();
+
+    /**
+     * @brief Check whether a tile is shown under the current search
+     * @param tile Window or group tile
+     * @return true if no search is active, the window matches, or any window of the group matches
+     */
+    bool matchesSearch(const WindowTile *tile) const;
+
+    /**
+     * @brief Activate the best-scoring visible tile and close the search
+     */
+    void activateBestMatch();
+
     /**
      * @brief Refresh the list of open windows
      */
@@ -63,16 +286,185 @@ private:
 
     /**
      * @brief Activate a specific window
+     *
+     * The request runs asynchronously on the ActivationService.
      * @param hwnd Handle of the window to activate
      */
     void activateWindow(HWND hwnd);
 
+    /**
+     * @brief Move the foreground highlight once an activation succeeded
+     * @param hwnd Handle of the activated window
+     * @param success true if the window came to the foreground
+     */
+    void onActivationFinished(HWND hwnd, bool success);
+
     /**
      * @brief Close a specific window
+     *
+     * The window is watched until it is gone and its tile is then removed
+     * directly; no full refresh is scheduled.
      * @param hwnd Handle of the window to close
      */
     void closeWindow(HWND hwnd);
 
+    /**
+     * @brief Remove the tiles of windows that were closed, with one layout pass
+     * @param windows Handles of the closed windows
+     */
+    void onWindowsClosed(const QList<HWND> &windows);
+
+    /**
+     * @brief Add a window to the multi-selection or remove it (Ctrl+click)
+     * @param hwnd Window handle
+     */
+    void toggleSelection(HWND hwnd);
+
+    /**
+     * @brief Empty the multi-selection
+     */
+    void clearSelection();
+
+    /**
+     * @brief Apply a context menu operation of a window tile
+     *
+     * Targets the selection if the window is selected, otherwise the window alone;
+     * MinimizeOthers targets every other listed window that is not minimized.
+     * @param hwnd Window of the tile
+     * @param action Operation to apply
+     */
+    void onTileAction(HWND hwnd, WindowTile::Action action);
+
+    /**
+     * @brief Apply a context menu operation of a group tile to every window of the group
+     * @param processName Process name of the group
+     * @param action Operation to apply
+     */
+    void onGroupAction(const QString &processName, WindowTile::Action action);
+
+    /**
+     * @brief Submit an operation for several windows at once
+     *
+     * All native calls are posted in one pass. Closed windows are removed together
+     * by onWindowsClosed(); minimize state changes are read back in one pass by
+     * checkMinimized(). Neither scans the windows. Clears the selection.
+     * @param windows Target windows
+     * @param action Operation to apply
+     */
+    void applyBatch(const QList<HWND> &windows, WindowTile::Action action);
+
+    /**
+     * @brief Read the minimized state of a window once it settled
+     *
+     * Requests are collected and read together MinimizeSettleMs after the first one.
+     * @param hwnd Window handle
+     */
+    void queueMinimizeCheck(HWND hwnd);
+
+    /**
+     * @brief Read the minimized state of the queued windows and restyle their tiles
+     */
+    void checkMinimized();
+
+    /**
+     * @brief Handle a shell hook notification
+     * @param code Notification code (wParam)
+     * @param lParam Notification argument
+     */
+    void handleShellHook(WPARAM code, LPARAM lParam);
+
+    /**
+     * @brief Count an activation of a listed window towards the frecency order
+     * @param hwnd Handle of the activated window
+     */
+    void recordActivation(HWND hwnd);
+
+    /**
+     * @brief Answer a command received by the CommandServer
+     *
+     * Answered from the current tiles; never scans.
+     * @param command Command word: ping, show, list or activate
+     * @param argument list: process name filter; activate: title regular expression
+     * @return Reply bytes
+     */
+    QByteArray handleCommand(const QString &command, const QString &argument);
+
+    /**
+     * @brief Open or close the activity journal and (re)start its flush timer per Journal/Enabled
+     */
+    void setupJournal();
+
+    /**
+     * @brief Append buffered journal records to the file, compacting it when it grew too large
+     */
+    void flushJournal();
+
+    /**
+     * @brief Create or drop the shared window table according to SharedTable/Enabled
+     */
+    void setupSharedTable();
+
+    /**
+     * @brief Apply an edited Settings.ini, touching only what the changed groups affect
+     * @param changes Settings::Change bits
+     */
+    void onSettingsChanged(quint32 changes);
+
+    /**
+     * @brief Restyle the tiles listed in m_changedStates and clear the list
+     */
+    void applyChangedStates();
+
+    /**
+     * @brief Republish the shared window table once the current event is handled
+     */
+    void scheduleSharedTablePublish();
+
+    /**
+     * @brief Write all tiles in panel order to the shared window table
+     */
+    void publishSharedTable();
+
+    /**
+     * @brief Copy the tracked state of a window onto its tile
+     * @param tile Tile to update
+     */
+    void applyWindowState(WindowTile *tile);
+
+    /**
+     * @brief Drop a window that is gone: its tile or collapsed info, and its cached icon
+     *
+     * The caller runs syncGroups() afterwards.
+     * @param hwnd Window handle
+     * @return true if the window was listed
+     */
+    bool removeTile(HWND hwnd);
+
+    /**
+     * @brief Start or cancel the hover preview of a tile
+     *
+     * The capture is requested at once and the preview shown after Thumbnail/HoverDelayMs.
+     * @param hwnd Window of the tile
+     * @param hovered true when the mouse entered the tile
+     */
+    void onTileHovered(HWND hwnd, bool hovered);
+
+    /**
+     * @brief Show the cached thumbnail of the hovered window next to its tile
+     */
+    void showPreview();
+
+    /**
+     * @brief Hide the preview and forget the hovered window
+     */
+    void hidePreview();
+
+    /**
+     * @brief Show a new thumbnail if it belongs to the previewed window
+     * @param handle Window handle
+     */
+    void onThumbnailReady(quintptr handle);
+
     /**
      * @brief Launch a new instance of an application
      * @param processPath Full path to the executable to launch
@@ -83,21 +475,55 @@ private:
 
     /**
      * @brief Fetch and sort the list of current windows
-     * @return List of WindowInfo objects
+     * @return List of WindowInfo objects, owned by the scanner and valid until the next scan
      */
-    QList<WindowInfo> fetchAndSortWindows();
+    QList<WindowInfo> &fetchAndSortWindows();
 
     /**
      * @brief Update the UI tiles with new window information
-     * @param windows List of window information
+     * @param windows List of window information, in display order
+     * @param diff Differences from the previous scan
+     * @return true if any tile was added, removed, reordered, changed or moved to another panel
+     */
+    bool updateTiles(const QList<WindowInfo> &windows, const SnapshotDiff &diff);
+
+    /**
+     * @brief Put every tile into the panel of its window's screen, in m_orderedTiles order
+     *
+     * A window that moved to another monitor keeps its tile, which is only
+     * reparented; a group tile goes to the screen of one of its windows. The
+     * layouts are refilled only if a tile moved or the order changed; tiles
+     * hidden by an active search stay hidden.
+     * @param orderChanged true if m_orderedTiles was reordered
+     * @return true if the layouts were refilled
+     */
+    bool placeTiles(bool orderChanged);
+
+    /**
+     * @brief Get the tile container for a window's monitor
+     * @param hwnd Window handle
+     * @return Container of this window or of a ScreenPanel
+     */
+    QWidget *containerForWindow(HWND hwnd);
+
+    /**
+     * @brief Pick the target screen and create or drop per-screen panels
+     *
+     * Tiles of dropped panels move back to this window until placeTiles() runs.
+     * @param removed Screen that is being removed, or nullptr
+     */
+    void setupScreens(QScreen *removed = nullptr);
+
+    /**
+     * @brief React to a screen being added, removed or resized
+     * @param removed Screen that is being removed, or nullptr
      */
-    void updateTiles(const QList<WindowInfo> &windows);
+    void onScreensChanged(QScreen *removed = nullptr);
 
     /**
-     * @brief Adjust the window geometry based on content
+     * @brief Adjust the window geometry (and that of the per-screen panels) based on content
      */
     void adjustWindowGeometry();
-    int layoutHeightForWindowHeight(int windowHeight) const;
 
     /**
      * @brief Create and initialize the system tray icon
@@ -112,10 +538,11 @@ private:
 
     /**
      * @brief Get the target screen based on settings
+     * @param screens Available screens
      * @return Pointer to the target QScreen, or primary screen if index is out of range
      */
-    QScreen* getTargetScreen();
+    static QScreen* getTargetScreen(const QList<QScreen*> &screens);
 
-    QSystemTrayIcon *m_trayIcon;
+    QSystemTrayIcon *m_trayIcon = nullptr;
 };
 #endif // MAINWINDOW_H
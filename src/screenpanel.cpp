@@ -0,0 +1,50 @@
+#include "screenpanel.h"
+#include "config.h"
+#include "flowlayout.h"
+#include <QScreen>
+#include <QVBoxLayout>
+
+ScreenPanel::ScreenPanel(QScreen *screen, QWidget *parent)
+    : QWidget(parent, Qt::Window | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint | Qt::Tool),
+      m_screen(screen)
+{
+    setAttribute(Qt::WA_TranslucentBackground);
+
+    QVBoxLayout *panelLayout = new QVBoxLayout(this);
+    panelLayout->setContentsMargins(0, 0, 0, 0);
+    panelLayout->setSpacing(0);
+
+    m_container = new QWidget(this);
+    m_flowLayout = new FlowLayout(m_container,
+                                  WinSelectorConfig::Layout::margin(),
+                                  WinSelectorConfig::Layout::hSpacing(),
+                                  WinSelectorConfig::Layout::vSpacing());
+    m_flowLayout->setRTL(true);
+    panelLayout->addWidget(m_container, 1);
+}
+
+void ScreenPanel::adjustGeometry()
+{
+    setGeometry(panelGeometry(m_screen, m_flowLayout, 0));
+    m_flowLayout->setGeometry(m_container->contentsRect());
+}
+
+QRect ScreenPanel::panelGeometry(QScreen *screen, const FlowLayout *layout, int nonLayoutHeight)
+{
+    const QRect availableGeom = screen->availableGeometry();
+
+    // Apply offset settings
+    const int topOffset = WinSelectorConfig::MainWindow::topOffset();
+    const int bottomOffset = WinSelectorConfig::MainWindow::bottomOffset();
+    const int adjustedHeight = availableGeom.height() - topOffset - bottomOffset;
+    const int layoutHeight = qMax(0, adjustedHeight - nonLayoutHeight);
+
+    // Ensure minimum width to avoid tiny window when empty
+    const int requiredWidth = qMax(layout->totalWidthForHeight(layoutHeight),
+                                   WinSelectorConfig::MainWindow::minimumWidth());
+
+    return QRect(availableGeom.x() + availableGeom.width() - requiredWidth,
+                 availableGeom.y() + topOffset,
+                 requiredWidth,
+                 adjustedHeight);
+}
@@ -0,0 +1,68 @@
+#ifndef SCREENPANEL_H
+#define SCREENPANEL_H
+
+#include <QRect>
+#include <QWidget>
+
+class FlowLayout;
+class QScreen;
+
+/**
+ * @brief Additional tile panel on a screen other than the main window's
+ *
+ * Used when Display/PanelPerScreen is enabled. The panel only hosts tiles: the
+ * tiles themselves, the scan that feeds them and the assignment of windows to
+ * screens all stay in MainWindow, which moves a tile between panels by
+ * reparenting it.
+ */
+class ScreenPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Construct a panel for a screen
+     * @param screen Screen to show the panel on
+     * @param parent Owning window; the panel is still a separate top-level window
+     */
+    ScreenPanel(QScreen *screen, QWidget *parent);
+
+    /**
+     * @brief Get the screen the panel was created for
+     * @return Screen
+     */
+    QScreen *targetScreen() const { return m_screen; }
+
+    /**
+     * @brief Get the widget that tiles of this panel are parented to
+     * @return Tile container
+     */
+    QWidget *container() const { return m_container; }
+
+    /**
+     * @brief Get the layout of the tile container
+     * @return Flow layout
+     */
+    FlowLayout *flowLayout() const { return m_flowLayout; }
+
+    /**
+     * @brief Fit the panel to its tiles at the right edge of its screen
+     */
+    void adjustGeometry();
+
+    /**
+     * @brief Compute a panel rectangle per the MainWindow offset and width settings
+     * @param screen Screen the panel is on
+     * @param layout Tile layout, asked for the width its tiles need
+     * @param nonLayoutHeight Height of the panel that is not part of the layout
+     * @return Panel geometry in screen coordinates
+     */
+    static QRect panelGeometry(QScreen *screen, const FlowLayout *layout, int nonLayoutHeight);
+
+private:
+    QScreen *m_screen;
+    QWidget *m_container;
+    FlowLayout *m_flowLayout;
+};
+
+#endif // SCREENPANEL_H
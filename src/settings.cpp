@@ -1,4 +1,5 @@
 #include "settings.h"
+#include <QFileInfo>
 #include <QKeySequence>
 #include <windows.h>
 
@@ -11,7 +12,12 @@ Settings& Settings::instance()
 Settings::Settings()
 {
     m_settings = new QSettings("Settings.ini", QSettings::IniFormat);
-    
+    m_snapshots.push_back(read());
+    m_current.store(m_snapshots.back().get(), std::memory_order_release);
+}
+
+void Settings::writeDefaults()
+{
     // Write defaults if missing so the user has a template
     if (!m_settings->contains("MainWindow/RefreshIntervalMs")) m_settings->setValue("MainWindow/RefreshIntervalMs", 2000);
     if (!m_settings->contains("MainWindow/CloseRefreshDelayMs")) m_settings->setValue("MainWindow/CloseRefreshDelayMs", 500);
@@ -26,6 +32,7 @@ Settings::Settings()
     if (!m_settings->contains("Layout/VSpacing")) m_settings->setValue("Layout/VSpacing", 2);
 
     if (!m_settings->contains("WindowScanner/MaxTitleLength")) m_settings->setValue("WindowScanner/MaxTitleLength", 256);
+    if (!m_settings->contains("WindowScanner/RefreshBudgetMs")) m_settings->setValue("WindowScanner/RefreshBudgetMs", 100);
 
     if (!m_settings->contains("WindowTile/Width")) m_settings->setValue("WindowTile/Width", 250);
     if (!m_settings->contains("WindowTile/Height")) m_settings->setValue("WindowTile/Height", 30);
@@ -35,50 +42,236 @@ Settings::Settings()
     if (!m_settings->contains("WindowTile/EnableShiftClickClose")) m_settings->setValue("WindowTile/EnableShiftClickClose", false);
 
     if (!m_settings->contains("Display/TargetDisplayIndex")) m_settings->setValue("Display/TargetDisplayIndex", 0);
+    if (!m_settings->contains("Display/PanelPerScreen")) m_settings->setValue("Display/PanelPerScreen", false);
+
+    if (!m_settings->contains("Filter/ExcludeProcesses")) m_settings->setValue("Filter/ExcludeProcesses", QString());
+    if (!m_settings->contains("Filter/ExcludeClasses")) m_settings->setValue("Filter/ExcludeClasses", QString());
+    if (!m_settings->contains("Filter/ExcludeTitlePatterns")) m_settings->setValue("Filter/ExcludeTitlePatterns", QString());
+    if (!m_settings->contains("Filter/IncludeProcesses")) m_settings->setValue("Filter/IncludeProcesses", QString());
+    if (!m_settings->contains("Filter/IncludeClasses")) m_settings->setValue("Filter/IncludeClasses", QString());
+    if (!m_settings->contains("Filter/IncludeTitlePatterns")) m_settings->setValue("Filter/IncludeTitlePatterns", QString());
+    if (!m_settings->contains("Filter/ExcludeStyleMask")) m_settings->setValue("Filter/ExcludeStyleMask", "0x0");
+    if (!m_settings->contains("Filter/ExcludeExStyleMask")) m_settings->setValue("Filter/ExcludeExStyleMask", "0x0");
+
+    if (!m_settings->contains("Sort/Mode")) m_settings->setValue("Sort/Mode", "Alphabetical");
+    if (!m_settings->contains("Sort/FrecencyHalfLifeHours")) m_settings->setValue("Sort/FrecencyHalfLifeHours", 72);
+
+    if (!m_settings->contains("Journal/Enabled")) m_settings->setValue("Journal/Enabled", false);
+    if (!m_settings->contains("Journal/FlushIntervalMs")) m_settings->setValue("Journal/FlushIntervalMs", 5000);
+    if (!m_settings->contains("Journal/RetentionHours")) m_settings->setValue("Journal/RetentionHours", 168);
+    if (!m_settings->contains("Journal/MaxFileSizeKB")) m_settings->setValue("Journal/MaxFileSizeKB", 16384);
+
+    if (!m_settings->contains("SharedTable/Enabled")) m_settings->setValue("SharedTable/Enabled", false);
+
+    if (!m_settings->contains("Search/OpenOnHotkey")) m_settings->setValue("Search/OpenOnHotkey", true);
+
+    if (!m_settings->contains("Thumbnail/Enabled")) m_settings->setValue("Thumbnail/Enabled", true);
+    if (!m_settings->contains("Thumbnail/HoverDelayMs")) m_settings->setValue("Thumbnail/HoverDelayMs", 400);
+    if (!m_settings->contains("Thumbnail/MaxAgeMs")) m_settings->setValue("Thumbnail/MaxAgeMs", 3000);
+    if (!m_settings->contains("Thumbnail/CacheSizeKB")) m_settings->setValue("Thumbnail/CacheSizeKB", 16384);
+
+    if (!m_settings->contains("Grouping/Enabled")) m_settings->setValue("Grouping/Enabled", false);
+    if (!m_settings->contains("Grouping/MinWindows")) m_settings->setValue("Grouping/MinWindows", 2);
+
+    if (!m_settings->contains("Activation/ConfirmTimeoutMs")) m_settings->setValue("Activation/ConfirmTimeoutMs", 50);
+
+    if (!m_settings->contains("Diagnostics/SteadyStateAllocationBudget")) m_settings->setValue("Diagnostics/SteadyStateAllocationBudget", 32);
 
     if (!m_settings->contains("Shortcuts/ToggleVisibility")) m_settings->setValue("Shortcuts/ToggleVisibility", "Home");
 
+    if (!m_settings->contains("Startup/UseSnapshot")) m_settings->setValue("Startup/UseSnapshot", true);
+    if (!m_settings->contains("Startup/FirstPaintBudgetMs")) m_settings->setValue("Startup/FirstPaintBudgetMs", 30);
+
     m_settings->sync();
-    load();
 }
 
-void Settings::load()
+std::unique_ptr<SettingsValues> Settings::read()
 {
+    auto values = std::make_unique<SettingsValues>();
+
     // MainWindow
-    mainWindowRefreshIntervalMs = m_settings->value("MainWindow/RefreshIntervalMs", 2000).toInt();
-    mainWindowCloseRefreshDelayMs = m_settings->value("MainWindow/CloseRefreshDelayMs", 500).toInt();
-    mainWindowInitialWidth = m_settings->value("MainWindow/InitialWidth", 300).toInt();
-    mainWindowMinimumWidth = m_settings->value("MainWindow/MinimumWidth", 300).toInt();
-    mainWindowTopOffset = m_settings->value("MainWindow/TopOffset", 0).toInt();
-    mainWindowBottomOffset = m_settings->value("MainWindow/BottomOffset", 0).toInt();
-    mainWindowIconRefreshIntervalMs = m_settings->value("MainWindow/IconRefreshIntervalMs", 60000).toInt();
+    values->mainWindowRefreshIntervalMs = m_settings->value("MainWindow/RefreshIntervalMs", 2000).toInt();
+    values->mainWindowCloseRefreshDelayMs = m_settings->value("MainWindow/CloseRefreshDelayMs", 500).toInt();
+    values->mainWindowInitialWidth = m_settings->value("MainWindow/InitialWidth", 300).toInt();
+    values->mainWindowMinimumWidth = m_settings->value("MainWindow/MinimumWidth", 300).toInt();
+    values->mainWindowTopOffset = m_settings->value("MainWindow/TopOffset", 0).toInt();
+    values->mainWindowBottomOffset = m_settings->value("MainWindow/BottomOffset", 0).toInt();
+    values->mainWindowIconRefreshIntervalMs = m_settings->value("MainWindow/IconRefreshIntervalMs", 60000).toInt();
 
     // Layout
-    layoutMargin = m_settings->value("Layout/Margin", 2).toInt();
-    layoutHSpacing = m_settings->value("Layout/HSpacing", 2).toInt();
-    layoutVSpacing = m_settings->value("Layout/VSpacing", 2).toInt();
+    values->layoutMargin = m_settings->value("Layout/Margin", 2).toInt();
+    values->layoutHSpacing = m_settings->value("Layout/HSpacing", 2).toInt();
+    values->layoutVSpacing = m_settings->value("Layout/VSpacing", 2).toInt();
 
     // WindowScanner
-    windowScannerMaxTitleLength = m_settings->value("WindowScanner/MaxTitleLength", 256).toInt();
+    values->windowScannerMaxTitleLength = m_settings->value("WindowScanner/MaxTitleLength", 256).toInt();
+    values->windowScannerRefreshBudgetMs = m_settings->value("WindowScanner/RefreshBudgetMs", 100).toInt();
 
     // WindowTile
-    tileWidth = m_settings->value("WindowTile/Width", 250).toInt();
-    tileHeight = m_settings->value("WindowTile/Height", 30).toInt();
-    tileIconSize = m_settings->value("WindowTile/IconSize", 16).toInt();
-    tileContentMargin = m_settings->value("WindowTile/ContentMargin", 2).toInt();
-    tileInternalSpacing = m_settings->value("WindowTile/InternalSpacing", 5).toInt();
-    tileEnableShiftClickClose = m_settings->value("WindowTile/EnableShiftClickClose", false).toBool();
+    values->tileWidth = m_settings->value("WindowTile/Width", 250).toInt();
+    values->tileHeight = m_settings->value("WindowTile/Height", 30).toInt();
+    values->tileIconSize = m_settings->value("WindowTile/IconSize", 16).toInt();
+    values->tileContentMargin = m_settings->value("WindowTile/ContentMargin", 2).toInt();
+    values->tileInternalSpacing = m_settings->value("WindowTile/InternalSpacing", 5).toInt();
+    values->tileEnableShiftClickClose = m_settings->value("WindowTile/EnableShiftClickClose", false).toBool();
 
     // Display
-    targetDisplayIndex = m_settings->value("Display/TargetDisplayIndex", 0).toInt();
+    values->targetDisplayIndex = m_settings->value("Display/TargetDisplayIndex", 0).toInt();
+    values->displayPanelPerScreen = m_settings->value("Display/PanelPerScreen", false).toBool();
+
+    // Filter
+    values->filterExcludeProcesses = m_settings->value("Filter/ExcludeProcesses").toStringList();
+    values->filterExcludeClasses = m_settings->value("Filter/ExcludeClasses").toStringList();
+    values->filterExcludeTitlePatterns = m_settings->value("Filter/ExcludeTitlePatterns").toStringList();
+    values->filterIncludeProcesses = m_settings->value("Filter/IncludeProcesses").toStringList();
+    values->filterIncludeClasses = m_settings->value("Filter/IncludeClasses").toStringList();
+    values->filterIncludeTitlePatterns = m_settings->value("Filter/IncludeTitlePatterns").toStringList();
+    // Masks are written as hex ("0x80"); base 0 also accepts decimal
+    values->filterExcludeStyleMask = m_settings->value("Filter/ExcludeStyleMask", "0x0").toString().toUInt(nullptr, 0);
+    values->filterExcludeExStyleMask = m_settings->value("Filter/ExcludeExStyleMask", "0x0").toString().toUInt(nullptr, 0);
+
+    // Sort
+    values->sortByFrecency = m_settings->value("Sort/Mode", "Alphabetical").toString().compare("Frecency", Qt::CaseInsensitive) == 0;
+    values->sortFrecencyHalfLifeHours = m_settings->value("Sort/FrecencyHalfLifeHours", 72).toDouble();
+
+    // Journal
+    values->journalEnabled = m_settings->value("Journal/Enabled", false).toBool();
+    values->journalFlushIntervalMs = m_settings->value("Journal/FlushIntervalMs", 5000).toInt();
+    values->journalRetentionHours = m_settings->value("Journal/RetentionHours", 168).toInt();
+    values->journalMaxFileSizeKB = m_settings->value("Journal/MaxFileSizeKB", 16384).toInt();
+
+    // Shared table
+    values->sharedTableEnabled = m_settings->value("SharedTable/Enabled", false).toBool();
+
+    // Search
+    values->searchOpenOnHotkey = m_settings->value("Search/OpenOnHotkey", true).toBool();
+
+    // Thumbnail
+    values->thumbnailEnabled = m_settings->value("Thumbnail/Enabled", true).toBool();
+    values->thumbnailHoverDelayMs = m_settings->value("Thumbnail/HoverDelayMs", 400).toInt();
+    values->thumbnailMaxAgeMs = m_settings->value("Thumbnail/MaxAgeMs", 3000).toInt();
+    values->thumbnailCacheSizeKB = m_settings->value("Thumbnail/CacheSizeKB", 16384).toInt();
+
+    // Grouping
+    values->groupingEnabled = m_settings->value("Grouping/Enabled", false).toBool();
+    values->groupingMinWindows = m_settings->value("Grouping/MinWindows", 2).toInt();
+
+    // Activation
+    values->activationConfirmTimeoutMs = m_settings->value("Activation/ConfirmTimeoutMs", 50).toInt();
+
+    // Diagnostics
+    values->diagnosticsSteadyStateAllocationBudget = m_settings->value("Diagnostics/SteadyStateAllocationBudget", 32).toInt();
 
     // Shortcuts
-    toggleVisibilityShortcut = m_settings->value("Shortcuts/ToggleVisibility", "Home").toString();
+    values->toggleVisibilityShortcut = m_settings->value("Shortcuts/ToggleVisibility", "Home").toString();
+
+    // Startup
+    values->startupUseSnapshot = m_settings->value("Startup/UseSnapshot", true).toBool();
+    values->startupFirstPaintBudgetMs = m_settings->value("Startup/FirstPaintBudgetMs", 30).toInt();
+
+    return values;
+}
+
+quint32 Settings::reload()
+{
+    // Picks up the edited file
+    m_settings->sync();
+    std::unique_ptr<SettingsValues> values = read();
+    const quint32 changes = compare(current(), *values);
+    if (changes == 0)
+    {
+        return 0;
+    }
+    m_snapshots.push_back(std::move(values));
+    m_current.store(m_snapshots.back().get(), std::memory_order_release);
+    return changes;
+}
+
+QString Settings::filePath() const
+{
+    return QFileInfo(m_settings->fileName()).absoluteFilePath();
+}
+
+quint32 Settings::compare(const SettingsValues &a, const SettingsValues &b)
+{
+    quint32 changes = 0;
+    if (a.mainWindowRefreshIntervalMs != b.mainWindowRefreshIntervalMs)
+    {
+        changes |= RefreshInterval;
+    }
+    if (a.mainWindowIconRefreshIntervalMs != b.mainWindowIconRefreshIntervalMs)
+    {
+        changes |= IconRefreshInterval;
+    }
+    if (a.mainWindowInitialWidth != b.mainWindowInitialWidth || a.mainWindowMinimumWidth != b.mainWindowMinimumWidth ||
+        a.mainWindowTopOffset != b.mainWindowTopOffset || a.mainWindowBottomOffset != b.mainWindowBottomOffset ||
+        a.targetDisplayIndex != b.targetDisplayIndex || a.displayPanelPerScreen != b.displayPanelPerScreen)
+    {
+        changes |= PanelGeometry;
+    }
+    if (a.layoutMargin != b.layoutMargin || a.layoutHSpacing != b.layoutHSpacing || a.layoutVSpacing != b.layoutVSpacing)
+    {
+        changes |= Layout;
+    }
+    if (a.tileWidth != b.tileWidth || a.tileHeight != b.tileHeight || a.tileIconSize != b.tileIconSize ||
+        a.tileContentMargin != b.tileContentMargin || a.tileInternalSpacing != b.tileInternalSpacing)
+    {
+        changes |= TileGeometry;
+    }
+    if (a.tileEnableShiftClickClose != b.tileEnableShiftClickClose)
+    {
+        changes |= TileBehavior;
+    }
+    if (a.filterExcludeProcesses != b.filterExcludeProcesses || a.filterExcludeClasses != b.filterExcludeClasses ||
+        a.filterExcludeTitlePatterns != b.filterExcludeTitlePatterns ||
+        a.filterIncludeProcesses != b.filterIncludeProcesses || a.filterIncludeClasses != b.filterIncludeClasses ||
+        a.filterIncludeTitlePatterns != b.filterIncludeTitlePatterns ||
+        a.filterExcludeStyleMask != b.filterExcludeStyleMask || a.filterExcludeExStyleMask != b.filterExcludeExStyleMask)
+    {
+        changes |= Filter;
+    }
+    if (a.sortByFrecency != b.sortByFrecency || a.sortFrecencyHalfLifeHours != b.sortFrecencyHalfLifeHours)
+    {
+        changes |= Sort;
+    }
+    if (a.journalEnabled != b.journalEnabled || a.journalFlushIntervalMs != b.journalFlushIntervalMs ||
+        a.journalRetentionHours != b.journalRetentionHours || a.journalMaxFileSizeKB != b.journalMaxFileSizeKB)
+    {
+        changes |= Journal;
+    }
+    if (a.sharedTableEnabled != b.sharedTableEnabled)
+    {
+        changes |= SharedTable;
+    }
+    if (a.toggleVisibilityShortcut != b.toggleVisibilityShortcut)
+    {
+        changes |= Shortcut;
+    }
+    if (a.thumbnailEnabled != b.thumbnailEnabled || a.thumbnailCacheSizeKB != b.thumbnailCacheSizeKB)
+    {
+        changes |= Thumbnail;
+    }
+    if (a.groupingEnabled != b.groupingEnabled || a.groupingMinWindows != b.groupingMinWindows)
+    {
+        changes |= Grouping;
+    }
+    if (a.mainWindowCloseRefreshDelayMs != b.mainWindowCloseRefreshDelayMs ||
+        a.windowScannerMaxTitleLength != b.windowScannerMaxTitleLength ||
+        a.windowScannerRefreshBudgetMs != b.windowScannerRefreshBudgetMs ||
+        a.searchOpenOnHotkey != b.searchOpenOnHotkey ||
+        a.thumbnailHoverDelayMs != b.thumbnailHoverDelayMs || a.thumbnailMaxAgeMs != b.thumbnailMaxAgeMs ||
+        a.activationConfirmTimeoutMs != b.activationConfirmTimeoutMs ||
+        a.startupUseSnapshot != b.startupUseSnapshot || a.startupFirstPaintBudgetMs != b.startupFirstPaintBudgetMs ||
+        a.diagnosticsSteadyStateAllocationBudget != b.diagnosticsSteadyStateAllocationBudget)
+    {
+        changes |= Other;
+    }
+    return changes;
 }
 
 int Settings::getToggleVisibilityKeyVk()
 {
-    QKeySequence seq(toggleVisibilityShortcut);
+    QKeySequence seq(current().toggleVisibilityShortcut);
     if (seq.isEmpty()) return VK_HOME;
 
     int k = seq[0].key();
@@ -3,14 +3,16 @@
 
 #include <QSettings>
 #include <QString>
+#include <QStringList>
+#include <atomic>
+#include <memory>
+#include <vector>
 
-class Settings
+/**
+ * @brief One immutable set of values read from Settings.ini
+ */
+struct SettingsValues
 {
-public:
-    static Settings& instance();
-
-    void load();
-
     // MainWindow
     int mainWindowRefreshIntervalMs;
     int mainWindowCloseRefreshDelayMs;
@@ -27,6 +29,7 @@ public:
 
     // WindowScanner
     int windowScannerMaxTitleLength;
+    int windowScannerRefreshBudgetMs;
 
     // WindowTile
     int tileWidth;
@@ -38,15 +41,129 @@ public:
 
     // Display
     int targetDisplayIndex;
+    bool displayPanelPerScreen;
+
+    // Filter
+    QStringList filterExcludeProcesses;
+    QStringList filterExcludeClasses;
+    QStringList filterExcludeTitlePatterns;
+    QStringList filterIncludeProcesses;
+    QStringList filterIncludeClasses;
+    QStringList filterIncludeTitlePatterns;
+    quint32 filterExcludeStyleMask;
+    quint32 filterExcludeExStyleMask;
+
+    // Sort
+    bool sortByFrecency;
+    double sortFrecencyHalfLifeHours;
+
+    // Journal
+    bool journalEnabled;
+    int journalFlushIntervalMs;
+    int journalRetentionHours;
+    int journalMaxFileSizeKB;
+
+    // Shared table
+    bool sharedTableEnabled;
+
+    // Search
+    bool searchOpenOnHotkey;
+
+    // Thumbnail
+    bool thumbnailEnabled;
+    int thumbnailHoverDelayMs;
+    int thumbnailMaxAgeMs;
+    int thumbnailCacheSizeKB;
+
+    // Grouping
+    bool groupingEnabled;
+    int groupingMinWindows;
+
+    // Activation
+    int activationConfirmTimeoutMs;
+
+    // Diagnostics
+    int diagnosticsSteadyStateAllocationBudget;
 
     // Shortcuts
     QString toggleVisibilityShortcut;
+
+    // Startup
+    bool startupUseSnapshot;
+    int startupFirstPaintBudgetMs;
+};
+
+/**
+ * @brief Owner of Settings.ini and of the current SettingsValues snapshot
+ *
+ * Values are never modified in place. reload() reads the file into a new
+ * snapshot and publishes it with one atomic pointer store, so a reader on any
+ * thread sees either the old or the new values, never a mix. Retired snapshots
+ * are kept until exit, which keeps references taken before a reload valid; a
+ * reload only happens when the user edits the file.
+ */
+class Settings
+{
+public:
+    /**
+     * @brief Groups of values reported by reload(), so each consumer reacts only to its own
+     */
+    enum Change : quint32
+    {
+        RefreshInterval = 1u << 0,     ///< MainWindow/RefreshIntervalMs
+        IconRefreshInterval = 1u << 1, ///< MainWindow/IconRefreshIntervalMs
+        PanelGeometry = 1u << 2,       ///< Panel width, offsets and target display
+        Layout = 1u << 3,              ///< [Layout]
+        TileGeometry = 1u << 4,        ///< Tile size, icon size, margins and spacing
+        TileBehavior = 1u << 5,        ///< WindowTile/EnableShiftClickClose
+        Filter = 1u << 6,              ///< [Filter]
+        Sort = 1u << 7,                ///< [Sort]
+        Journal = 1u << 8,             ///< [Journal]
+        SharedTable = 1u << 9,         ///< [SharedTable]
+        Shortcut = 1u << 10,           ///< [Shortcuts]
+        Thumbnail = 1u << 11,          ///< Thumbnail/Enabled and Thumbnail/CacheSizeKB
+        Grouping = 1u << 12,           ///< [Grouping]
+        Other = 1u << 13               ///< Values read on every use (scanner, search, activation, ...)
+    };
+
+    static Settings& instance();
+
+    /**
+     * @brief Get the current snapshot
+     * @return Values; stay valid after a later reload()
+     */
+    const SettingsValues &current() const { return *m_current.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Re-read Settings.ini and publish a new snapshot if anything changed
+     * @return Change bits of the groups that differ from the previous snapshot
+     */
+    quint32 reload();
+
+    /**
+     * @brief Add missing keys with their default values to Settings.ini
+     *
+     * Gives the user a complete template to edit. Not needed for reading, so it
+     * runs after startup instead of in the constructor.
+     */
+    void writeDefaults();
+
+    /**
+     * @brief Get the absolute path of Settings.ini
+     * @return File path
+     */
+    QString filePath() const;
+
     int getToggleVisibilityKeyVk();
 
 private:
     Settings();
     QSettings *m_settings;
-    
+    std::atomic<const SettingsValues *> m_current{nullptr};
+    std::vector<std::unique_ptr<const SettingsValues>> m_snapshots;
+
+    std::unique_ptr<SettingsValues> read();
+    static quint32 compare(const SettingsValues &a, const SettingsValues &b);
     int qtKeyToVk(Qt::Key key);
 };
 
@@ -0,0 +1,39 @@
+#include "settingswatcher.h"
+#include "settings.h"
+#include <QDebug>
+#include <QFileInfo>
+
+SettingsWatcher::SettingsWatcher(QObject *parent)
+    : QObject(parent), m_filePath(Settings::instance().filePath())
+{
+    m_settleTimer.setSingleShot(true);
+    m_settleTimer.setInterval(SettleMs);
+    connect(&m_settleTimer, &QTimer::timeout, this, &SettingsWatcher::reload);
+
+    m_watcher.addPath(m_filePath);
+    m_watcher.addPath(QFileInfo(m_filePath).absolutePath());
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, &m_settleTimer, qOverload<>(&QTimer::start));
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &SettingsWatcher::onDirectoryChanged);
+}
+
+void SettingsWatcher::onDirectoryChanged()
+{
+    // Other files in the directory (journal, frecency) change too; only a
+    // replaced Settings.ini matters here
+    if (m_watcher.files().contains(m_filePath) || !QFileInfo::exists(m_filePath))
+    {
+        return;
+    }
+    m_watcher.addPath(m_filePath);
+    m_settleTimer.start();
+}
+
+void SettingsWatcher::reload()
+{
+    const quint32 changes = Settings::instance().reload();
+    if (changes != 0)
+    {
+        qDebug() << "Settings.ini reloaded, changes" << Qt::hex << changes;
+        emit changed(changes);
+    }
+}
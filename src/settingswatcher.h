@@ -0,0 +1,45 @@
+#ifndef SETTINGSWATCHER_H
+#define SETTINGSWATCHER_H
+
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QTimer>
+
+/**
+ * @brief Reloads Settings.ini when it is edited and reports what changed
+ *
+ * Editors often save by replacing the file, which removes it from the file
+ * watcher, so the containing directory is watched as well and the file is added
+ * back when it reappears. Bursts of notifications from one save are merged into
+ * a single reload.
+ */
+class SettingsWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Start watching Settings.ini
+     * @param parent Parent object
+     */
+    explicit SettingsWatcher(QObject *parent = nullptr);
+
+signals:
+    /**
+     * @brief Emitted after a reload that changed at least one value
+     * @param changes Settings::Change bits
+     */
+    void changed(quint32 changes);
+
+private:
+    static constexpr int SettleMs = 200;
+
+    QFileSystemWatcher m_watcher;
+    QTimer m_settleTimer;
+    QString m_filePath;
+
+    void onDirectoryChanged();
+    void reload();
+};
+
+#endif // SETTINGSWATCHER_H
@@ -0,0 +1,211 @@
+#include "sharedwindowtable.h"
+#include <QDebug>
+#include <QThread>
+#include <algorithm>
+#include <cstring>
+
+using namespace SharedWindowTableLayout;
+
+QString SharedWindowTableLayout::key()
+{
+    QString user = qEnvironmentVariable("USERNAME");
+    if (user.isEmpty())
+    {
+        user = qEnvironmentVariable("USER");
+    }
+    return "WinSelector-Windows-" + user;
+}
+
+bool SharedWindowTable::create(const QString &nativeKey)
+{
+    m_memory.setNativeKey(nativeKey);
+    if (!m_memory.create(TotalBytes))
+    {
+        // On Unix a crashed instance leaves the segment behind
+        if (m_memory.error() != QSharedMemory::AlreadyExists || !m_memory.attach())
+        {
+            qWarning() << "SharedWindowTable: cannot create" << nativeKey << "-" << m_memory.errorString();
+            return false;
+        }
+    }
+
+    char *base = static_cast<char *>(m_memory.data());
+    m_header = reinterpret_cast<Header *>(base);
+    m_rows = reinterpret_cast<Row *>(base + RowsOffset);
+    m_strings = reinterpret_cast<char16_t *>(base + StringsOffset);
+
+    // No reader can be mid-copy of a table that has never been published
+    m_header->sequence.store(0, std::memory_order_relaxed);
+    m_header->magic = Magic;
+    m_header->version = Version;
+    m_header->rowCount = 0;
+    m_header->stringChars = 0;
+    m_header->truncated = 0;
+    m_header->foreground = 0;
+    m_header->publishedMs = 0;
+    return true;
+}
+
+void SharedWindowTable::beginPublish()
+{
+    const quint32 sequence = m_header->sequence.load(std::memory_order_relaxed);
+    m_header->sequence.store(sequence + 1, std::memory_order_relaxed);
+    // Orders the odd sequence before every write of the table
+    std::atomic_thread_fence(std::memory_order_release);
+
+    m_rowCount = 0;
+    m_stringChars = 0;
+    m_truncated = false;
+    m_processOffsets.clear();
+}
+
+bool SharedWindowTable::storeString(const QString &text, quint32 &offset)
+{
+    const quint32 length = static_cast<quint32>(text.size());
+    if (length > StringPoolChars - m_stringChars)
+    {
+        return false;
+    }
+    std::memcpy(m_strings + m_stringChars, text.utf16(), length * sizeof(char16_t));
+    offset = m_stringChars;
+    m_stringChars += length;
+    return true;
+}
+
+void SharedWindowTable::append(quintptr handle, quint32 processId, quint32 flags, const QString &processName,
+                               const QString &title)
+{
+    if (m_rowCount == MaxRows)
+    {
+        m_truncated = true;
+        return;
+    }
+
+    quint32 processOffset = 0;
+    auto it = m_processOffsets.constFind(processName);
+    if (it != m_processOffsets.constEnd())
+    {
+        processOffset = it.value();
+    }
+    else if (storeString(processName, processOffset))
+    {
+        m_processOffsets.insert(processName, processOffset);
+    }
+    else
+    {
+        m_truncated = true;
+        return;
+    }
+
+    quint32 titleOffset = 0;
+    if (!storeString(title, titleOffset))
+    {
+        m_truncated = true;
+        return;
+    }
+
+    m_rows[m_rowCount++] = Row{handle, processId, flags, titleOffset, static_cast<quint32>(title.size()),
+                               processOffset, static_cast<quint32>(processName.size())};
+}
+
+void SharedWindowTable::endPublish(quintptr foreground, qint64 publishedMs)
+{
+    m_header->rowCount = m_rowCount;
+    m_header->stringChars = m_stringChars;
+    m_header->truncated = m_truncated ? 1 : 0;
+    m_header->foreground = foreground;
+    m_header->publishedMs = publishedMs;
+
+    const quint32 sequence = m_header->sequence.load(std::memory_order_relaxed);
+    m_header->sequence.store(sequence + 1, std::memory_order_release);
+}
+
+bool SharedWindowTableReader::attach(const QString &nativeKey)
+{
+    m_memory.setNativeKey(nativeKey);
+    if (!m_memory.attach(QSharedMemory::ReadOnly))
+    {
+        return false;
+    }
+    if (m_memory.size() < TotalBytes)
+    {
+        m_memory.detach();
+        return false;
+    }
+    const Header *header = static_cast<const Header *>(m_memory.constData());
+    if (header->magic != Magic || header->version != Version)
+    {
+        m_memory.detach();
+        return false;
+    }
+    return true;
+}
+
+bool SharedWindowTableReader::read(Snapshot &snapshot, int maxAttempts)
+{
+    if (!m_memory.isAttached())
+    {
+        return false;
+    }
+    return readFrom(m_memory.constData(), snapshot, maxAttempts, m_rows, m_strings);
+}
+
+bool SharedWindowTableReader::readFrom(const void *region, Snapshot &snapshot, int maxAttempts,
+                                       std::vector<Row> &rows, std::vector<char16_t> &strings)
+{
+    const char *base = static_cast<const char *>(region);
+    const Header *header = reinterpret_cast<const Header *>(base);
+
+    rows.resize(MaxRows);
+    strings.resize(StringPoolChars);
+
+    for (int attempt = 0; attempt < maxAttempts; ++attempt)
+    {
+        const quint32 before = header->sequence.load(std::memory_order_acquire);
+        if (before & 1)
+        {
+            QThread::yieldCurrentThread();
+            continue;
+        }
+
+        // The counts may be torn; clamp them and let the sequence check decide
+        const quint32 rowCount = std::min(header->rowCount, MaxRows);
+        const quint32 stringChars = std::min(header->stringChars, StringPoolChars);
+        const quint64 foreground = header->foreground;
+        const qint64 publishedMs = header->publishedMs;
+        const bool truncated = header->truncated != 0;
+        std::memcpy(rows.data(), base + RowsOffset, rowCount * sizeof(Row));
+        std::memcpy(strings.data(), base + StringsOffset, stringChars * sizeof(char16_t));
+
+        // Orders the copies above before the second sequence load
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header->sequence.load(std::memory_order_relaxed) != before)
+        {
+            continue;
+        }
+
+        // Decoded from the private copy only, so the writer cannot interfere
+        snapshot.windows.clear();
+        snapshot.windows.reserve(rowCount);
+        const auto text = [&strings, stringChars](quint32 offset, quint32 length)
+        {
+            if (offset > stringChars || length > stringChars - offset)
+            {
+                return QString();
+            }
+            return QString(reinterpret_cast<const QChar *>(strings.data() + offset), length);
+        };
+        for (quint32 i = 0; i < rowCount; ++i)
+        {
+            const Row &row = rows[i];
+            snapshot.windows.push_back(Window{row.handle, row.processId, row.flags,
+                                              text(row.processOffset, row.processLength),
+                                              text(row.titleOffset, row.titleLength)});
+        }
+        snapshot.foreground = foreground;
+        snapshot.publishedMs = publishedMs;
+        snapshot.truncated = truncated;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,192 @@
+#ifndef SHAREDWINDOWTABLE_H
+#define SHAREDWINDOWTABLE_H
+
+#include <QHash>
+#include <QSharedMemory>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+#include <vector>
+
+/**
+ * @brief Fixed layout of the shared-memory window table
+ *
+ * The region starts with a Header, followed by MaxRows Rows and a pool of
+ * UTF-16 strings that the rows reference by offset. Process names are stored
+ * once per distinct name. All fields have fixed sizes, so 32-bit and 64-bit
+ * readers see the same layout.
+ *
+ * Consistency is provided by a sequence lock: the single writer makes the
+ * sequence odd, rewrites the table and makes it even again. Readers copy the
+ * table and retry if the sequence was odd or changed during the copy, so neither
+ * side ever takes a lock or makes a system call.
+ */
+namespace SharedWindowTableLayout
+{
+    constexpr quint32 Magic = 0x54575357; // "WSWT"
+    constexpr quint32 Version = 1;
+    constexpr quint32 MaxRows = 2048;
+    constexpr quint32 StringPoolChars = 256 * 1024;
+
+    /**
+     * @brief Row state flags; same bits as ShellWindowState::Flags
+     */
+    enum RowFlag : quint32
+    {
+        Active = 1,
+        Flashing = 2,
+        Minimized = 4
+    };
+
+    struct Header
+    {
+        quint32 magic;
+        quint32 version;
+        std::atomic<quint32> sequence; ///< Odd while the writer is updating
+        quint32 rowCount;
+        quint32 stringChars;           ///< Used part of the string pool
+        quint32 truncated;             ///< 1 if not every window fit
+        quint64 foreground;            ///< Foreground window handle
+        qint64 publishedMs;            ///< Milliseconds since the epoch
+    };
+
+    struct Row
+    {
+        quint64 handle;
+        quint32 processId;
+        quint32 flags;
+        quint32 titleOffset;   ///< In UTF-16 code units from the pool start
+        quint32 titleLength;
+        quint32 processOffset;
+        quint32 processLength;
+    };
+
+    constexpr qsizetype RowsOffset = sizeof(Header);
+    constexpr qsizetype StringsOffset = RowsOffset + MaxRows * sizeof(Row);
+    constexpr qsizetype TotalBytes = StringsOffset + StringPoolChars * sizeof(char16_t);
+
+    static_assert(std::atomic<quint32>::is_always_lock_free, "The sequence must work across processes");
+    static_assert(sizeof(Header) == 40 && sizeof(Row) == 32, "Layout is shared with other processes");
+
+    /**
+     * @brief Get the name of the shared-memory region, unique per user
+     * @return Native key
+     */
+    QString key();
+}
+
+/**
+ * @brief Writer side: publishes the panel's window list into shared memory
+ *
+ * Only one writer may exist; the single-instance command channel guarantees
+ * this across processes. Rows are written in place between beginPublish() and
+ * endPublish(), with no intermediate copy.
+ */
+class SharedWindowTable
+{
+public:
+    /**
+     * @brief Create the region (or take over one left by a crashed instance)
+     * @param nativeKey Region name; tests pass their own to stay apart from a running instance
+     * @return false if shared memory is unavailable
+     */
+    bool create(const QString &nativeKey = SharedWindowTableLayout::key());
+
+    /**
+     * @brief Check whether create() succeeded
+     */
+    bool isOpen() const { return m_header != nullptr; }
+
+    /**
+     * @brief Start rewriting the table; readers retry until endPublish()
+     */
+    void beginPublish();
+
+    /**
+     * @brief Append a window; ignored once the table or string pool is full
+     * @param handle Window handle
+     * @param processId Owning process ID
+     * @param flags RowFlag bits
+     * @param processName Process executable name (stored once per distinct name)
+     * @param title Window title
+     */
+    void append(quintptr handle, quint32 processId, quint32 flags, const QString &processName, const QString &title);
+
+    /**
+     * @brief Finish the update and make it visible to readers
+     * @param foreground Foreground window handle
+     * @param publishedMs Publication time in milliseconds since the epoch
+     */
+    void endPublish(quintptr foreground, qint64 publishedMs);
+
+private:
+    QSharedMemory m_memory;
+    SharedWindowTableLayout::Header *m_header = nullptr;
+    SharedWindowTableLayout::Row *m_rows = nullptr;
+    char16_t *m_strings = nullptr;
+    quint32 m_rowCount = 0;
+    quint32 m_stringChars = 0;
+    bool m_truncated = false;
+    // Pool offset of every process name written in the current publication
+    QHash<QString, quint32> m_processOffsets;
+
+    bool storeString(const QString &text, quint32 &offset);
+};
+
+/**
+ * @brief Reader side: copies a consistent view of the table from another process
+ *
+ * Link sharedwindowtable.cpp and Qt Core to use it. read() does not block the
+ * writer; it simply retries when it raced with an update.
+ */
+class SharedWindowTableReader
+{
+public:
+    struct Window
+    {
+        quint64 handle;
+        quint32 processId;
+        quint32 flags;
+        QString processName;
+        QString title;
+    };
+
+    struct Snapshot
+    {
+        std::vector<Window> windows;
+        quint64 foreground = 0;
+        qint64 publishedMs = 0;
+        bool truncated = false;
+    };
+
+    /**
+     * @brief Attach to the table of the running instance
+     * @param nativeKey Region name, see SharedWindowTable::create()
+     * @return false if WinSelector is not running or does not publish the table
+     */
+    bool attach(const QString &nativeKey = SharedWindowTableLayout::key());
+
+    /**
+     * @brief Copy the current table
+     * @param snapshot Receives the table
+     * @param maxAttempts Number of copies tried while the writer is busy
+     * @return false if no consistent copy was obtained
+     */
+    bool read(Snapshot &snapshot, int maxAttempts = 64);
+
+    /**
+     * @brief Copy a table from a raw region laid out as SharedWindowTableLayout
+     *
+     * Used by read(); exposed so the protocol can be exercised on plain memory.
+     */
+    static bool readFrom(const void *region, Snapshot &snapshot, int maxAttempts,
+                         std::vector<SharedWindowTableLayout::Row> &rows, std::vector<char16_t> &strings);
+
+private:
+    QSharedMemory m_memory;
+    // Copy buffers, reused across reads
+    std::vector<SharedWindowTableLayout::Row> m_rows;
+    std::vector<char16_t> m_strings;
+};
+
+#endif // SHAREDWINDOWTABLE_H
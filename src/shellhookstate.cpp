@@ -0,0 +1,169 @@
+#include "shellhookstate.h"
+
+ShellHook::Event ShellHook::decode(quint32 code, quintptr handle)
+{
+    Event event;
+    event.handle = handle;
+    switch (code)
+    {
+    case WindowActivated:
+    case RudeAppActivated:
+        event.type = EventType::Activated;
+        break;
+    case Flash:
+        event.type = EventType::Flash;
+        break;
+    case GetMinRect:
+        event.type = EventType::MinimizeChanged;
+        break;
+    case WindowCreated:
+        event.type = EventType::Created;
+        break;
+    case WindowDestroyed:
+        event.type = EventType::Destroyed;
+        break;
+    case WindowReplacing:
+        event.type = EventType::Replacing;
+        break;
+    case WindowReplaced:
+        event.type = EventType::Replaced;
+        break;
+    default:
+        event.type = EventType::None;
+        break;
+    }
+    return event;
+}
+
+void ShellWindowState::apply(const ShellHook::Event &event, std::vector<quintptr> &changed)
+{
+    switch (event.type)
+    {
+    case ShellHook::EventType::Activated:
+        setForeground(event.handle, changed);
+        break;
+    case ShellHook::EventType::Flash:
+        // The shell also reports a flash for the window that already has the
+        // foreground; there is nothing to draw attention to in that case
+        if (event.handle != m_foreground)
+        {
+            update(event.handle, Flashing, 0, changed);
+        }
+        break;
+    case ShellHook::EventType::MinimizeChanged:
+        setMinimized(event.handle, event.minimized, changed);
+        break;
+    case ShellHook::EventType::Created:
+    case ShellHook::EventType::Destroyed:
+        // A new window must not inherit the state of an earlier window with
+        // the same (reused) handle. The caller still counts the flags of a
+        // destroyed window, e.g. in its group, until it is reported as changed.
+        update(event.handle, 0, Active | Flashing | Minimized, changed);
+        forget(event.handle);
+        break;
+    case ShellHook::EventType::Replacing:
+    case ShellHook::EventType::Replaced:
+        if (m_pendingReplace != ShellHook::EventType::None && m_pendingReplace != event.type)
+        {
+            if (event.type == ShellHook::EventType::Replaced)
+            {
+                replace(event.handle, m_pendingReplaceHandle, changed);
+            }
+            else
+            {
+                replace(m_pendingReplaceHandle, event.handle, changed);
+            }
+            m_pendingReplace = ShellHook::EventType::None;
+            m_pendingReplaceHandle = 0;
+        }
+        else
+        {
+            m_pendingReplace = event.type;
+            m_pendingReplaceHandle = event.handle;
+        }
+        break;
+    case ShellHook::EventType::None:
+        break;
+    }
+}
+
+void ShellWindowState::replace(quintptr replaced, quintptr replacement, std::vector<quintptr> &changed)
+{
+    if (replaced == replacement)
+    {
+        return;
+    }
+    const quint8 moved = flags(replaced);
+    const bool wasForeground = replaced == m_foreground;
+    update(replaced, 0, Active | Flashing | Minimized, changed);
+    forget(replaced);
+    update(replacement, moved, 0, changed);
+    if (wasForeground)
+    {
+        m_foreground = replacement;
+    }
+}
+
+void ShellWindowState::setForeground(quintptr handle, std::vector<quintptr> &changed)
+{
+    if (handle == m_foreground)
+    {
+        return;
+    }
+    if (m_foreground)
+    {
+        update(m_foreground, 0, Active, changed);
+    }
+    m_foreground = handle;
+    if (handle)
+    {
+        // Activating a window answers its attention request and restores it
+        update(handle, Active, Flashing | Minimized, changed);
+    }
+}
+
+void ShellWindowState::setMinimized(quintptr handle, bool minimized, std::vector<quintptr> &changed)
+{
+    if (minimized)
+    {
+        update(handle, Minimized, 0, changed);
+    }
+    else
+    {
+        update(handle, 0, Minimized, changed);
+    }
+}
+
+void ShellWindowState::forget(quintptr handle)
+{
+    m_flags.remove(handle);
+    if (handle == m_foreground)
+    {
+        m_foreground = 0;
+    }
+}
+
+void ShellWindowState::update(quintptr handle, quint8 set, quint8 clear, std::vector<quintptr> &changed)
+{
+    auto it = m_flags.find(handle);
+    const quint8 before = it != m_flags.end() ? it.value() : 0;
+    const quint8 after = static_cast<quint8>((before & ~clear) | set);
+    if (after == before)
+    {
+        return;
+    }
+
+    if (after == 0)
+    {
+        m_flags.erase(it);
+    }
+    else if (it != m_flags.end())
+    {
+        it.value() = after;
+    }
+    else
+    {
+        m_flags.insert(handle, after);
+    }
+    changed.push_back(handle);
+}
@@ -0,0 +1,135 @@
+#ifndef SHELLHOOKSTATE_H
+#define SHELLHOOKSTATE_H
+
+#include <QHash>
+#include <QtGlobal>
+#include <vector>
+
+/**
+ * @brief Decoding of shell hook notifications (RegisterShellHookWindow)
+ *
+ * The transport in MainWindow::nativeEvent() only extracts the notification code
+ * and window handle; everything else is plain data with no Win32 dependency.
+ */
+namespace ShellHook
+{
+    // Win32 values, repeated here so this header does not need <windows.h>
+    constexpr quint32 WindowCreated = 1;     // HSHELL_WINDOWCREATED
+    constexpr quint32 WindowDestroyed = 2;   // HSHELL_WINDOWDESTROYED
+    constexpr quint32 WindowActivated = 4;   // HSHELL_WINDOWACTIVATED
+    constexpr quint32 GetMinRect = 5;        // HSHELL_GETMINRECT (lParam is SHELLHOOKINFO *)
+    constexpr quint32 Redraw = 6;            // HSHELL_REDRAW
+    constexpr quint32 WindowReplaced = 13;   // HSHELL_WINDOWREPLACED (lParam is the replaced window)
+    constexpr quint32 WindowReplacing = 14;  // HSHELL_WINDOWREPLACING (lParam is the replacement)
+    constexpr quint32 HighBit = 0x8000;      // HSHELL_HIGHBIT
+    constexpr quint32 RudeAppActivated = WindowActivated | HighBit; // HSHELL_RUDEAPPACTIVATED
+    constexpr quint32 Flash = Redraw | HighBit;                      // HSHELL_FLASH
+
+    /**
+     * @brief Notification kinds the panel reacts to
+     */
+    enum class EventType
+    {
+        None,
+        Created,        ///< Top-level window was created
+        Activated,      ///< Window became the foreground window
+        Flash,          ///< Window requests attention
+        MinimizeChanged,///< Window is being minimized or restored
+        Destroyed,      ///< Window was destroyed
+        Replacing,      ///< Window takes the place of another one (e.g. the ghost of a hung window)
+        Replaced        ///< Window was replaced by the one reported with Replacing
+    };
+
+    /**
+     * @brief Decoded notification
+     */
+    struct Event
+    {
+        EventType type = EventType::None;
+        quintptr handle = 0;
+        bool minimized = false; ///< MinimizeChanged only; filled by the transport
+    };
+
+    /**
+     * @brief Decode a shell hook notification
+     * @param code wParam of the shell hook message
+     * @param handle Window the notification is about
+     * @return Decoded event; type is None for notifications the panel ignores
+     */
+    Event decode(quint32 code, quintptr handle);
+}
+
+/**
+ * @brief Per-window foreground / attention / minimized state driven by shell events
+ *
+ * Only windows with a non-default state are stored. apply() reports the windows
+ * whose state changed, so the caller restyles just those tiles and updates their
+ * group; a destroyed window is reported once more with no flags.
+ *
+ * When the shell replaces a window (Replacing and Replaced, in either order),
+ * the flags of the replaced window move to its replacement.
+ */
+class ShellWindowState
+{
+public:
+    enum Flag : quint8
+    {
+        Active = 0x1,
+        Flashing = 0x2,
+        Minimized = 0x4
+    };
+
+    /**
+     * @brief Apply a decoded event
+     * @param event Event to apply
+     * @param changed Receives the handles whose flags changed (appended)
+     */
+    void apply(const ShellHook::Event &event, std::vector<quintptr> &changed);
+
+    /**
+     * @brief Set the foreground window directly, e.g. from GetForegroundWindow()
+     * @param handle Foreground window
+     * @param changed Receives the handles whose flags changed (appended)
+     */
+    void setForeground(quintptr handle, std::vector<quintptr> &changed);
+
+    /**
+     * @brief Set the minimized state of a window directly
+     * @param handle Window handle
+     * @param minimized true if the window is minimized
+     * @param changed Receives the handles whose flags changed (appended)
+     */
+    void setMinimized(quintptr handle, bool minimized, std::vector<quintptr> &changed);
+
+    /**
+     * @brief Drop all state of a window
+     * @param handle Window handle
+     */
+    void forget(quintptr handle);
+
+    /**
+     * @brief Get the flags of a window
+     * @param handle Window handle
+     * @return Combination of Flag values
+     */
+    quint8 flags(quintptr handle) const { return m_flags.value(handle, 0); }
+
+    /**
+     * @brief Get the current foreground window
+     * @return Handle, or 0 if unknown
+     */
+    quintptr foreground() const { return m_foreground; }
+
+private:
+    QHash<quintptr, quint8> m_flags;
+    quintptr m_foreground = 0;
+    // Half of a Replacing/Replaced pair waiting for the other half
+    ShellHook::EventType m_pendingReplace = ShellHook::EventType::None;
+    quintptr m_pendingReplaceHandle = 0;
+
+    void replace(quintptr replaced, quintptr replacement, std::vector<quintptr> &changed);
+
+    void update(quintptr handle, quint8 set, quint8 clear, std::vector<quintptr> &changed);
+};
+
+#endif // SHELLHOOKSTATE_H
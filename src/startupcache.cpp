@@ -0,0 +1,137 @@
+#include "startupcache.h"
+#include <QDataStream>
+#include <QFile>
+#include <QHash>
+#include <QSaveFile>
+#include <algorithm>
+
+namespace
+{
+    constexpr quint32 FileMagic = 0x57535343; // "WSSC"
+    constexpr quint16 FileVersion = 1;
+    constexpr quint32 NoIconIndex = 0xFFFFFFFF;
+}
+
+bool StartupCache::load(const QString &path, std::vector<Entry> &entries)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    quint32 iconCount = 0;
+    in >> magic >> version >> iconCount;
+    if (magic != FileMagic || version != FileVersion || iconCount > MaxEntries)
+    {
+        return false;
+    }
+
+    std::vector<QImage> icons;
+    icons.reserve(iconCount);
+    for (quint32 i = 0; i < iconCount && in.status() == QDataStream::Ok; ++i)
+    {
+        quint16 width = 0;
+        quint16 height = 0;
+        in >> width >> height;
+        if (width > MaxIconSide || height > MaxIconSide)
+        {
+            return false;
+        }
+        QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+        const int bytes = width * height * 4;
+        if (bytes > 0 && in.readRawData(reinterpret_cast<char *>(image.bits()), bytes) != bytes)
+        {
+            return false;
+        }
+        icons.push_back(std::move(image));
+    }
+
+    quint32 count = 0;
+    in >> count;
+    if (count > MaxEntries)
+    {
+        return false;
+    }
+    entries.clear();
+    entries.reserve(count);
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+    {
+        Entry entry;
+        quint64 handle = 0;
+        quint32 iconIndex = NoIconIndex;
+        in >> handle >> entry.processId >> entry.processName >> entry.title >> iconIndex;
+        entry.handle = static_cast<quintptr>(handle);
+        if (iconIndex < icons.size())
+        {
+            entry.icon = icons[iconIndex];
+        }
+        entries.push_back(std::move(entry));
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+bool StartupCache::save(const QString &path, const std::vector<Entry> &entries)
+{
+    const size_t count = std::min<size_t>(entries.size(), MaxEntries);
+
+    // One icon per process; windows of a process nearly always share it
+    QHash<QString, quint32> iconIndexes;
+    std::vector<QImage> icons;
+    std::vector<quint32> entryIcons(count, NoIconIndex);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Entry &entry = entries[i];
+        if (entry.icon.isNull() || entry.icon.width() > MaxIconSide || entry.icon.height() > MaxIconSide)
+        {
+            continue;
+        }
+        auto it = iconIndexes.constFind(entry.processName);
+        if (it == iconIndexes.constEnd())
+        {
+            it = iconIndexes.insert(entry.processName, static_cast<quint32>(icons.size()));
+            icons.push_back(entry.icon.convertToFormat(QImage::Format_ARGB32_Premultiplied));
+        }
+        entryIcons[i] = it.value();
+    }
+    // Windows saved without an icon (never shown) get the one of their process
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (entryIcons[i] == NoIconIndex)
+        {
+            entryIcons[i] = iconIndexes.value(entries[i].processName, NoIconIndex);
+        }
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << FileMagic << FileVersion << static_cast<quint32>(icons.size());
+    for (const QImage &icon : icons)
+    {
+        out << static_cast<quint16>(icon.width()) << static_cast<quint16>(icon.height());
+        // Row by row; scan lines may be padded
+        for (int y = 0; y < icon.height(); ++y)
+        {
+            out.writeRawData(reinterpret_cast<const char *>(icon.constScanLine(y)), icon.width() * 4);
+        }
+    }
+
+    out << static_cast<quint32>(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Entry &entry = entries[i];
+        out << static_cast<quint64>(entry.handle) << entry.processId << entry.processName << entry.title
+            << entryIcons[i];
+    }
+    return out.status() == QDataStream::Ok && file.commit();
+}
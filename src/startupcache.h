@@ -0,0 +1,53 @@
+#ifndef STARTUPCACHE_H
+#define STARTUPCACHE_H
+
+#include <QImage>
+#include <QString>
+#include <QtGlobal>
+#include <vector>
+
+/**
+ * @brief Window list saved at exit so the next start can paint before scanning
+ *
+ * Each entry keeps what a tile shows: handle, process, title and icon. Icons are
+ * stored once per process as raw ARGB32 pixels, which load with a copy instead
+ * of an image decoder; an entry without an icon shares the one of its process.
+ * The caller must check that a handle still belongs to the same process
+ * before using an entry, because handles are reused.
+ *
+ * The class has no Win32 dependency.
+ */
+class StartupCache
+{
+public:
+    struct Entry
+    {
+        quintptr handle = 0;
+        quint32 processId = 0;
+        QString processName;
+        QString title;
+        QImage icon;
+    };
+
+    /**
+     * @brief Read a cache file
+     * @param path File written by save()
+     * @param entries Receives the entries in panel order
+     * @return false if the file is missing or invalid
+     */
+    static bool load(const QString &path, std::vector<Entry> &entries);
+
+    /**
+     * @brief Write a cache file, keeping at most MaxEntries entries
+     * @param path Destination file
+     * @param entries Entries in panel order
+     * @return false on I/O error
+     */
+    static bool save(const QString &path, const std::vector<Entry> &entries);
+
+private:
+    static constexpr int MaxEntries = 512;
+    static constexpr int MaxIconSide = 256;
+};
+
+#endif // STARTUPCACHE_H
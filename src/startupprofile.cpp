@@ -0,0 +1,54 @@
+#include "startupprofile.h"
+#include <QDebug>
+#include <QElapsedTimer>
+
+namespace
+{
+    struct Phase
+    {
+        const char *name;
+        qint64 elapsedNs;
+    };
+
+    constexpr int MaxPhases = 16;
+
+    // Startup runs on the GUI thread only
+    QElapsedTimer s_clock;
+    Phase s_phases[MaxPhases];
+    int s_phaseCount = 0;
+    bool s_reported = false;
+}
+
+void StartupProfile::start()
+{
+    s_clock.start();
+    s_phaseCount = 0;
+    s_reported = false;
+}
+
+void StartupProfile::mark(const char *phase)
+{
+    if (!s_clock.isValid() || s_reported || s_phaseCount == MaxPhases)
+    {
+        return;
+    }
+    s_phases[s_phaseCount++] = Phase{phase, s_clock.nsecsElapsed()};
+}
+
+void StartupProfile::report()
+{
+    if (s_reported || s_phaseCount == 0)
+    {
+        return;
+    }
+    s_reported = true;
+
+    qint64 previous = 0;
+    for (int i = 0; i < s_phaseCount; ++i)
+    {
+        qDebug().nospace() << "Startup " << s_phases[i].name << " at "
+                           << QString::number(s_phases[i].elapsedNs / 1e6, 'f', 1) << " ms (+"
+                           << QString::number((s_phases[i].elapsedNs - previous) / 1e6, 'f', 1) << " ms)";
+        previous = s_phases[i].elapsedNs;
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef STARTUPPROFILE_H
+#define STARTUPPROFILE_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Timestamps of the startup phases, logged once startup is complete
+ *
+ * start() is called first thing in main(); every later mark() records the time
+ * since then under a phase name. report() logs the list once.
+ */
+class StartupProfile
+{
+public:
+    /**
+     * @brief Start the clock
+     */
+    static void start();
+
+    /**
+     * @brief Record the end of a phase
+     * @param phase Phase name; must be a string literal
+     */
+    static void mark(const char *phase);
+
+    /**
+     * @brief Log every recorded phase with its timestamp and duration
+     */
+    static void report();
+};
+
+#endif // STARTUPPROFILE_H
@@ -0,0 +1,12 @@
+#include "thumbnailcache.h"
+
+ThumbnailCache::ThumbnailCache(qsizetype maxBytes)
+    : m_cache(maxBytes)
+{
+}
+
+bool ThumbnailCache::insert(quintptr handle, const QImage &image, qint64 capturedMs)
+{
+    // QCache deletes the object itself when it cannot be stored
+    return m_cache.insert(handle, new Thumbnail{image, capturedMs}, qMax<qsizetype>(1, image.sizeInBytes()));
+}
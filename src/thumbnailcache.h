@@ -0,0 +1,80 @@
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <QCache>
+#include <QImage>
+#include <QtGlobal>
+
+/**
+ * @brief Least-recently-used store of window thumbnails, bounded by image bytes
+ *
+ * Every thumbnail carries the time it was captured so the caller can show a
+ * stale image right away while a fresh capture is on its way. Inserting beyond
+ * the byte limit evicts the thumbnails that were looked up longest ago.
+ *
+ * Not thread-safe; used on the GUI thread only. The class has no Win32 dependency.
+ */
+class ThumbnailCache
+{
+public:
+    struct Thumbnail
+    {
+        QImage image;
+        qint64 capturedMs = 0; ///< Capture time on the owner's clock
+    };
+
+    /**
+     * @brief Construct an empty cache
+     * @param maxBytes Maximum total size of the cached images
+     */
+    explicit ThumbnailCache(qsizetype maxBytes);
+
+    /**
+     * @brief Change the byte limit, evicting thumbnails if needed
+     * @param maxBytes Maximum total size of the cached images
+     */
+    void setMaxBytes(qsizetype maxBytes) { m_cache.setMaxCost(maxBytes); }
+
+    /**
+     * @brief Look up a thumbnail and mark it as most recently used
+     * @param handle Window handle
+     * @return Thumbnail, or nullptr; valid until the next insert() or remove()
+     */
+    const Thumbnail *find(quintptr handle) { return m_cache.object(handle); }
+
+    /**
+     * @brief Store a thumbnail, replacing any previous one of the window
+     * @param handle Window handle
+     * @param image Downscaled image
+     * @param capturedMs Capture time on the owner's clock
+     * @return false if the image alone exceeds the byte limit (it is not stored)
+     */
+    bool insert(quintptr handle, const QImage &image, qint64 capturedMs);
+
+    /**
+     * @brief Drop the thumbnail of a window
+     * @param handle Window handle
+     */
+    void remove(quintptr handle) { m_cache.remove(handle); }
+
+    /**
+     * @brief Check whether a thumbnail is older than a maximum age
+     * @param thumbnail Thumbnail to check
+     * @param nowMs Current time on the owner's clock
+     * @param maxAgeMs Maximum age; 0 means thumbnails never go stale
+     * @return true if it should be captured again
+     */
+    static bool isStale(const Thumbnail &thumbnail, qint64 nowMs, qint64 maxAgeMs)
+    {
+        return maxAgeMs > 0 && nowMs - thumbnail.capturedMs > maxAgeMs;
+    }
+
+    qsizetype bytes() const { return m_cache.totalCost(); }
+    qsizetype maxBytes() const { return m_cache.maxCost(); }
+    qsizetype count() const { return m_cache.count(); }
+
+private:
+    QCache<quintptr, Thumbnail> m_cache;
+};
+
+#endif // THUMBNAILCACHE_H
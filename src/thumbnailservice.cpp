@@ -0,0 +1,175 @@
+#include "thumbnailservice.h"
+#include <QDebug>
+#include <QMetaObject>
+#include <QMutexLocker>
+
+namespace
+{
+    // Average 2x2 blocks of 32-bit pixels. The channels are summed in two
+    // halves (blue/red and green/alpha) with 16 bits per channel, so four
+    // pixels are added without overflow in two integer operations each.
+    QImage halve(const QImage &source)
+    {
+        const int width = source.width() / 2;
+        const int height = source.height() / 2;
+        QImage result(width, height, source.format());
+        for (int y = 0; y < height; ++y)
+        {
+            const quint32 *row0 = reinterpret_cast<const quint32 *>(source.constScanLine(2 * y));
+            const quint32 *row1 = reinterpret_cast<const quint32 *>(source.constScanLine(2 * y + 1));
+            quint32 *out = reinterpret_cast<quint32 *>(result.scanLine(y));
+            for (int x = 0; x < width; ++x)
+            {
+                const quint32 p0 = row0[2 * x];
+                const quint32 p1 = row0[2 * x + 1];
+                const quint32 p2 = row1[2 * x];
+                const quint32 p3 = row1[2 * x + 1];
+                const quint32 lo = (p0 & 0x00ff00ffu) + (p1 & 0x00ff00ffu) + (p2 & 0x00ff00ffu) +
+                                   (p3 & 0x00ff00ffu) + 0x00020002u;
+                const quint32 hi = ((p0 >> 8) & 0x00ff00ffu) + ((p1 >> 8) & 0x00ff00ffu) +
+                                   ((p2 >> 8) & 0x00ff00ffu) + ((p3 >> 8) & 0x00ff00ffu) + 0x00020002u;
+                out[x] = ((lo >> 2) & 0x00ff00ffu) | (((hi >> 2) & 0x00ff00ffu) << 8);
+            }
+        }
+        return result;
+    }
+}
+
+ThumbnailService::ThumbnailService(std::unique_ptr<ThumbnailSource> source, int maxSide, qsizetype cacheBytes,
+                                   QObject *parent)
+    : QObject(parent), m_source(std::move(source)), m_maxSide(maxSide), m_cache(cacheBytes)
+{
+    m_pool.setMaxThreadCount(2);
+    m_pool.setObjectName("ThumbnailService");
+    m_clock.start();
+}
+
+ThumbnailService::~ThumbnailService()
+{
+    // Queued captures are dropped; results of running ones are posted to an
+    // object that no longer exists and discarded
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+QImage ThumbnailService::thumbnail(quintptr handle)
+{
+    const ThumbnailCache::Thumbnail *cached = m_cache.find(handle);
+    return cached ? cached->image : QImage();
+}
+
+void ThumbnailService::request(quintptr handle, qint64 maxAgeMs)
+{
+    QMutexLocker locker(&m_metricsMutex);
+    ++m_metrics.requests;
+
+    const ThumbnailCache::Thumbnail *cached = m_cache.find(handle);
+    if (cached && !ThumbnailCache::isStale(*cached, m_clock.elapsed(), maxAgeMs))
+    {
+        ++m_metrics.hits;
+        return;
+    }
+    if (m_inFlight.contains(handle))
+    {
+        return;
+    }
+    if (m_inFlight.size() >= MaxInFlight)
+    {
+        ++m_metrics.dropped;
+        return;
+    }
+
+    m_inFlight.insert(handle);
+    m_pool.start([this, handle]() { run(handle); });
+}
+
+void ThumbnailService::forget(quintptr handle)
+{
+    // A capture still in flight is stored when it finishes and ages out
+    m_cache.remove(handle);
+}
+
+void ThumbnailService::run(quintptr handle)
+{
+    QElapsedTimer timer;
+    timer.start();
+    const qint64 capturedMs = m_clock.elapsed();
+
+    QImage image = m_source->capture(handle);
+    const qint64 captureNs = timer.nsecsElapsed();
+    if (!image.isNull())
+    {
+        image = downscale(image, m_maxSide);
+    }
+    const qint64 downscaleNs = timer.nsecsElapsed() - captureNs;
+
+    {
+        QMutexLocker locker(&m_metricsMutex);
+        m_metrics.captureNs += captureNs;
+        m_metrics.downscaleNs += downscaleNs;
+    }
+
+    QMetaObject::invokeMethod(this, [this, handle, image, capturedMs]()
+                              { finish(handle, image, capturedMs); },
+                              Qt::QueuedConnection);
+}
+
+void ThumbnailService::finish(quintptr handle, const QImage &image, qint64 capturedMs)
+{
+    m_inFlight.remove(handle);
+    {
+        QMutexLocker locker(&m_metricsMutex);
+        ++(image.isNull() ? m_metrics.failures : m_metrics.captures);
+    }
+    if (image.isNull() || !m_cache.insert(handle, image, capturedMs))
+    {
+        return;
+    }
+    emit thumbnailReady(handle);
+}
+
+ThumbnailService::Metrics ThumbnailService::metrics() const
+{
+    QMutexLocker locker(&m_metricsMutex);
+    return m_metrics;
+}
+
+void ThumbnailService::report() const
+{
+    const Metrics m = metrics();
+    if (m.requests == 0)
+    {
+        return;
+    }
+    const quint64 attempts = qMax<quint64>(1, m.captures + m.failures);
+    qDebug() << "Thumbnails:" << m.requests << "requests," << m.hits << "cache hits," << m.dropped << "dropped,"
+             << m.captures << "captures," << m.failures << "failed";
+    qDebug() << "Thumbnails: average capture" << m.captureNs / attempts / 1000 << "us, downscale"
+             << m.downscaleNs / attempts / 1000 << "us; cache" << m_cache.count() << "thumbnails,"
+             << m_cache.bytes() << "of" << m_cache.maxBytes() << "bytes";
+}
+
+QImage ThumbnailService::downscale(const QImage &image, int maxSide)
+{
+    if (image.width() <= maxSide && image.height() <= maxSide)
+    {
+        return image;
+    }
+
+    // The box filter averages channels as stored, which is only right without
+    // alpha or with premultiplied alpha
+    QImage result = image;
+    if (result.format() != QImage::Format_RGB32 && result.format() != QImage::Format_ARGB32_Premultiplied)
+    {
+        result = result.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+    while (result.width() >= 2 * maxSide || result.height() >= 2 * maxSide)
+    {
+        if (result.width() < 2 || result.height() < 2)
+        {
+            break;
+        }
+        result = halve(result);
+    }
+    return result.scaled(maxSide, maxSide, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+}
@@ -0,0 +1,152 @@
+#ifndef THUMBNAILSERVICE_H
+#define THUMBNAILSERVICE_H
+
+#include "thumbnailcache.h"
+#include "thumbnailsource.h"
+#include <QElapsedTimer>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QThreadPool>
+#include <memory>
+
+/**
+ * @brief Captures window thumbnails on a thread pool and keeps them in a ThumbnailCache
+ *
+ * request() only queues work: the capture and the downscale both run on worker
+ * threads, and the result is handed back to the GUI thread, cached and announced
+ * with thumbnailReady(). A window is never captured twice at the same time, and
+ * at most MaxInFlight captures are outstanding; further requests are dropped,
+ * since only the window under the mouse matters.
+ *
+ * The class has no Win32 dependency; the window capture itself sits behind
+ * ThumbnailSource.
+ */
+class ThumbnailService : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int MaxInFlight = 4;
+    static constexpr int DefaultMaxSide = 320;
+
+    /**
+     * @brief Counters since construction
+     */
+    struct Metrics
+    {
+        quint64 requests = 0;
+        quint64 hits = 0;          ///< Fresh thumbnail already cached
+        quint64 dropped = 0;       ///< Too many captures outstanding
+        quint64 captures = 0;      ///< Finished captures that produced an image
+        quint64 failures = 0;      ///< Captures that produced nothing
+        qint64 captureNs = 0;      ///< Total time in ThumbnailSource::capture()
+        qint64 downscaleNs = 0;    ///< Total time in downscale()
+    };
+
+    /**
+     * @brief Construct the service
+     * @param source Capture source, used from the worker threads
+     * @param maxSide Longest side of a thumbnail in pixels
+     * @param cacheBytes Byte limit of the thumbnail cache
+     * @param parent Parent object
+     */
+    ThumbnailService(std::unique_ptr<ThumbnailSource> source, int maxSide, qsizetype cacheBytes,
+                     QObject *parent = nullptr);
+
+    /**
+     * @brief Wait for running captures and stop the workers
+     */
+    ~ThumbnailService();
+
+    /**
+     * @brief Get the cached thumbnail of a window, even if stale
+     * @param handle Window handle
+     * @return Thumbnail, or a null image
+     */
+    QImage thumbnail(quintptr handle);
+
+    /**
+     * @brief Capture a window unless a fresh thumbnail is cached; returns immediately
+     * @param handle Window handle
+     * @param maxAgeMs Age after which a cached thumbnail is captured again; 0 = never
+     */
+    void request(quintptr handle, qint64 maxAgeMs);
+
+    /**
+     * @brief Drop the thumbnail of a closed window
+     * @param handle Window handle
+     */
+    void forget(quintptr handle);
+
+    /**
+     * @brief Change the byte limit of the cache
+     * @param cacheBytes Maximum total size of the cached thumbnails
+     */
+    void setCacheBytes(qsizetype cacheBytes) { m_cache.setMaxBytes(cacheBytes); }
+
+    /**
+     * @brief Get the number of captures queued or running
+     * @return Outstanding captures
+     */
+    int inFlight() const { return m_inFlight.size(); }
+
+    const ThumbnailCache &cache() const { return m_cache; }
+
+    /**
+     * @brief Get a copy of the counters
+     * @return Metrics
+     */
+    Metrics metrics() const;
+
+    /**
+     * @brief Log the counters and the cache use
+     */
+    void report() const;
+
+    /**
+     * @brief Shrink an image to fit a square box, keeping the aspect ratio
+     *
+     * Halves the image with a 2x2 box filter (four pixels averaged per channel
+     * in two 32-bit operations) while it is at least twice the target size, then
+     * finishes with one smooth scale of the much smaller image.
+     * @param image Source image; converted to premultiplied ARGB32 unless it is RGB32 already
+     * @param maxSide Longest side of the result
+     * @return Downscaled image; the source itself if it already fits
+     */
+    static QImage downscale(const QImage &image, int maxSide);
+
+signals:
+    /**
+     * @brief Emitted on the GUI thread when a new thumbnail was cached
+     * @param handle Window handle
+     */
+    void thumbnailReady(quintptr handle);
+
+private:
+    std::unique_ptr<ThumbnailSource> m_source;
+    const int m_maxSide;
+    QThreadPool m_pool;
+    QElapsedTimer m_clock;
+    ThumbnailCache m_cache;
+    QSet<quintptr> m_inFlight;
+    mutable QMutex m_metricsMutex; ///< Guards m_metrics; workers add their timings
+    Metrics m_metrics;
+
+    /**
+     * @brief Capture and downscale one window (worker thread)
+     * @param handle Window handle
+     */
+    void run(quintptr handle);
+
+    /**
+     * @brief Store a finished capture (GUI thread)
+     * @param handle Window handle
+     * @param image Downscaled image, or a null image if the capture failed
+     * @param capturedMs Time the capture started
+     */
+    void finish(quintptr handle, const QImage &image, qint64 capturedMs);
+};
+
+#endif // THUMBNAILSERVICE_H
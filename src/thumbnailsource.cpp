@@ -0,0 +1,28 @@
+#include "thumbnailsource.h"
+
+SyntheticThumbnailSource::SyntheticThumbnailSource(const QSize &size)
+    : m_size(size), m_captures(0)
+{
+}
+
+QImage SyntheticThumbnailSource::capture(quintptr handle)
+{
+    const quint32 seed = static_cast<quint32>(handle) * 2654435761u + static_cast<quint32>(m_captures++);
+
+    // Horizontal and vertical gradients tinted by the seed; every pixel is
+    // written, so the cost resembles copying a real window bitmap
+    QImage image(m_size, QImage::Format_RGB32);
+    const int width = image.width();
+    const int height = image.height();
+    for (int y = 0; y < height; ++y)
+    {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        const int green = (y * 255 / qMax(1, height - 1)) ^ ((seed >> 8) & 0xff);
+        for (int x = 0; x < width; ++x)
+        {
+            const int red = (x * 255 / qMax(1, width - 1)) ^ (seed & 0xff);
+            line[x] = qRgb(red, green, (seed >> 16) & 0xff);
+        }
+    }
+    return image;
+}
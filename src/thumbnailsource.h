@@ -0,0 +1,57 @@
+#ifndef THUMBNAILSOURCE_H
+#define THUMBNAILSOURCE_H
+
+#include <QAtomicInteger>
+#include <QImage>
+#include <QSize>
+#include <QtGlobal>
+
+/**
+ * @brief Produces full-size window images for the ThumbnailService
+ *
+ * capture() is only ever called on the service's worker threads, possibly on
+ * several at once, so implementations must be thread-safe.
+ */
+class ThumbnailSource
+{
+public:
+    virtual ~ThumbnailSource() = default;
+
+    /**
+     * @brief Capture the current contents of a window
+     * @param handle Window handle
+     * @return Image in a 32-bit RGB format, or a null image if nothing can be captured
+     */
+    virtual QImage capture(quintptr handle) = 0;
+};
+
+/**
+ * @brief Capture source that draws a generated image instead of reading a window
+ *
+ * Lets the capture pipeline (worker threads, downscaling, cache bounds) run and
+ * be measured without any window system. The image depends on the handle and a
+ * per-capture counter, so successive captures differ.
+ */
+class SyntheticThumbnailSource : public ThumbnailSource
+{
+public:
+    /**
+     * @brief Construct a source producing images of one size
+     * @param size Size of every captured image
+     */
+    explicit SyntheticThumbnailSource(const QSize &size);
+
+    QImage capture(quintptr handle) override;
+
+    /**
+     * @brief Get the number of captures so far
+     * @return Capture count
+     */
+    quint64 captureCount() const { return m_captures.loadRelaxed(); }
+
+private:
+    QSize m_size;
+    QAtomicInteger<quint64> m_captures;
+};
+
+#endif // THUMBNAILSOURCE_H
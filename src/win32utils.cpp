@@ -1,15 +1,42 @@
 #include "win32utils.h"
 #include "config.h"
+#include "lazyfieldstats.h"
+#include "shellhookstate.h"
 #include <Psapi.h>
+#include <dwmapi.h>
 #include <QDebug>
 #include <QImage>
 #include <QPixmap>
-#include <QMap>
+#include <QHash>
 #include <QFile>
-#include <vector>
+#include <QDeadlineTimer>
+#include <cstdio>
 
-// Static icon cache to avoid repeated icon fetching
-static QMap<HWND, QIcon> s_iconCache;
+// Static icon cache to avoid repeated icon fetching. Windows map to an icon ID
+// and the icons themselves are stored once per ID. An ID is handed out without
+// touching the window; the icon is only fetched when someone asks for it.
+struct IconEntry
+{
+    HWND hwnd = nullptr;
+    bool resolved = false;
+    QIcon icon;
+};
+static QHash<HWND, Win32Utils::IconId> s_iconCache;
+static QHash<Win32Utils::IconId, IconEntry> s_icons;
+static Win32Utils::IconId s_nextIconId = Win32Utils::NoIcon + 1;
+static quint64 s_iconCacheGeneration = 0;
+
+// Windows whose WM_GETICON timed out are not messaged again until their
+// backoff expires. The backoff doubles on every further timeout.
+struct HungWindowState
+{
+    QDeadlineTimer retryAt;
+    int backoffMs = 0;
+};
+static QHash<HWND, HungWindowState> s_hungWindows;
+static constexpr int HungWindowInitialBackoffMs = 5000;
+static constexpr int HungWindowMaxBackoffMs = 5 * 60 * 1000;
+static constexpr int IconMessageTimeoutMs = 200;
 
 void Win32Utils::logWin32Error(const QString &functionName)
 {
@@ -115,17 +142,50 @@ QString Win32Utils::getProcessPath(DWORD processId)
     return processPath;
 }
 
+bool Win32Utils::isWindowUnresponsive(HWND hwnd)
+{
+    auto it = s_hungWindows.constFind(hwnd);
+    if (it != s_hungWindows.constEnd() && !it->retryAt.hasExpired())
+    {
+        return true;
+    }
+    // Cheap check that does not send a message to the window
+    return IsHungAppWindow(hwnd);
+}
+
+void Win32Utils::quarantineWindow(HWND hwnd)
+{
+    HungWindowState &state = s_hungWindows[hwnd];
+    state.backoffMs = state.backoffMs == 0 ? HungWindowInitialBackoffMs
+                                           : qMin(state.backoffMs * 2, HungWindowMaxBackoffMs);
+    state.retryAt = QDeadlineTimer(state.backoffMs);
+    qWarning() << "Window" << hwnd << "did not respond; not messaging it for" << state.backoffMs << "ms";
+}
+
 HICON Win32Utils::tryGetIconViaMessage(HWND hwnd, WPARAM iconType)
 {
+    // Never wait on a window that is known or detected to be hung
+    if (isWindowUnresponsive(hwnd))
+    {
+        return nullptr;
+    }
+
     DWORD_PTR result = 0;
     // Use SendMessageTimeout to avoid freezing when the target window is unresponsive
     // SMTO_ABORTIFHUNG: Returns immediately if the target window is hung
     // SMTO_BLOCK: Prevents the calling thread from processing other requests while waiting
     if (SendMessageTimeout(hwnd, WM_GETICON, iconType, 0,
-                          SMTO_ABORTIFHUNG | SMTO_BLOCK, 200, &result))
+                          SMTO_ABORTIFHUNG | SMTO_BLOCK, IconMessageTimeoutMs, &result))
     {
+        // The window answered, so any earlier backoff is over
+        s_hungWindows.remove(hwnd);
         return (HICON)result;
     }
+
+    if (GetLastError() == ERROR_TIMEOUT)
+    {
+        quarantineWindow(hwnd);
+    }
     return nullptr;
 }
 
@@ -151,17 +211,168 @@ QIcon Win32Utils::convertHIconToQIcon(HICON hIcon)
 }
 
 QIcon Win32Utils::getWindowIcon(HWND hwnd)
+{
+    return iconById(getWindowIconId(hwnd));
+}
+
+Win32Utils::IconId Win32Utils::getWindowIconId(HWND hwnd)
 {
     if (!isValidWindow(hwnd))
     {
         qWarning() << "getWindowIcon: Invalid window handle";
-        return QIcon();
+        return NoIcon;
     }
 
     // Check cache first
-    if (s_iconCache.contains(hwnd))
+    auto cached = s_iconCache.constFind(hwnd);
+    if (cached != s_iconCache.constEnd())
+    {
+        return cached.value();
+    }
+
+    // Reserve an ID; the icon itself is fetched by iconById() on first use
+    const IconId id = s_nextIconId++;
+    IconEntry entry;
+    entry.hwnd = hwnd;
+    s_icons.insert(id, entry);
+    s_iconCache.insert(hwnd, id);
+    LazyFieldStats::deferred(LazyFieldStats::Field::Icon);
+
+    return id;
+}
+
+QIcon Win32Utils::iconById(IconId id)
+{
+    auto it = s_icons.find(id);
+    if (it == s_icons.end())
+    {
+        return QIcon();
+    }
+
+    if (!it->resolved)
+    {
+        // Cache the result (even if empty)
+        it->icon = fetchWindowIcon(it->hwnd);
+        it->resolved = true;
+        LazyFieldStats::requested(LazyFieldStats::Field::Icon);
+    }
+    return it->icon;
+}
+
+QIcon Win32Utils::resolvedIconById(IconId id)
+{
+    auto it = s_icons.constFind(id);
+    return it != s_icons.constEnd() && it->resolved ? it->icon : QIcon();
+}
+
+Win32Utils::IconId Win32Utils::seedWindowIcon(HWND hwnd, const QIcon &icon)
+{
+    auto cached = s_iconCache.constFind(hwnd);
+    if (cached != s_iconCache.constEnd())
+    {
+        return cached.value();
+    }
+
+    const IconId id = s_nextIconId++;
+    IconEntry entry;
+    entry.hwnd = hwnd;
+    entry.resolved = true;
+    entry.icon = icon;
+    s_icons.insert(id, entry);
+    s_iconCache.insert(hwnd, id);
+    return id;
+}
+
+DWORD Win32Utils::getWindowProcessId(HWND hwnd)
+{
+    DWORD processId = 0;
+    if (!GetWindowThreadProcessId(hwnd, &processId))
+    {
+        return 0;
+    }
+    return processId;
+}
+
+HMONITOR Win32Utils::getWindowMonitor(HWND hwnd)
+{
+    // A minimized window is parked off-screen; use its restored position
+    if (IsIconic(hwnd))
+    {
+        WINDOWPLACEMENT placement = {};
+        placement.length = sizeof(placement);
+        if (GetWindowPlacement(hwnd, &placement))
+        {
+            return MonitorFromRect(&placement.rcNormalPosition, MONITOR_DEFAULTTONEAREST);
+        }
+    }
+    return MonitorFromWindow(hwnd, MONITOR_DEFAULTTONEAREST);
+}
+
+QImage Win32Utils::captureWindow(HWND hwnd)
+{
+    // Not isWindowUnresponsive(): its backoff table belongs to the GUI thread
+    RECT rect;
+    if (!IsWindow(hwnd) || IsIconic(hwnd) || IsHungAppWindow(hwnd) || !GetWindowRect(hwnd, &rect))
+    {
+        return QImage();
+    }
+    const int width = rect.right - rect.left;
+    const int height = rect.bottom - rect.top;
+    if (width <= 0 || height <= 0)
+    {
+        return QImage();
+    }
+
+    BITMAPINFO bitmapInfo = {};
+    bitmapInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bitmapInfo.bmiHeader.biWidth = width;
+    bitmapInfo.bmiHeader.biHeight = -height; // Top-down rows, like QImage
+    bitmapInfo.bmiHeader.biPlanes = 1;
+    bitmapInfo.bmiHeader.biBitCount = 32;
+    bitmapInfo.bmiHeader.biCompression = BI_RGB;
+
+    HDC screenDc = GetDC(nullptr);
+    HDC memoryDc = CreateCompatibleDC(screenDc);
+    void *bits = nullptr;
+    HBITMAP bitmap = CreateDIBSection(screenDc, &bitmapInfo, DIB_RGB_COLORS, &bits, nullptr, 0);
+    QImage image;
+    if (bitmap)
+    {
+        HGDIOBJ previous = SelectObject(memoryDc, bitmap);
+#ifndef PW_RENDERFULLCONTENT
+#define PW_RENDERFULLCONTENT 0x00000002
+#endif
+        // PW_RENDERFULLCONTENT also captures DirectComposition content (browsers, UWP)
+        if (PrintWindow(hwnd, memoryDc, PW_RENDERFULLCONTENT))
+        {
+            GdiFlush();
+            image = QImage(static_cast<const uchar *>(bits), width, height, width * 4, QImage::Format_RGB32).copy();
+        }
+        SelectObject(memoryDc, previous);
+        DeleteObject(bitmap);
+    }
+    DeleteDC(memoryDc);
+    ReleaseDC(nullptr, screenDc);
+    return image;
+}
+
+QString Win32Utils::getMonitorDeviceName(HMONITOR monitor)
+{
+    MONITORINFOEXW info = {};
+    info.cbSize = sizeof(info);
+    if (!GetMonitorInfoW(monitor, &info))
+    {
+        logWin32Error("GetMonitorInfo");
+        return QString();
+    }
+    return QString::fromWCharArray(info.szDevice);
+}
+
+QIcon Win32Utils::fetchWindowIcon(HWND hwnd)
+{
+    if (!isValidWindow(hwnd))
     {
-        return s_iconCache.value(hwnd);
+        return QIcon();
     }
 
     // Try different methods to get the icon
@@ -179,12 +390,7 @@ QIcon Win32Utils::getWindowIcon(HWND hwnd)
         hIcon = tryGetIconViaClassLongPtr(hwnd, GCLP_HICONSM);
     }
 
-    QIcon icon = convertHIconToQIcon(hIcon);
-
-    // Cache the result (even if empty)
-    s_iconCache.insert(hwnd, icon);
-
-    return icon;
+    return convertHIconToQIcon(hIcon);
 }
 
 QString Win32Utils::getWindowTitle(HWND hwnd, bool *success)
@@ -200,11 +406,12 @@ QString Win32Utils::getWindowTitle(HWND hwnd, bool *success)
         return QString();
     }
 
-    // Use MAX_TITLE_LENGTH from config
+    // Use MAX_TITLE_LENGTH from config. Decode straight into the QString's own
+    // storage (which always has room for the terminator) instead of a temporary.
     int maxLen = WinSelectorConfig::WindowScanner::maxTitleLength();
-    std::vector<WCHAR> title(maxLen + 1, 0);
+    QString title(maxLen, Qt::Uninitialized);
 
-    int length = GetWindowTextW(hwnd, title.data(), maxLen + 1);
+    int length = GetWindowTextW(hwnd, reinterpret_cast<LPWSTR>(title.data()), maxLen + 1);
 
     if (length == 0)
     {
@@ -222,7 +429,48 @@ QString Win32Utils::getWindowTitle(HWND hwnd, bool *success)
         *success = true;
     }
 
-    return QString::fromWCharArray(title.data());
+    title.truncate(length);
+    return title;
+}
+
+int Win32Utils::getWindowTitle(HWND hwnd, WCHAR *buffer, int bufferLength)
+{
+    if (!buffer || bufferLength <= 0)
+    {
+        return 0;
+    }
+    buffer[0] = 0;
+
+    if (!isValidWindow(hwnd))
+    {
+        qWarning() << "getWindowTitle: Invalid window handle";
+        return 0;
+    }
+
+    int length = GetWindowTextW(hwnd, buffer, bufferLength);
+
+    if (length == 0)
+    {
+        DWORD error = GetLastError();
+        // Empty title is not necessarily an error
+        if (error != 0)
+        {
+            logWin32Error("GetWindowTextW", error);
+        }
+    }
+
+    return length;
+}
+
+quint32 Win32Utils::getWindowCloakedFlags(HWND hwnd)
+{
+    DWORD cloaked = 0;
+    if (FAILED(DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &cloaked, sizeof(cloaked))))
+    {
+        // Not available (e.g. composition disabled): treat as not cloaked
+        return 0;
+    }
+    return cloaked;
 }
 
 bool Win32Utils::activateWindow(HWND hwnd)
@@ -252,6 +500,64 @@ bool Win32Utils::activateWindow(HWND hwnd)
     return true;
 }
 
+bool Win32Utils::requestForeground(HWND hwnd, ActivationStrategy strategy)
+{
+    if (!isValidWindow(hwnd))
+    {
+        return false;
+    }
+
+    if (IsIconic(hwnd))
+    {
+        // Async: a hung window must not block the caller
+        ShowWindowAsync(hwnd, SW_RESTORE);
+    }
+
+    switch (strategy)
+    {
+    case ActivationStrategy::Direct:
+        return SetForegroundWindow(hwnd) != FALSE;
+
+    case ActivationStrategy::AltKeyUnlock:
+    {
+        // A key event generated by this process makes it the last one to have
+        // received input, which lifts the foreground lock
+        INPUT inputs[2] = {};
+        inputs[0].type = INPUT_KEYBOARD;
+        inputs[0].ki.wVk = VK_MENU;
+        inputs[1].type = INPUT_KEYBOARD;
+        inputs[1].ki.wVk = VK_MENU;
+        inputs[1].ki.dwFlags = KEYEVENTF_KEYUP;
+        if (SendInput(2, inputs, sizeof(INPUT)) != 2)
+        {
+            logWin32Error("SendInput(VK_MENU)");
+        }
+        return SetForegroundWindow(hwnd) != FALSE;
+    }
+
+    case ActivationStrategy::AttachInput:
+    {
+        const HWND foreground = GetForegroundWindow();
+        const DWORD foregroundThread = foreground ? GetWindowThreadProcessId(foreground, nullptr) : 0;
+        const DWORD currentThread = GetCurrentThreadId();
+        const bool attached = foregroundThread != 0 && foregroundThread != currentThread &&
+                              AttachThreadInput(currentThread, foregroundThread, TRUE);
+
+        BringWindowToTop(hwnd);
+        const bool result = SetForegroundWindow(hwnd) != FALSE;
+
+        if (attached)
+        {
+            AttachThreadInput(currentThread, foregroundThread, FALSE);
+        }
+        return result;
+    }
+
+    default:
+        return false;
+    }
+}
+
 bool Win32Utils::closeWindow(HWND hwnd)
 {
     if (!isValidWindow(hwnd))
@@ -270,6 +576,47 @@ bool Win32Utils::closeWindow(HWND hwnd)
     return true;
 }
 
+QList<HWND> Win32Utils::closeWindows(const QList<HWND> &windows)
+{
+    QList<HWND> posted;
+    posted.reserve(windows.size());
+    for (HWND hwnd : windows)
+    {
+        if (closeWindow(hwnd))
+        {
+            posted.append(hwnd);
+        }
+    }
+    return posted;
+}
+
+int Win32Utils::showWindows(const QList<HWND> &windows, ShowCommand command)
+{
+    const int showCommand = command == ShowCommand::Minimize ? SW_SHOWMINNOACTIVE : SW_SHOWNOACTIVATE;
+    int posted = 0;
+    for (HWND hwnd : windows)
+    {
+        if (!isValidWindow(hwnd))
+        {
+            continue;
+        }
+        // Restoring a window that is not minimized would only move it
+        if (command == ShowCommand::Restore && !IsIconic(hwnd))
+        {
+            continue;
+        }
+        if (ShowWindowAsync(hwnd, showCommand))
+        {
+            ++posted;
+        }
+        else
+        {
+            logWin32Error("ShowWindowAsync");
+        }
+    }
+    return posted;
+}
+
 bool Win32Utils::launchProcess(const QString &processPath)
 {
     if (processPath.isEmpty())
@@ -307,19 +654,100 @@ void Win32Utils::clearIconCache(HWND hwnd)
     {
         // Clear entire cache
         s_iconCache.clear();
+        s_icons.clear();
+
+        // Keep the backoff of live hung windows, forget destroyed ones
+        for (auto it = s_hungWindows.begin(); it != s_hungWindows.end();)
+        {
+            if (IsWindow(it.key()))
+            {
+                ++it;
+            }
+            else
+            {
+                it = s_hungWindows.erase(it);
+            }
+        }
+        ++s_iconCacheGeneration;
     }
     else
     {
-        // Clear specific window from cache
-        s_iconCache.remove(hwnd);
+        // Clear specific window from cache. Other windows keep their icon IDs, so
+        // the generation stays and the next scan does not look up every icon again.
+        s_icons.remove(s_iconCache.take(hwnd));
+        if (!IsWindow(hwnd))
+        {
+            s_hungWindows.remove(hwnd);
+        }
     }
 }
 
+quint64 Win32Utils::iconCacheGeneration()
+{
+    return s_iconCacheGeneration;
+}
+
 HWND Win32Utils::getForegroundWindow()
 {
     return GetForegroundWindow();
 }
 
+bool Win32Utils::isWindowMinimized(HWND hwnd)
+{
+    return IsIconic(hwnd) != FALSE;
+}
+
+// The shell hook decoder mirrors Win32 values without including <windows.h>
+static_assert(ShellHook::WindowDestroyed == HSHELL_WINDOWDESTROYED, "HSHELL_WINDOWDESTROYED mismatch");
+static_assert(ShellHook::WindowActivated == HSHELL_WINDOWACTIVATED, "HSHELL_WINDOWACTIVATED mismatch");
+static_assert(ShellHook::RudeAppActivated == HSHELL_RUDEAPPACTIVATED, "HSHELL_RUDEAPPACTIVATED mismatch");
+static_assert(ShellHook::GetMinRect == HSHELL_GETMINRECT, "HSHELL_GETMINRECT mismatch");
+static_assert(ShellHook::Flash == HSHELL_FLASH, "HSHELL_FLASH mismatch");
+
+UINT Win32Utils::registerShellHook(HWND hwnd)
+{
+    const UINT message = RegisterWindowMessageW(L"SHELLHOOK");
+    if (message == 0)
+    {
+        logWin32Error("RegisterWindowMessage(SHELLHOOK)");
+        return 0;
+    }
+    if (!RegisterShellHookWindow(hwnd))
+    {
+        logWin32Error("RegisterShellHookWindow");
+        return 0;
+    }
+    return message;
+}
+
+void Win32Utils::unregisterShellHook(HWND hwnd)
+{
+    DeregisterShellHookWindow(hwnd);
+}
+
+HWND Win32Utils::shellHookWindow(WPARAM code, LPARAM lParam)
+{
+    // HSHELL_GETMINRECT passes a SHELLHOOKINFO instead of the window handle
+    if (code == HSHELL_GETMINRECT)
+    {
+        const SHELLHOOKINFO *info = reinterpret_cast<const SHELLHOOKINFO *>(lParam);
+        return info ? info->hwnd : nullptr;
+    }
+    return reinterpret_cast<HWND>(lParam);
+}
+
+bool Win32Utils::attachParentConsole()
+{
+    if (!AttachConsole(ATTACH_PARENT_PROCESS))
+    {
+        return false;
+    }
+    FILE *stream = nullptr;
+    freopen_s(&stream, "CONOUT$", "w", stdout);
+    freopen_s(&stream, "CONOUT$", "w", stderr);
+    return true;
+}
+
 bool Win32Utils::registerHotKey(HWND hwnd, int id, UINT modifiers, UINT vk)
 {
     if (!RegisterHotKey(hwnd, id, modifiers, vk))
@@ -3,6 +3,8 @@
 
 #include <QString>
 #include <QIcon>
+#include <QImage>
+#include <QList>
 #include <windows.h>
 
 /**
@@ -14,6 +16,34 @@
 class Win32Utils
 {
 public:
+    /**
+     * @brief Small handle identifying a cached window icon
+     *
+     * IDs are never reused, so a changed ID always means a changed icon.
+     */
+    using IconId = quint32;
+    static constexpr IconId NoIcon = 0;
+
+    /**
+     * @brief Ways to bring a window to the foreground, from least to most intrusive
+     */
+    enum class ActivationStrategy
+    {
+        Direct,       ///< SetForegroundWindow only
+        AltKeyUnlock, ///< Synthesize an Alt key press to lift the foreground lock first
+        AttachInput,  ///< Share input state with the current foreground thread
+        Count
+    };
+
+    /**
+     * @brief Show state applied by showWindows()
+     */
+    enum class ShowCommand
+    {
+        Minimize, ///< Minimize without activating another window
+        Restore   ///< Restore without activating the window
+    };
+
     /**
      * @brief Get the process name from a process ID
      * @param processId The process ID to query
@@ -35,6 +65,78 @@ public:
      */
     static QIcon getWindowIcon(HWND hwnd);
 
+    /**
+     * @brief Get the cached icon ID for a window
+     *
+     * Does not contact the window: on a cache miss a new ID is reserved and the
+     * icon is fetched by iconById() the first time it is needed.
+     * @param hwnd Window handle
+     * @return Icon ID, or NoIcon if the window is invalid
+     */
+    static IconId getWindowIconId(HWND hwnd);
+
+    /**
+     * @brief Look up a cached icon by ID, fetching it from the window on first use
+     * @param id Icon ID returned by getWindowIconId()
+     * @return The icon, or an empty QIcon if the ID is unknown or was evicted
+     */
+    static QIcon iconById(IconId id);
+
+    /**
+     * @brief Look up a cached icon by ID without fetching it
+     *
+     * Never contacts the window, so it is safe while shutting down or when the
+     * window may hang.
+     * @param id Icon ID returned by getWindowIconId()
+     * @return The icon if it was already fetched or seeded, otherwise an empty QIcon
+     */
+    static QIcon resolvedIconById(IconId id);
+
+    /**
+     * @brief Put an already known icon for a window into the cache
+     *
+     * Used at startup with icons saved by the previous run, so the first tiles
+     * need no icon query. The periodic icon refresh replaces it like any other entry.
+     * @param hwnd Window handle
+     * @param icon Icon to cache
+     * @return Icon ID; the existing one if the window is already cached
+     */
+    static IconId seedWindowIcon(HWND hwnd, const QIcon &icon);
+
+    /**
+     * @brief Get the ID of the process that owns a window
+     * @param hwnd Window handle
+     * @return Process ID, or 0 if the window is invalid
+     */
+    static DWORD getWindowProcessId(HWND hwnd);
+
+    /**
+     * @brief Get the monitor a window is on
+     *
+     * A minimized window is assigned to the monitor it will be restored to.
+     * @param hwnd Window handle
+     * @return Monitor with the largest part of the window, or the nearest one
+     */
+    static HMONITOR getWindowMonitor(HWND hwnd);
+
+    /**
+     * @brief Get the GDI device name of a monitor (as returned by QScreen::name())
+     * @param monitor Monitor handle
+     * @return Device name such as "\\.\DISPLAY1", or an empty string on error
+     */
+    static QString getMonitorDeviceName(HMONITOR monitor);
+
+    /**
+     * @brief Render the current contents of a window into an image
+     *
+     * Uses PrintWindow, so it works for covered windows but sends a message to the
+     * window's thread; minimized and hung windows are skipped. Touches no shared
+     * state and may be called from worker threads.
+     * @param hwnd Window handle
+     * @return RGB32 image of the window, or a null image
+     */
+    static QImage captureWindow(HWND hwnd);
+
     /**
      * @brief Get the title of a window with buffer overflow protection
      * @param hwnd Window handle
@@ -43,6 +145,27 @@ public:
      */
     static QString getWindowTitle(HWND hwnd, bool *success = nullptr);
 
+    /**
+     * @brief Get the title of a window into a caller-provided buffer
+     *
+     * Lets callers that scan many windows reuse one buffer instead of allocating per window.
+     * @param hwnd Window handle
+     * @param buffer Destination buffer, always null-terminated on return
+     * @param bufferLength Size of the buffer in characters, including the terminator
+     * @return Number of characters written (excluding the terminator), 0 on failure or empty title
+     */
+    static int getWindowTitle(HWND hwnd, WCHAR *buffer, int bufferLength);
+
+    /**
+     * @brief Get the DWM cloaking state of a window
+     *
+     * Cloaked windows are composed but not shown, e.g. windows on another virtual
+     * desktop or suspended UWP frames.
+     * @param hwnd Window handle
+     * @return DWMWA_CLOAKED flags (DWM_CLOAKED_APP / _SHELL / _INHERITED), 0 if not cloaked
+     */
+    static quint32 getWindowCloakedFlags(HWND hwnd);
+
     /**
      * @brief Activate (bring to foreground) a window
      * @param hwnd Window handle
@@ -50,6 +173,17 @@ public:
      */
     static bool activateWindow(HWND hwnd);
 
+    /**
+     * @brief Restore a window and request the foreground using one strategy
+     *
+     * Does not wait: the caller confirms the result with getForegroundWindow().
+     * Safe to call from a worker thread.
+     * @param hwnd Window handle
+     * @param strategy Strategy to use
+     * @return false if the request was rejected outright
+     */
+    static bool requestForeground(HWND hwnd, ActivationStrategy strategy);
+
     /**
      * @brief Close a window by sending WM_CLOSE message
      * @param hwnd Window handle
@@ -57,6 +191,24 @@ public:
      */
     static bool closeWindow(HWND hwnd);
 
+    /**
+     * @brief Send WM_CLOSE to several windows in one pass
+     * @param windows Window handles
+     * @return Windows the message was posted to
+     */
+    static QList<HWND> closeWindows(const QList<HWND> &windows);
+
+    /**
+     * @brief Minimize or restore several windows in one pass
+     *
+     * Uses ShowWindowAsync, so a hung window does not hold up the others, and
+     * never activates a window, so the foreground does not move once per window.
+     * @param windows Window handles
+     * @param command Show state to apply
+     * @return Number of windows the request was posted to
+     */
+    static int showWindows(const QList<HWND> &windows, ShowCommand command);
+
     /**
      * @brief Launch a new process instance
      * @param processPath Full path to the executable to launch
@@ -77,12 +229,59 @@ public:
      */
     static void clearIconCache(HWND hwnd = nullptr);
 
+    /**
+     * @brief Get a counter that changes every time the whole icon cache is cleared
+     *
+     * Evicting a single window with clearIconCache(hwnd) does not change it.
+     * Lets callers that hold icon IDs tell cheaply whether they need to look them up again.
+     * @return Current icon cache generation
+     */
+    static quint64 iconCacheGeneration();
+
+    /**
+     * @brief Check whether a window should not be sent messages right now
+     *
+     * True for windows the system reports as hung and for windows that recently
+     * timed out and are still within their backoff period.
+     * @param hwnd Window handle
+     * @return true if the window is hung or quarantined
+     */
+    static bool isWindowUnresponsive(HWND hwnd);
+
     /**
      * @brief Get the handle of the foreground window
      * @return Handle to the foreground window
      */
     static HWND getForegroundWindow();
 
+    /**
+     * @brief Check whether a window is minimized
+     * @param hwnd Window handle
+     * @return true if minimized
+     */
+    static bool isWindowMinimized(HWND hwnd);
+
+    /**
+     * @brief Register a window to receive shell hook notifications
+     * @param hwnd Window handle
+     * @return ID of the "SHELLHOOK" window message, or 0 on failure
+     */
+    static UINT registerShellHook(HWND hwnd);
+
+    /**
+     * @brief Stop receiving shell hook notifications
+     * @param hwnd Window handle
+     */
+    static void unregisterShellHook(HWND hwnd);
+
+    /**
+     * @brief Get the window a shell hook notification refers to
+     * @param code wParam of the shell hook message
+     * @param lParam lParam of the shell hook message
+     * @return Window handle
+     */
+    static HWND shellHookWindow(WPARAM code, LPARAM lParam);
+
     /**
      * @brief Register a global hotkey
      * @param hwnd Window handle to receive WM_HOTKEY messages
@@ -101,6 +300,15 @@ public:
      */
     static bool unregisterHotKey(HWND hwnd, int id);
 
+    /**
+     * @brief Send stdout and stderr to the console of the parent process, if any
+     *
+     * The executable is built as a GUI application, so command line modes have
+     * no console of their own.
+     * @return true if a parent console was attached
+     */
+    static bool attachParentConsole();
+
 private:
     /**
      * @brief Log a Win32 API error with function name and error code
@@ -132,6 +340,19 @@ private:
      */
     static HICON tryGetIconViaMessage(HWND hwnd, WPARAM iconType);
 
+    /**
+     * @brief Fetch a window's icon from the window or its class
+     * @param hwnd Window handle
+     * @return QIcon, or empty QIcon if none found
+     */
+    static QIcon fetchWindowIcon(HWND hwnd);
+
+    /**
+     * @brief Stop messaging a window that timed out, with exponential backoff
+     * @param hwnd Window handle
+     */
+    static void quarantineWindow(HWND hwnd);
+
     /**
      * @brief Try to get window icon via GetClassLongPtr
      * @param hwnd Window handle
@@ -0,0 +1,175 @@
+#include "windowfilter.h"
+#include "config.h"
+#include <QDebug>
+
+namespace
+{
+    QStringList nonEmpty(const QStringList &values)
+    {
+        QStringList result;
+        for (const QString &value : values)
+        {
+            const QString trimmed = value.trimmed();
+            if (!trimmed.isEmpty())
+            {
+                result.append(trimmed);
+            }
+        }
+        return result;
+    }
+}
+
+void WindowFilter::FoldedStringSet::insert(const QString &value)
+{
+    m_entries.insert(foldedHash(value), value);
+}
+
+bool WindowFilter::FoldedStringSet::contains(QStringView value) const
+{
+    if (m_entries.isEmpty())
+    {
+        return false;
+    }
+    auto range = m_entries.equal_range(foldedHash(value));
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (value.compare(it.value(), Qt::CaseInsensitive) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t WindowFilter::FoldedStringSet::foldedHash(QStringView value)
+{
+    // FNV-1a over case-folded UTF-16 code units, so lookups need no lowered copy
+    size_t hash = 2166136261u;
+    for (QChar ch : value)
+    {
+        hash ^= ch.toCaseFolded().unicode();
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+QRegularExpression WindowFilter::compilePatterns(const QStringList &patterns)
+{
+    QStringList valid;
+    for (const QString &pattern : patterns)
+    {
+        QRegularExpression re(pattern);
+        if (re.isValid())
+        {
+            valid.append(QStringLiteral("(?:%1)").arg(pattern));
+        }
+        else
+        {
+            qWarning() << "Ignoring invalid title pattern" << pattern << "-" << re.errorString();
+        }
+    }
+
+    QRegularExpression combined(valid.join(QLatin1Char('|')),
+                                QRegularExpression::CaseInsensitiveOption |
+                                    QRegularExpression::DontCaptureOption);
+    // Compile (and JIT) now instead of on the first match during a scan
+    combined.optimize();
+    return combined;
+}
+
+WindowFilter::WindowFilter(const Rules &rules)
+{
+    for (const QString &name : nonEmpty(rules.excludeProcesses))
+    {
+        m_excludeProcesses.insert(name);
+    }
+    for (const QString &name : nonEmpty(rules.excludeClasses))
+    {
+        m_excludeClasses.insert(name);
+    }
+    for (const QString &name : nonEmpty(rules.includeProcesses))
+    {
+        m_includeProcesses.insert(name);
+    }
+    for (const QString &name : nonEmpty(rules.includeClasses))
+    {
+        m_includeClasses.insert(name);
+    }
+
+    const QStringList excludeTitles = nonEmpty(rules.excludeTitlePatterns);
+    const QStringList includeTitles = nonEmpty(rules.includeTitlePatterns);
+    m_hasExcludeTitles = !excludeTitles.isEmpty();
+    m_hasIncludeTitles = !includeTitles.isEmpty();
+    if (m_hasExcludeTitles)
+    {
+        m_excludeTitles = compilePatterns(excludeTitles);
+    }
+    if (m_hasIncludeTitles)
+    {
+        m_includeTitles = compilePatterns(includeTitles);
+    }
+
+    m_excludeStyleMask = rules.excludeStyleMask;
+    m_excludeExStyleMask = rules.excludeExStyleMask;
+
+    m_hasIncludeRules = !m_includeProcesses.isEmpty() || !m_includeClasses.isEmpty() || m_hasIncludeTitles;
+    m_empty = !m_hasIncludeRules && m_excludeProcesses.isEmpty() && m_excludeClasses.isEmpty() &&
+              !m_hasExcludeTitles && m_excludeStyleMask == 0 && m_excludeExStyleMask == 0;
+}
+
+WindowFilter WindowFilter::fromSettings()
+{
+    Rules rules;
+    rules.excludeProcesses = WinSelectorConfig::Filter::excludeProcesses();
+    rules.excludeClasses = WinSelectorConfig::Filter::excludeClasses();
+    rules.excludeTitlePatterns = WinSelectorConfig::Filter::excludeTitlePatterns();
+    rules.includeProcesses = WinSelectorConfig::Filter::includeProcesses();
+    rules.includeClasses = WinSelectorConfig::Filter::includeClasses();
+    rules.includeTitlePatterns = WinSelectorConfig::Filter::includeTitlePatterns();
+    rules.excludeStyleMask = WinSelectorConfig::Filter::excludeStyleMask();
+    rules.excludeExStyleMask = WinSelectorConfig::Filter::excludeExStyleMask();
+    return WindowFilter(rules);
+}
+
+WindowFilter::Decision WindowFilter::matchCheap(QStringView className, quint32 style, quint32 exStyle) const
+{
+    if ((style & m_excludeStyleMask) || (exStyle & m_excludeExStyleMask))
+    {
+        return Decision::Exclude;
+    }
+    if (m_excludeClasses.contains(className))
+    {
+        return Decision::Exclude;
+    }
+    if (m_includeClasses.contains(className))
+    {
+        return Decision::Include;
+    }
+    return Decision::Undecided;
+}
+
+WindowFilter::Decision WindowFilter::matchTitle(QStringView title) const
+{
+    if (m_hasExcludeTitles && m_excludeTitles.match(title).hasMatch())
+    {
+        return Decision::Exclude;
+    }
+    if (m_hasIncludeTitles && m_includeTitles.match(title).hasMatch())
+    {
+        return Decision::Include;
+    }
+    return Decision::Undecided;
+}
+
+WindowFilter::Decision WindowFilter::matchProcess(QStringView processName) const
+{
+    if (m_excludeProcesses.contains(processName))
+    {
+        return Decision::Exclude;
+    }
+    if (m_includeProcesses.contains(processName))
+    {
+        return Decision::Include;
+    }
+    return Decision::Undecided;
+}
@@ -0,0 +1,151 @@
+#ifndef WINDOWFILTER_H
+#define WINDOWFILTER_H
+
+#include <QMultiHash>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+
+/**
+ * @brief User-defined include/exclude rules for windows, compiled for fast matching
+ *
+ * Rules are read from the [Filter] section of Settings.ini and compiled once:
+ * process and class names go into case-insensitive hash sets and title patterns
+ * are merged into a single optimized regular expression. A window is hidden if it
+ * matches any exclude rule; if include rules exist, it is shown only when it
+ * matches at least one of them.
+ *
+ * The matcher is split into stages so the scanner can reject a window using only
+ * the attributes it already has: class and styles first (no query needed), then
+ * the process name (cached per process) while candidates are collected, and the
+ * title last, since it is only read for the windows that are still candidates.
+ */
+class WindowFilter
+{
+public:
+    /**
+     * @brief Rule definitions as written in Settings.ini
+     */
+    struct Rules
+    {
+        QStringList excludeProcesses;
+        QStringList excludeClasses;
+        QStringList excludeTitlePatterns;
+        QStringList includeProcesses;
+        QStringList includeClasses;
+        QStringList includeTitlePatterns;
+        quint32 excludeStyleMask = 0;
+        quint32 excludeExStyleMask = 0;
+    };
+
+    /**
+     * @brief Result of evaluating one stage
+     */
+    enum class Decision
+    {
+        Exclude,  ///< Hidden; no further stage needs to run
+        Include,  ///< Matched an include rule; later include checks can be skipped
+        Undecided ///< Not excluded so far
+    };
+
+    WindowFilter() = default;
+
+    /**
+     * @brief Compile a filter from rule definitions
+     * @param rules Rules to compile; empty entries are ignored
+     */
+    explicit WindowFilter(const Rules &rules);
+
+    /**
+     * @brief Compile the rules configured in Settings.ini
+     * @return Compiled filter
+     */
+    static WindowFilter fromSettings();
+
+    /**
+     * @brief Check whether any rule is configured
+     * @return true if every window passes
+     */
+    bool isEmpty() const { return m_empty; }
+
+    /**
+     * @brief Check whether the process stage needs the process name
+     * @return true if process rules exist
+     */
+    bool usesProcessName() const { return !m_excludeProcesses.isEmpty() || !m_includeProcesses.isEmpty(); }
+
+    /**
+     * @brief Check whether the title stage has any rule
+     * @return true if title rules exist
+     */
+    bool usesTitle() const { return m_hasExcludeTitles || m_hasIncludeTitles; }
+
+    /**
+     * @brief Stage 1: evaluate rules on attributes available without any query
+     * @param className Window class name
+     * @param style Window style (GWL_STYLE)
+     * @param exStyle Extended window style (GWL_EXSTYLE)
+     * @return Decision for this stage
+     */
+    Decision matchCheap(QStringView className, quint32 style, quint32 exStyle) const;
+
+    /**
+     * @brief Stage 2: evaluate process rules
+     * @param processName Process executable name
+     * @return Decision for this stage
+     */
+    Decision matchProcess(QStringView processName) const;
+
+    /**
+     * @brief Stage 3: evaluate title rules
+     * @param title Window title
+     * @return Decision for this stage
+     */
+    Decision matchTitle(QStringView title) const;
+
+    /**
+     * @brief Final decision for a window that was never excluded
+     * @param included true if any stage returned Include
+     * @return true if the window should be shown
+     */
+    bool accepts(bool included) const { return included || !m_hasIncludeRules; }
+
+private:
+    /**
+     * @brief Hash set of strings compared case-insensitively without allocating
+     */
+    class FoldedStringSet
+    {
+    public:
+        void insert(const QString &value);
+        bool contains(QStringView value) const;
+        bool isEmpty() const { return m_entries.isEmpty(); }
+
+    private:
+        static size_t foldedHash(QStringView value);
+        QMultiHash<size_t, QString> m_entries;
+    };
+
+    /**
+     * @brief Merge patterns into one optimized case-insensitive expression
+     * @param patterns Regular expressions
+     * @return Combined expression
+     */
+    static QRegularExpression compilePatterns(const QStringList &patterns);
+
+    FoldedStringSet m_excludeProcesses;
+    FoldedStringSet m_excludeClasses;
+    FoldedStringSet m_includeProcesses;
+    FoldedStringSet m_includeClasses;
+    QRegularExpression m_excludeTitles;
+    QRegularExpression m_includeTitles;
+    quint32 m_excludeStyleMask = 0;
+    quint32 m_excludeExStyleMask = 0;
+    bool m_hasExcludeTitles = false;
+    bool m_hasIncludeTitles = false;
+    bool m_hasIncludeRules = false;
+    bool m_empty = true;
+};
+
+#endif // WINDOWFILTER_H
@@ -0,0 +1,180 @@
+#include "windowgroups.h"
+#include "shellhookstate.h"
+
+void WindowGroups::setMinimumSize(int minimumSize)
+{
+    minimumSize = qMax(0, minimumSize);
+    if (minimumSize == m_minimumSize)
+    {
+        return;
+    }
+    m_minimumSize = minimumSize;
+    for (auto it = m_groups.cbegin(); it != m_groups.cend(); ++it)
+    {
+        m_dirty.insert(it.key());
+    }
+}
+
+void WindowGroups::add(quintptr handle, const QString &key, quint8 flags)
+{
+    if (key.isEmpty() || m_keys.contains(handle))
+    {
+        return;
+    }
+    m_keys.insert(handle, key);
+    if (flags != 0)
+    {
+        m_flags.insert(handle, flags);
+    }
+
+    Group &group = m_groups[key];
+    if (group.key.isEmpty())
+    {
+        group.key = key;
+    }
+    group.members.append(handle);
+    count(group, flags, 1);
+    markDirty(key);
+}
+
+void WindowGroups::remove(quintptr handle)
+{
+    const auto keyIt = m_keys.constFind(handle);
+    if (keyIt == m_keys.cend())
+    {
+        return;
+    }
+    const QString key = keyIt.value();
+    m_keys.erase(keyIt);
+
+    const auto groupIt = m_groups.find(key);
+    if (groupIt != m_groups.end())
+    {
+        groupIt->members.removeOne(handle);
+        count(*groupIt, m_flags.take(handle), -1);
+        if (groupIt->members.isEmpty())
+        {
+            m_groups.erase(groupIt);
+        }
+    }
+    markDirty(key);
+}
+
+bool WindowGroups::setKey(quintptr handle, const QString &key, quint8 flags)
+{
+    if (m_keys.value(handle) == key)
+    {
+        return false;
+    }
+    remove(handle);
+    add(handle, key, flags);
+    return true;
+}
+
+void WindowGroups::setFlags(quintptr handle, quint8 flags)
+{
+    const auto keyIt = m_keys.constFind(handle);
+    if (keyIt == m_keys.cend())
+    {
+        return;
+    }
+    const quint8 previous = m_flags.value(handle, 0);
+    if (previous == flags)
+    {
+        return;
+    }
+    if (flags != 0)
+    {
+        m_flags.insert(handle, flags);
+    }
+    else
+    {
+        m_flags.remove(handle);
+    }
+
+    const auto groupIt = m_groups.find(keyIt.value());
+    if (groupIt == m_groups.end())
+    {
+        return;
+    }
+    // The group tile only shows whether any member is active or flashing and
+    // whether all of them are minimized
+    const bool wasActive = groupIt->active > 0;
+    const bool wasFlashing = groupIt->flashing > 0;
+    const bool wasMinimized = groupIt->minimized == groupIt->count();
+    count(*groupIt, previous, -1);
+    count(*groupIt, flags, 1);
+    if (isGrouped(*groupIt) &&
+        (wasActive != (groupIt->active > 0) || wasFlashing != (groupIt->flashing > 0) ||
+         wasMinimized != (groupIt->minimized == groupIt->count())))
+    {
+        markDirty(groupIt->key);
+    }
+}
+
+void WindowGroups::touch(quintptr handle)
+{
+    // Only a group tile shows anything of its windows
+    const Group *group = groupOf(handle);
+    if (group && isGrouped(*group))
+    {
+        markDirty(group->key);
+    }
+}
+
+void WindowGroups::setExpanded(const QString &key, bool expanded)
+{
+    const auto it = m_groups.find(key);
+    if (it == m_groups.end() || it->expanded == expanded)
+    {
+        return;
+    }
+    it->expanded = expanded;
+    markDirty(key);
+}
+
+const WindowGroups::Group *WindowGroups::find(const QString &key) const
+{
+    const auto it = m_groups.constFind(key);
+    return it != m_groups.cend() ? &it.value() : nullptr;
+}
+
+const WindowGroups::Group *WindowGroups::groupOf(quintptr handle) const
+{
+    const auto keyIt = m_keys.constFind(handle);
+    return keyIt != m_keys.cend() ? find(keyIt.value()) : nullptr;
+}
+
+bool WindowGroups::isCollapsed(quintptr handle) const
+{
+    const Group *group = groupOf(handle);
+    return group && !group->expanded && isGrouped(*group);
+}
+
+QList<QString> WindowGroups::takeDirty()
+{
+    QList<QString> dirty = m_dirty.values();
+    m_dirty.clear();
+    return dirty;
+}
+
+void WindowGroups::markDirty(const QString &key)
+{
+    m_dirty.insert(key);
+}
+
+void WindowGroups::count(Group &group, quint8 flags, int delta)
+{
+    if (flags & ShellWindowState::Minimized)
+    {
+        group.minimized += delta;
+    }
+    if (flags & ShellWindowState::Flashing)
+    {
+        group.flashing += delta;
+    }
+    if (flags & ShellWindowState::Active)
+    {
+        group.active += delta;
+    }
+}
@@ -0,0 +1,142 @@
+#ifndef WINDOWGROUPS_H
+#define WINDOWGROUPS_H
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * @brief Windows grouped by process, with per-group aggregates kept up to date incrementally
+ *
+ * Every listed window belongs to the group of its process name. A group with at
+ * least minimumSize() windows is shown as one group tile; unless the user
+ * expanded it, its windows are collapsed and get no tile of their own. Adding,
+ * removing or restyling a window only touches its own group, and the groups
+ * whose tile needs an update are collected until takeDirty().
+ *
+ * Windows without a process name are never grouped. The class has no Win32
+ * dependency; flags are ShellWindowState::Flag values.
+ */
+class WindowGroups
+{
+public:
+    /**
+     * @brief One process group
+     */
+    struct Group
+    {
+        QString key;              ///< Process name
+        QList<quintptr> members;  ///< Windows in the order they were added
+        int minimized = 0;        ///< Members with the Minimized flag
+        int flashing = 0;         ///< Members with the Flashing flag
+        int active = 0;           ///< Members with the Active flag
+        bool expanded = false;    ///< Members are shown as tiles even though grouped
+
+        int count() const { return members.size(); }
+    };
+
+    /**
+     * @brief Set the group size at which windows are grouped
+     * @param minimumSize Minimum number of windows; 0 disables grouping
+     */
+    void setMinimumSize(int minimumSize);
+
+    int minimumSize() const { return m_minimumSize; }
+
+    /**
+     * @brief Add a window to the group of its process
+     * @param handle Window handle
+     * @param key Process name; an empty name keeps the window ungrouped
+     * @param flags Current ShellWindowState flags of the window
+     */
+    void add(quintptr handle, const QString &key, quint8 flags);
+
+    /**
+     * @brief Remove a window; the group is dropped with its last window
+     * @param handle Window handle
+     */
+    void remove(quintptr handle);
+
+    /**
+     * @brief Move a window to the group of another process name
+     *
+     * Needed when a placeholder window gets its process name on a later scan,
+     * or a handle is reused by another process. Both groups are marked dirty.
+     * @param handle Window handle
+     * @param key New process name; an empty name leaves the window ungrouped
+     * @param flags Current ShellWindowState flags of the window
+     * @return true if the window changed groups
+     */
+    bool setKey(quintptr handle, const QString &key, quint8 flags);
+
+    /**
+     * @brief Update the flags of a window
+     * @param handle Window handle
+     * @param flags New ShellWindowState flags
+     */
+    void setFlags(quintptr handle, quint8 flags);
+
+    /**
+     * @brief Mark the group tile of a window for an update, e.g. after an icon change
+     * @param handle Window handle
+     */
+    void touch(quintptr handle);
+
+    /**
+     * @brief Expand or collapse a group
+     * @param key Process name
+     * @param expanded true to show the windows of the group as tiles
+     */
+    void setExpanded(const QString &key, bool expanded);
+
+    /**
+     * @brief Look up a group
+     * @param key Process name
+     * @return Group, or nullptr; valid until the next add() or remove()
+     */
+    const Group *find(const QString &key) const;
+
+    /**
+     * @brief Get the group of a window
+     * @param handle Window handle
+     * @return Group, or nullptr if the window is not grouped
+     */
+    const Group *groupOf(quintptr handle) const;
+
+    /**
+     * @brief Check whether a group is large enough to be shown as a group tile
+     * @param group Group to check
+     * @return true if grouping is enabled and the group has enough windows
+     */
+    bool isGrouped(const Group &group) const
+    {
+        return m_minimumSize > 0 && group.count() >= m_minimumSize;
+    }
+
+    /**
+     * @brief Check whether a window is hidden inside a collapsed group
+     * @param handle Window handle
+     * @return true if the window needs no tile
+     */
+    bool isCollapsed(quintptr handle) const;
+
+    /**
+     * @brief Get and reset the groups changed since the last call
+     * @return Process names; groups that no longer exist are included
+     */
+    QList<QString> takeDirty();
+
+private:
+    QHash<QString, Group> m_groups;
+    QHash<quintptr, QString> m_keys;   ///< Group of every added window
+    QHash<quintptr, quint8> m_flags;   ///< Flags counted in the aggregates
+    QSet<QString> m_dirty;
+    int m_minimumSize = 0;
+
+    void markDirty(const QString &key);
+    static void count(Group &group, quint8 flags, int delta);
+};
+
+#endif // WINDOWGROUPS_H
@@ -0,0 +1,83 @@
+#include "windowrelevance.h"
+#include <QLatin1String>
+
+WindowRelevance::Reason WindowRelevance::classify(const WindowAttributes &attributes)
+{
+    // Only consider visible windows
+    if (!attributes.visible)
+    {
+        return Reason::Invisible;
+    }
+
+    // Windows on other virtual desktops are cloaked by the shell; suspended UWP
+    // frames and similar are cloaked by their app
+    if (attributes.cloakedFlags & CloakedShell)
+    {
+        return Reason::OtherVirtualDesktop;
+    }
+    if (attributes.cloakedFlags != 0)
+    {
+        return Reason::Cloaked;
+    }
+
+    if (isShellClass(attributes.className))
+    {
+        return Reason::ShellWindow;
+    }
+
+    // WS_EX_APPWINDOW forces a window into the task switcher regardless of the
+    // rules below
+    const bool appWindow = attributes.exStyle & ExStyleAppWindow;
+    if (appWindow)
+    {
+        return Reason::Relevant;
+    }
+
+    // Skip tool windows (like tooltips) and owned popups such as dialogs; their
+    // owner already has a tile
+    if (attributes.exStyle & ExStyleToolWindow)
+    {
+        return Reason::ToolWindow;
+    }
+    // The whole owner chain is checked: a visible owner anywhere up the chain
+    // already has a tile (or is itself an owned popup of one that does)
+    const int ownerCount = qMin(attributes.ownerCount, int(WindowAttributes::MaxOwnerChain));
+    for (int i = 0; i < ownerCount; ++i)
+    {
+        if (attributes.ownerVisible[i])
+        {
+            return Reason::Owned;
+        }
+    }
+    if (attributes.exStyle & ExStyleNoActivate)
+    {
+        return Reason::NoActivate;
+    }
+
+    // Allow windows with empty titles - we'll show process name instead
+    return Reason::Relevant;
+}
+
+bool WindowRelevance::isShellClass(QStringView className)
+{
+    return className == QLatin1String("Progman") ||
+           className == QLatin1String("WorkerW") ||
+           className == QLatin1String("Shell_TrayWnd") ||
+           className == QLatin1String("Shell_SecondaryTrayWnd");
+}
+
+const char *WindowRelevance::reasonName(Reason reason)
+{
+    switch (reason)
+    {
+    case Reason::Relevant: return "relevant";
+    case Reason::Invisible: return "invisible";
+    case Reason::Cloaked: return "cloaked";
+    case Reason::OtherVirtualDesktop: return "other virtual desktop";
+    case Reason::ShellWindow: return "shell window";
+    case Reason::Owned: return "owned";
+    case Reason::ToolWindow: return "tool window";
+    case Reason::NoActivate: return "no-activate";
+    default: return "unknown";
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef WINDOWRELEVANCE_H
+#define WINDOWRELEVANCE_H
+
+#include <QStringView>
+#include <QtGlobal>
+
+/**
+ * @brief Plain attributes of a top-level window used to decide whether it gets a tile
+ *
+ * Filled from Win32 by WindowScanner; the decision itself has no Win32
+ * dependency so it can be exercised with synthetic attributes on any platform.
+ */
+struct WindowAttributes
+{
+    /// Owners beyond this depth are not inspected
+    static constexpr int MaxOwnerChain = 8;
+
+    bool visible = false;
+    int ownerCount = 0;                       ///< Length of the GW_OWNER chain, at most MaxOwnerChain
+    bool ownerVisible[MaxOwnerChain] = {};    ///< IsWindowVisible() of each owner, nearest first
+    quint32 style = 0;           ///< GWL_STYLE
+    quint32 exStyle = 0;         ///< GWL_EXSTYLE
+    quint32 cloakedFlags = 0;    ///< DWMWA_CLOAKED value (WindowRelevance::Cloaked* flags)
+    QStringView className;
+};
+
+/**
+ * @brief Task-switcher-equivalent relevance rules
+ *
+ * A window is listed under the same criteria the shell uses for Alt+Tab: it must
+ * be visible and not cloaked (cloaked by the shell means it lives on another
+ * virtual desktop), must not be an owned popup or a tool / no-activate window
+ * unless it explicitly asks to appear with WS_EX_APPWINDOW, and must not be one of
+ * the shell's own desktop or taskbar windows.
+ *
+ * A window counts as an owned popup if any window in its owner chain is visible,
+ * so a dialog opened from another dialog is hidden like its parent dialog. A
+ * window owned only by hidden windows (the hidden application window some UI
+ * frameworks create) stands for its application and is listed.
+ */
+namespace WindowRelevance
+{
+    /**
+     * @brief Why a window was accepted or rejected
+     */
+    enum class Reason
+    {
+        Relevant,
+        Invisible,
+        Cloaked,
+        OtherVirtualDesktop,
+        ShellWindow,
+        Owned,
+        ToolWindow,
+        NoActivate
+    };
+
+    // Win32 values, repeated here so this header does not need <windows.h>
+    constexpr quint32 ExStyleToolWindow = 0x00000080;  // WS_EX_TOOLWINDOW
+    constexpr quint32 ExStyleAppWindow = 0x00040000;   // WS_EX_APPWINDOW
+    constexpr quint32 ExStyleNoActivate = 0x08000000;  // WS_EX_NOACTIVATE
+    constexpr quint32 CloakedApp = 0x1;                // DWM_CLOAKED_APP
+    constexpr quint32 CloakedShell = 0x2;              // DWM_CLOAKED_SHELL
+    constexpr quint32 CloakedInherited = 0x4;          // DWM_CLOAKED_INHERITED
+
+    /**
+     * @brief Classify a window
+     * @param attributes Window attributes
+     * @return Relevant, or the first rule that rejected the window
+     */
+    Reason classify(const WindowAttributes &attributes);
+
+    /**
+     * @brief Check whether a class name belongs to the shell's desktop or taskbar
+     * @param className Window class name
+     * @return true for Progman, WorkerW and the taskbar classes
+     */
+    bool isShellClass(QStringView className);
+
+    /**
+     * @brief Get a printable name for a reason
+     * @param reason Classification result
+     * @return Reason name
+     */
+    const char *reasonName(Reason reason);
+}
+
+#endif // WINDOWRELEVANCE_H
@@ -1,71 +1,331 @@
 #include "windowscanner.h"
 #include "win32utils.h"
+#include "config.h"
+#include "windowrelevance.h"
+#include "lazyfieldstats.h"
+#include <dwmapi.h>
 #include <QDebug>
+#include <algorithm>
 
-static bool isWindowRelevant(HWND hwnd)
+// One QString, one shared process pointer and the scalar fields; the previous
+// layout held three QStrings and a QIcon by value (96 bytes on x64)
+static_assert(sizeof(void *) != 8 || sizeof(WindowInfo) <= 48,
+              "WindowInfo should stay compact; put per-process data in ProcessRecord");
+
+const QString &WindowInfo::processName() const
 {
-    // Only consider visible windows
-    if (!IsWindowVisible(hwnd))
+    static const QString empty;
+    return process ? process->name : empty;
+}
+
+const QString &WindowInfo::processPath() const
+{
+    static const QString empty;
+    if (!process)
     {
-        return false;
+        return empty;
     }
-
-    // Skip tool windows (like tooltips) unless explicitly marked as app windows
-    // Tool windows have WS_EX_TOOLWINDOW flag but not WS_EX_APPWINDOW
-    LONG_PTR exStyle = GetWindowLongPtr(hwnd, GWL_EXSTYLE);
-    if ((exStyle & WS_EX_TOOLWINDOW) && !(exStyle & WS_EX_APPWINDOW))
+    if (!process->pathResolved)
     {
-        return false;
+        process->path = Win32Utils::getProcessPath(process->processId);
+        process->pathResolved = true;
+        LazyFieldStats::requested(LazyFieldStats::Field::ProcessPath);
     }
-
-    // Allow windows with empty titles - we'll show process name instead
-    return true;
+    return process->path;
 }
 
+// The relevance rules mirror Win32 values without including <windows.h>
+static_assert(WindowRelevance::ExStyleToolWindow == WS_EX_TOOLWINDOW, "WS_EX_TOOLWINDOW mismatch");
+static_assert(WindowRelevance::ExStyleAppWindow == WS_EX_APPWINDOW, "WS_EX_APPWINDOW mismatch");
+static_assert(WindowRelevance::ExStyleNoActivate == WS_EX_NOACTIVATE, "WS_EX_NOACTIVATE mismatch");
+static_assert(WindowRelevance::CloakedShell == DWM_CLOAKED_SHELL, "DWM_CLOAKED_SHELL mismatch");
+
 BOOL CALLBACK EnumWindowsProc(HWND hwnd, LPARAM lParam)
 {
-    QList<WindowInfo> *list = reinterpret_cast<QList<WindowInfo> *>(lParam);
+    WindowScanner *scanner = reinterpret_cast<WindowScanner *>(lParam);
+
+    scanner->collectCandidate(hwnd);
+
+    return TRUE;
+}
+
+WindowScanner::WindowScanner()
+    : m_filter(WindowFilter::fromSettings())
+{
+}
+
+void WindowScanner::collectCandidate(HWND hwnd)
+{
+    // Most top-level windows are invisible; reject them before reading anything else
+    if (!IsWindowVisible(hwnd))
+    {
+        return;
+    }
 
-    if (!isWindowRelevant(hwnd))
-        return TRUE;
+    // Task-switcher relevance, decided from attributes that need no message
+    // to the window
+    WCHAR className[MaxClassNameLength];
+    const int classNameLength = GetClassNameW(hwnd, className, MaxClassNameLength);
 
-    // Get window title using Win32Utils with error checking
-    bool titleSuccess = false;
-    QString titleStr = Win32Utils::getWindowTitle(hwnd, &titleSuccess);
+    WindowAttributes attributes;
+    attributes.visible = true;
+    for (HWND owner = GetWindow(hwnd, GW_OWNER);
+         owner && attributes.ownerCount < WindowAttributes::MaxOwnerChain; owner = GetWindow(owner, GW_OWNER))
+    {
+        attributes.ownerVisible[attributes.ownerCount++] = IsWindowVisible(owner) != FALSE;
+    }
+    attributes.style = static_cast<quint32>(GetWindowLongPtr(hwnd, GWL_STYLE));
+    attributes.exStyle = static_cast<quint32>(GetWindowLongPtr(hwnd, GWL_EXSTYLE));
+    attributes.cloakedFlags = Win32Utils::getWindowCloakedFlags(hwnd);
+    attributes.className = QStringView(className, classNameLength);
 
-    // Skip Program Manager (Desktop)
-    if (titleStr == "Program Manager")
-        return TRUE;
+    if (WindowRelevance::classify(attributes) != WindowRelevance::Reason::Relevant)
+    {
+        return;
+    }
+
+    // User filter rules run in order of cost so an excluded window is rejected
+    // before anything expensive is queried for it
+    bool included = false;
+    if (!m_filter.isEmpty())
+    {
+        WindowFilter::Decision decision = m_filter.matchCheap(attributes.className, attributes.style, attributes.exStyle);
+        if (decision == WindowFilter::Decision::Exclude)
+        {
+            ++m_stats.filtered;
+            return;
+        }
+        included = decision == WindowFilter::Decision::Include;
+    }
 
     DWORD processId = 0;
     GetWindowThreadProcessId(hwnd, &processId);
 
+    if (m_filter.usesProcessName())
+    {
+        // Process records are cached per PID, so this costs a query only the
+        // first time a process is seen
+        WindowFilter::Decision decision = m_filter.matchProcess(internProcess(processId)->name);
+        if (decision == WindowFilter::Decision::Exclude)
+        {
+            ++m_stats.filtered;
+            return;
+        }
+        included |= decision == WindowFilter::Decision::Include;
+    }
+
+    // The title is only read in the second phase, so title rules are decided there
+    const bool titleRulesPending = m_filter.usesTitle();
+    if (!titleRulesPending && !m_filter.accepts(included))
+    {
+        ++m_stats.filtered;
+        return;
+    }
+
+    m_candidates.push_back(Candidate{hwnd, processId, included, titleRulesPending});
+}
+
+bool WindowScanner::budgetExhausted() const
+{
+    return m_budgetMs > 0 && m_scanTimer.hasExpired(m_budgetMs);
+}
+
+bool WindowScanner::resolveCandidate(const Candidate &candidate, bool iconsStale)
+{
+    const HWND hwnd = candidate.hwnd;
+
+    // Decode the title into the reused buffer; only windows that passed the
+    // first phase get here
+    const int titleLength = Win32Utils::getWindowTitle(hwnd, m_titleBuffer.data(), m_maxTitleLength + 1);
+    const QStringView titleView(m_titleBuffer.data(), titleLength);
+
+    if (candidate.titleRulesPending)
+    {
+        const WindowFilter::Decision decision = m_filter.matchTitle(titleView);
+        if (decision == WindowFilter::Decision::Exclude ||
+            !m_filter.accepts(candidate.included || decision == WindowFilter::Decision::Include))
+        {
+            ++m_stats.filtered;
+            return true;
+        }
+    }
+
+    // A record without a process is a placeholder from a scan that ran out of
+    // budget and always needs resolving
+    const WindowInfo *previous = findPrevious(hwnd);
+    if (previous && previous->process && previous->processId == candidate.processId &&
+        previous->title == (titleView.isEmpty() ? QStringView(previous->processName()) : titleView))
+    {
+        // Unchanged window: copying only shares the existing strings, and no
+        // process or icon query is needed
+        m_results.append(*previous);
+        WindowInfo &info = m_results.last();
+        bool iconsRefreshed = true;
+        if (iconsStale)
+        {
+            if (budgetExhausted())
+            {
+                iconsRefreshed = false;
+            }
+            else
+            {
+                info.iconId = Win32Utils::getWindowIconId(hwnd);
+            }
+        }
+        // The comparison above already proved the title and process unchanged
+        m_snapshot.append(reinterpret_cast<quintptr>(hwnd), info.processId, info.iconId, false);
+        return iconsRefreshed;
+    }
+
+    if (budgetExhausted())
+    {
+        // Out of time: keep what was shown last time, or a placeholder for a new
+        // window, and resolve it on the next scan
+        ++m_stats.deferred;
+        if (previous)
+        {
+            m_results.append(*previous);
+        }
+        else
+        {
+            WindowInfo placeholder;
+            placeholder.hwnd = hwnd;
+            placeholder.processId = candidate.processId;
+            placeholder.title = titleView.isEmpty() ? QStringLiteral("...") : titleView.toString();
+            m_results.append(std::move(placeholder));
+        }
+        // The tile keeps showing the previous record until the window is resolved
+        const WindowInfo &info = m_results.last();
+        m_snapshot.append(reinterpret_cast<quintptr>(hwnd), info.processId, info.iconId, false);
+        return !iconsStale;
+    }
+
+    ++m_stats.resolved;
+
     WindowInfo info;
     info.hwnd = hwnd;
-    info.processId = processId;
-    info.processName = Win32Utils::getProcessName(processId);
-    info.processPath = Win32Utils::getProcessPath(processId);
+    info.processId = candidate.processId;
+    info.process = internProcess(candidate.processId);
 
     // Use process name if title is empty
-    if (titleStr.isEmpty())
+    if (titleView.isEmpty())
     {
-        info.title = info.processName;
+        info.title = info.process->name;
     }
     else
     {
-        info.title = titleStr;
+        info.title = titleView.toString();
     }
 
-    info.icon = Win32Utils::getWindowIcon(hwnd);
+    info.iconId = Win32Utils::getWindowIconId(hwnd);
 
-    list->append(info);
+    // A window with a previous record only gets here if its title or process
+    // differs from that record; for a new window the flag is not used
+    m_snapshot.append(reinterpret_cast<quintptr>(hwnd), info.processId, info.iconId, true);
+    m_results.append(std::move(info));
+    return true;
+}
 
-    return TRUE;
+WindowInfo::ProcessRef WindowScanner::internProcess(DWORD processId)
+{
+    auto it = m_processes.find(processId);
+    if (it == m_processes.end())
+    {
+        WindowInfo::ProcessRef record(new ProcessRecord);
+        record->processId = processId;
+        record->name = Win32Utils::getProcessName(processId);
+        LazyFieldStats::deferred(LazyFieldStats::Field::ProcessPath);
+        it = m_processes.insert(processId, record);
+    }
+    it.value()->lastUsedScan = m_scanGeneration;
+    return it.value();
+}
+
+const WindowInfo *WindowScanner::findPrevious(HWND hwnd) const
+{
+    auto it = std::lower_bound(m_previousIndex.begin(), m_previousIndex.end(), hwnd,
+                               [](const std::pair<HWND, qsizetype> &entry, HWND key)
+                               { return entry.first < key; });
+    if (it == m_previousIndex.end() || it->first != hwnd)
+    {
+        return nullptr;
+    }
+    return &m_previous.at(it->second);
 }
 
-QList<WindowInfo> WindowScanner::getWindows()
+QList<WindowInfo> &WindowScanner::scan()
 {
-    QList<WindowInfo> windows;
-    EnumWindows(EnumWindowsProc, reinterpret_cast<LPARAM>(&windows));
-    return windows;
+    m_scanTimer.start();
+    m_budgetMs = m_unbounded ? 0 : WinSelectorConfig::WindowScanner::refreshBudgetMs();
+    m_stats = ScanStats();
+    ++m_scanGeneration;
+
+    // Phase 1: collect cheap attributes only
+    m_candidates.clear();
+    EnumWindows(EnumWindowsProc, reinterpret_cast<LPARAM>(this));
+
+    // Stays within the retained capacity unless MaxTitleLength grew
+    m_maxTitleLength = WinSelectorConfig::WindowScanner::maxTitleLength();
+    m_titleBuffer.resize(static_cast<size_t>(m_maxTitleLength) + 1);
+
+    // The last results become the lookup source for this scan. Both lists and
+    // the index keep their capacity, so steady-state scans do not reallocate.
+    m_previous.swap(m_results);
+    m_results.clear();
+    m_results.reserve(static_cast<qsizetype>(m_candidates.size()));
+
+    m_previousIndex.clear();
+    for (qsizetype i = 0; i < m_previous.size(); ++i)
+    {
+        m_previousIndex.emplace_back(m_previous.at(i).hwnd, i);
+    }
+    std::sort(m_previousIndex.begin(), m_previousIndex.end(),
+              [](const std::pair<HWND, qsizetype> &a, const std::pair<HWND, qsizetype> &b)
+              { return a.first < b.first; });
+
+    m_previousSnapshot.swap(m_snapshot);
+    m_snapshot.clear();
+    m_snapshot.reserve(m_candidates.size());
+
+    // Phase 2: resolve new and changed windows, reuse the rest
+    const quint64 iconCacheGeneration = Win32Utils::iconCacheGeneration();
+    const bool iconsStale = iconCacheGeneration != m_iconCacheGeneration;
+
+    bool iconsRefreshed = true;
+    for (const Candidate &candidate : m_candidates)
+    {
+        iconsRefreshed &= resolveCandidate(candidate, iconsStale);
+    }
+    // Windows rejected by title rules were only counted as filtered in the second phase
+    m_stats.candidates = static_cast<int>(m_results.size());
+
+    // Only remember the generation once every icon was looked up again, so an
+    // interrupted icon refresh continues on the next scan
+    if (iconsRefreshed)
+    {
+        m_iconCacheGeneration = iconCacheGeneration;
+    }
+
+    m_snapshot.finalize();
+    WindowSnapshot::diff(m_previousSnapshot, m_snapshot, m_diff);
+
+    // Drop the references held by the previous results so titles of closed
+    // windows are freed now rather than one scan later
+    m_previous.clear();
+
+    // Forget processes that no longer own any window and were not needed by
+    // the filter in this scan
+    for (auto it = m_processes.begin(); it != m_processes.end();)
+    {
+        if (it.value()->ref.loadRelaxed() == 1 && it.value()->lastUsedScan != m_scanGeneration)
+        {
+            it = m_processes.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    return m_results;
 }
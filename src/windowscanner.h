@@ -1,22 +1,72 @@
 #ifndef WINDOWSCANNER_H
 #define WINDOWSCANNER_H
 
+#include "win32utils.h"
+#include "windowfilter.h"
+#include "windowsnapshot.h"
+#include <QElapsedTimer>
+#include <QExplicitlySharedDataPointer>
+#include <QHash>
 #include <QList>
+#include <QSharedData>
 #include <QString>
-#include <QIcon>
 #include <Windows.h>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Process information shared by every window of the same process
+ *
+ * Records are interned per process ID by WindowScanner, so twenty windows of one
+ * process hold twenty references to a single name/path pair instead of copies.
+ * The path is only needed to launch a new instance, so it is resolved on the
+ * first call to WindowInfo::processPath() rather than during the scan.
+ */
+struct ProcessRecord : public QSharedData
+{
+    DWORD processId = 0;
+    QString name;
+    mutable QString path;
+    mutable bool pathResolved = false;
+    quint64 lastUsedScan = 0; ///< Scanner bookkeeping for pruning
+    int frecencyRank = 0;            ///< Cached FrecencyRanker::rank() of the name
+    quint64 frecencyRevision = 0;    ///< FrecencyRanker::revision() the rank was read at
+};
 
 /**
  * @brief Structure holding information about a window
+ *
+ * Kept deliberately small: strings that are identical across windows of one
+ * process live in a shared ProcessRecord and the icon is referenced by ID, so
+ * copying a WindowInfo during sorting and diffing only touches two reference counts.
  */
 struct WindowInfo
 {
-    HWND hwnd;
+    using ProcessRef = QExplicitlySharedDataPointer<ProcessRecord>;
+
+    HWND hwnd = nullptr;
+    DWORD processId = 0;
+    Win32Utils::IconId iconId = Win32Utils::NoIcon;
     QString title;
-    QIcon icon;
-    QString processName;
-    DWORD processId;
-    QString processPath;
+    ProcessRef process;
+
+    /**
+     * @brief Get the name of the owning process
+     * @return Process name, or an empty string if unknown
+     */
+    const QString &processName() const;
+
+    /**
+     * @brief Get the executable path of the owning process, resolving it on first use
+     * @return Process path, or an empty string if unknown
+     */
+    const QString &processPath() const;
+
+    /**
+     * @brief Get the window icon
+     * @return Icon from the icon cache, or a null QIcon if not available
+     */
+    QIcon icon() const { return Win32Utils::iconById(iconId); }
 
     bool operator==(const WindowInfo &other) const
     {
@@ -26,16 +76,154 @@ struct WindowInfo
 };
 
 /**
- * @brief Utility class for scanning open windows
+ * @brief Scans open windows into storage that is reused across scans
+ *
+ * A scan runs in two phases. The EnumWindows callback only collects the cheap
+ * attributes of each relevant window (HWND and PID) and reads no titles. The
+ * second phase reads the title of each remaining window into a reused buffer,
+ * compares it against the previous scan and runs the expensive process and
+ * icon queries only for windows that are new or whose process or title changed;
+ * everything else is copied from the previous results, which only bumps
+ * reference counts. All buffers keep their capacity between scans, so a
+ * steady-state scan makes close to zero heap allocations.
+ *
+ * Windows hidden by the user's [Filter] rules are rejected during the first
+ * phase where the rules allow; title rules are applied in the second phase,
+ * before the process or icon of a new window is queried.
+ *
+ * The second phase runs under a time budget (WindowScanner/RefreshBudgetMs).
+ * Windows that still need queries when it runs out keep their previous record,
+ * or get a placeholder if they are new, and are resolved on a later scan.
  */
 class WindowScanner
 {
 public:
     /**
-     * @brief Get a list of all visible windows
-     * @return List of WindowInfo objects for visible windows
+     * @brief Counters describing the last scan
+     */
+    struct ScanStats
+    {
+        int candidates = 0; ///< Relevant windows that passed the [Filter] rules
+        int resolved = 0;   ///< Windows that needed process/title/icon queries
+        int deferred = 0;   ///< Windows left for the next scan because the time budget ran out
+        int filtered = 0;   ///< Windows hidden by the [Filter] rules
+    };
+
+    /**
+     * @brief Construct a scanner using the filter rules from Settings.ini
+     */
+    WindowScanner();
+
+    /**
+     * @brief Recompile the [Filter] rules after Settings.ini changed; applies from the next scan
+     */
+    void reloadFilter() { m_filter = WindowFilter::fromSettings(); }
+
+    /**
+     * @brief Ignore the time budget and resolve every window in each scan
+     * @param unbounded true for one-shot scans that must not leave placeholders
+     */
+    void setUnbounded(bool unbounded) { m_unbounded = unbounded; }
+
+    /**
+     * @brief Scan all visible windows
+     * @return Reference to the scan results, valid until the next call to scan().
+     *         The caller may reorder the list in place.
+     */
+    QList<WindowInfo> &scan();
+
+    /**
+     * @brief Get the struct-of-arrays summary of the last scan
+     * @return Snapshot sorted by window handle
      */
-    static QList<WindowInfo> getWindows();
+    const WindowSnapshot &snapshot() const { return m_snapshot; }
+
+    /**
+     * @brief Get the differences between the last two scans
+     * @return Added, removed and changed window handles
+     */
+    const SnapshotDiff &lastDiff() const { return m_diff; }
+
+    /**
+     * @brief Get counters for the last scan
+     * @return Scan statistics
+     */
+    const ScanStats &lastStats() const { return m_stats; }
+
+private:
+    friend BOOL CALLBACK EnumWindowsProc(HWND hwnd, LPARAM lParam);
+
+    /**
+     * @brief Cheap per-window attributes collected by the first phase
+     */
+    struct Candidate
+    {
+        HWND hwnd;
+        DWORD processId;
+        bool included;          ///< A [Filter] include rule matched in the first phase
+        bool titleRulesPending; ///< Title rules and the include check run in the second phase
+    };
+
+    /**
+     * @brief First phase: record one enumerated window's cheap attributes
+     * @param hwnd Window handle reported by EnumWindows
+     */
+    void collectCandidate(HWND hwnd);
+
+    /**
+     * @brief Second phase: turn a candidate into a result, querying only what changed
+     * @param candidate Attributes collected by the first phase
+     * @param iconsStale true if the icon cache was cleared since the last scan
+     * @return false if an icon lookup was skipped because the time budget ran out
+     */
+    bool resolveCandidate(const Candidate &candidate, bool iconsStale);
+
+    /**
+     * @brief Check whether the per-scan time budget is used up
+     * @return true if expensive queries should be deferred
+     */
+    bool budgetExhausted() const;
+
+    /**
+     * @brief Find a window in the previous scan's results
+     * @param hwnd Window handle to look up
+     * @return Pointer into the previous results, or nullptr if not found
+     */
+    const WindowInfo *findPrevious(HWND hwnd) const;
+
+    /**
+     * @brief Get the shared process record for a process ID, querying it on first use
+     * @param processId Process ID
+     * @return Shared process record
+     */
+    WindowInfo::ProcessRef internProcess(DWORD processId);
+
+    static constexpr int MaxClassNameLength = 256;
+
+    WindowFilter m_filter;
+
+    // Title of the candidate being resolved; keeps its capacity across scans
+    std::vector<WCHAR> m_titleBuffer;
+    std::vector<Candidate> m_candidates;
+    int m_maxTitleLength = 0;
+    QElapsedTimer m_scanTimer;
+    int m_budgetMs = 0;
+    bool m_unbounded = false;
+
+    // Interned process records keyed by process ID. A record that no window
+    // references any more is dropped so a reused PID is queried again.
+    QHash<DWORD, WindowInfo::ProcessRef> m_processes;
+    quint64 m_scanGeneration = 0;
+    quint64 m_iconCacheGeneration = 0;
+
+    WindowSnapshot m_snapshot;
+    WindowSnapshot m_previousSnapshot;
+    SnapshotDiff m_diff;
+    ScanStats m_stats;
+    QList<WindowInfo> m_results;
+    QList<WindowInfo> m_previous;
+    // Previous results sorted by HWND for binary search
+    std::vector<std::pair<HWND, qsizetype>> m_previousIndex;
 };
 
 #endif // WINDOWSCANNER_H
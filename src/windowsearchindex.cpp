@@ -0,0 +1,159 @@
+#include "windowsearchindex.h"
+
+namespace
+{
+    constexpr int PrefixScore = 4000;
+    constexpr int WordPrefixScore = 3000;
+    constexpr int SubstringScore = 2000;
+    constexpr int FuzzyScore = 1000;
+    constexpr int MaxPenalty = 999;
+
+    bool isWordStart(QStringView text, qsizetype index)
+    {
+        return index == 0 || !text.at(index - 1).isLetterOrNumber();
+    }
+
+    int penalty(qsizetype value)
+    {
+        return static_cast<int>(qMin<qsizetype>(value, MaxPenalty));
+    }
+}
+
+void WindowSearchIndex::upsert(quintptr handle, QStringView title, QStringView processName)
+{
+    // Title and process name are searched as one text; the separator cannot
+    // be typed into the search box, so prefix and substring matches never span both
+    QString text;
+    text.reserve(title.size() + 1 + processName.size());
+    text.append(title);
+    text.append(QChar('\n'));
+    text.append(processName);
+    text = std::move(text).toCaseFolded();
+
+    auto it = m_positions.constFind(handle);
+    if (it != m_positions.constEnd())
+    {
+        if (m_texts[it.value()] == text)
+        {
+            return;
+        }
+        m_texts[it.value()] = std::move(text);
+    }
+    else
+    {
+        m_positions.insert(handle, m_handles.size());
+        m_handles.push_back(handle);
+        m_texts.push_back(std::move(text));
+    }
+    m_changedSinceSearch = true;
+}
+
+void WindowSearchIndex::remove(quintptr handle)
+{
+    auto it = m_positions.find(handle);
+    if (it == m_positions.end())
+    {
+        return;
+    }
+
+    const size_t position = it.value();
+    const size_t last = m_handles.size() - 1;
+    m_positions.erase(it);
+    if (position != last)
+    {
+        m_handles[position] = m_handles[last];
+        m_texts[position] = std::move(m_texts[last]);
+        m_positions[m_handles[position]] = position;
+    }
+    m_handles.pop_back();
+    m_texts.pop_back();
+    m_changedSinceSearch = true;
+}
+
+const std::vector<WindowSearchIndex::Match> &WindowSearchIndex::search(QStringView query)
+{
+    m_matches.clear();
+    if (query.isEmpty())
+    {
+        m_lastQuery.clear();
+        m_lastPositions.clear();
+        return m_matches;
+    }
+
+    const QString folded = query.toString().toCaseFolded();
+    const bool narrowing = !m_changedSinceSearch && !m_lastQuery.isEmpty() &&
+                           folded.startsWith(m_lastQuery);
+
+    std::vector<size_t> positions;
+    positions.reserve(narrowing ? m_lastPositions.size() : m_handles.size());
+
+    auto evaluate = [&](size_t position)
+    {
+        const int value = score(m_texts[position], folded);
+        if (value > 0)
+        {
+            positions.push_back(position);
+            m_matches.push_back(Match{m_handles[position], value});
+        }
+    };
+
+    if (narrowing)
+    {
+        for (size_t position : m_lastPositions)
+        {
+            evaluate(position);
+        }
+    }
+    else
+    {
+        for (size_t position = 0; position < m_handles.size(); ++position)
+        {
+            evaluate(position);
+        }
+    }
+
+    m_lastQuery = folded;
+    m_lastPositions.swap(positions);
+    m_changedSinceSearch = false;
+    return m_matches;
+}
+
+int WindowSearchIndex::score(QStringView text, QStringView query)
+{
+    const qsizetype found = text.indexOf(query);
+    if (found == 0)
+    {
+        return PrefixScore + MaxPenalty - penalty(text.size());
+    }
+    if (found > 0)
+    {
+        // Look for a later occurrence at a word start before settling for a substring
+        for (qsizetype from = found; from >= 0; from = text.indexOf(query, from + 1))
+        {
+            if (isWordStart(text, from))
+            {
+                return WordPrefixScore + MaxPenalty - penalty(from);
+            }
+        }
+        return SubstringScore + MaxPenalty - penalty(found);
+    }
+
+    // Fuzzy: every query character in order, penalized by the gaps between them
+    qsizetype position = 0;
+    qsizetype first = -1;
+    for (QChar c : query)
+    {
+        position = text.indexOf(c, position);
+        if (position < 0)
+        {
+            return 0;
+        }
+        if (first < 0)
+        {
+            first = position;
+        }
+        ++position;
+    }
+    const qsizetype gaps = (position - first) - query.size();
+    return FuzzyScore + MaxPenalty - penalty(gaps + first);
+}
@@ -0,0 +1,83 @@
+#ifndef WINDOWSEARCHINDEX_H
+#define WINDOWSEARCHINDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QStringView>
+#include <vector>
+
+/**
+ * @brief Case-insensitive search over window titles and process names
+ *
+ * The index is maintained entry by entry as tiles are created, retitled and
+ * removed, and keeps every text case-folded so a keystroke only has to fold the
+ * query. When a query extends the previous one and the index did not change in
+ * between, only the previous matches are examined: every match kind implies a
+ * subsequence match, so a longer query can never match an entry the shorter one
+ * rejected. The class has no Win32 dependency; handles are stored as integers.
+ */
+class WindowSearchIndex
+{
+public:
+    /**
+     * @brief One matching window
+     */
+    struct Match
+    {
+        quintptr handle;
+        int score; ///< Higher is better; see score()
+    };
+
+    /**
+     * @brief Add a window or replace its text
+     * @param handle Window handle
+     * @param title Window title
+     * @param processName Process executable name
+     */
+    void upsert(quintptr handle, QStringView title, QStringView processName);
+
+    /**
+     * @brief Remove a window; unknown handles are ignored
+     * @param handle Window handle
+     */
+    void remove(quintptr handle);
+
+    /**
+     * @brief Get the number of indexed windows
+     * @return Window count
+     */
+    size_t size() const { return m_handles.size(); }
+
+    /**
+     * @brief Find the windows matching a query
+     * @param query Text typed by the user; an empty query matches nothing
+     * @return Matches in index order, valid until the next call
+     */
+    const std::vector<Match> &search(QStringView query);
+
+    /**
+     * @brief Score a case-folded text against a case-folded query
+     *
+     * Prefix of the text > prefix of a word > substring > fuzzy (all query
+     * characters in order), earlier and tighter matches scoring higher within
+     * each kind.
+     * @param text Case-folded text
+     * @param query Case-folded, non-empty query
+     * @return Score greater than 0, or 0 if the text does not match
+     */
+    static int score(QStringView text, QStringView query);
+
+private:
+    // Index-aligned arrays; removal swaps the last entry into the hole
+    std::vector<quintptr> m_handles;
+    std::vector<QString> m_texts;
+    QHash<quintptr, size_t> m_positions;
+
+    // State of the previous search for incremental narrowing
+    QString m_lastQuery;
+    std::vector<size_t> m_lastPositions;
+    std::vector<Match> m_matches;
+    bool m_changedSinceSearch = true;
+};
+
+#endif // WINDOWSEARCHINDEX_H
@@ -0,0 +1,125 @@
+#include "windowsnapshot.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    template <typename T>
+    bool sameContents(const std::vector<T> &a, const std::vector<T> &b)
+    {
+        return a.size() == b.size() &&
+               (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+    }
+}
+
+void SnapshotDiff::clear()
+{
+    added.clear();
+    removed.clear();
+    changed.clear();
+}
+
+void WindowSnapshot::clear()
+{
+    m_pending.clear();
+    m_handles.clear();
+    m_attributes.clear();
+    m_changed.clear();
+    m_changedCount = 0;
+}
+
+void WindowSnapshot::reserve(size_t count)
+{
+    m_pending.reserve(count);
+    m_handles.reserve(count);
+    m_attributes.reserve(count);
+    m_changed.reserve(count);
+}
+
+void WindowSnapshot::append(quintptr handle, quint32 processId, quint32 iconId, bool changed)
+{
+    m_pending.push_back(Entry{handle, (quint64(processId) << 32) | iconId, changed});
+}
+
+void WindowSnapshot::finalize()
+{
+    std::sort(m_pending.begin(), m_pending.end(),
+              [](const Entry &a, const Entry &b) { return a.handle < b.handle; });
+
+    m_handles.clear();
+    m_attributes.clear();
+    m_changed.clear();
+    m_changedCount = 0;
+    for (const Entry &entry : m_pending)
+    {
+        m_handles.push_back(entry.handle);
+        m_attributes.push_back(entry.attributes);
+        m_changed.push_back(entry.changed ? 1 : 0);
+        m_changedCount += entry.changed ? 1 : 0;
+    }
+    m_pending.clear();
+}
+
+void WindowSnapshot::swap(WindowSnapshot &other) noexcept
+{
+    m_pending.swap(other.m_pending);
+    m_handles.swap(other.m_handles);
+    m_attributes.swap(other.m_attributes);
+    m_changed.swap(other.m_changed);
+    std::swap(m_changedCount, other.m_changedCount);
+}
+
+void WindowSnapshot::diff(const WindowSnapshot &before, const WindowSnapshot &after, SnapshotDiff &diff)
+{
+    diff.clear();
+
+    // Fast path for the common steady-state refresh: two block compares over
+    // contiguous arrays, which the C runtime vectorizes
+    if (sameContents(before.m_handles, after.m_handles))
+    {
+        if (after.m_changedCount == 0 && sameContents(before.m_attributes, after.m_attributes))
+        {
+            return;
+        }
+        for (size_t i = 0; i < after.m_handles.size(); ++i)
+        {
+            if (after.m_changed[i] || before.m_attributes[i] != after.m_attributes[i])
+            {
+                diff.changed.push_back(after.m_handles[i]);
+            }
+        }
+        return;
+    }
+
+    // Sorted merge of the two handle arrays
+    size_t i = 0;
+    size_t j = 0;
+    const size_t beforeSize = before.m_handles.size();
+    const size_t afterSize = after.m_handles.size();
+    while (i < beforeSize && j < afterSize)
+    {
+        const quintptr oldHandle = before.m_handles[i];
+        const quintptr newHandle = after.m_handles[j];
+        if (oldHandle < newHandle)
+        {
+            diff.removed.push_back(oldHandle);
+            ++i;
+        }
+        else if (newHandle < oldHandle)
+        {
+            diff.added.push_back(newHandle);
+            ++j;
+        }
+        else
+        {
+            if (after.m_changed[j] || before.m_attributes[i] != after.m_attributes[j])
+            {
+                diff.changed.push_back(newHandle);
+            }
+            ++i;
+            ++j;
+        }
+    }
+    diff.removed.insert(diff.removed.end(), before.m_handles.begin() + i, before.m_handles.end());
+    diff.added.insert(diff.added.end(), after.m_handles.begin() + j, after.m_handles.end());
+}
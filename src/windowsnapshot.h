@@ -0,0 +1,118 @@
+#ifndef WINDOWSNAPSHOT_H
+#define WINDOWSNAPSHOT_H
+
+#include <QtGlobal>
+#include <vector>
+
+/**
+ * @brief Differences between two window snapshots
+ *
+ * Each list holds window handles in ascending order.
+ */
+struct SnapshotDiff
+{
+    std::vector<quintptr> added;
+    std::vector<quintptr> removed;
+    std::vector<quintptr> changed;
+
+    /**
+     * @brief Check whether the snapshots were identical
+     * @return true if nothing was added, removed or changed
+     */
+    bool isEmpty() const { return added.empty() && removed.empty() && changed.empty(); }
+
+    /**
+     * @brief Clear all lists while keeping their capacity
+     */
+    void clear();
+};
+
+/**
+ * @brief Struct-of-arrays summary of one window scan, sorted by window handle
+ *
+ * Only the fields needed to detect changes are kept, each in its own contiguous
+ * array, so two snapshots can be compared with a linear merge (or a single
+ * memcmp when nothing changed) without touching the full WindowInfo records.
+ * Titles are not stored: the scanner already compares every title with the
+ * previous record and passes the result in as a flag, so a title change is
+ * never missed through a hash collision.
+ * The class has no Win32 dependency; handles are stored as integers.
+ */
+class WindowSnapshot
+{
+public:
+    /**
+     * @brief Remove all entries while keeping the storage capacity
+     */
+    void clear();
+
+    /**
+     * @brief Reserve storage for a number of windows
+     * @param count Expected number of windows
+     */
+    void reserve(size_t count);
+
+    /**
+     * @brief Add a window; entries may be added in any order
+     * @param handle Window handle
+     * @param processId Owning process ID
+     * @param iconId ID of the cached icon
+     * @param changed true if the title or process differs from the window's record in the previous scan
+     */
+    void append(quintptr handle, quint32 processId, quint32 iconId, bool changed);
+
+    /**
+     * @brief Sort the entries by handle; call once after the last append()
+     */
+    void finalize();
+
+    /**
+     * @brief Get the number of windows
+     * @return Window count
+     */
+    size_t size() const { return m_handles.size(); }
+
+    const std::vector<quintptr> &handles() const { return m_handles; }
+
+    /**
+     * @brief Per-window process ID (high half) and icon ID (low half), compared exactly
+     */
+    const std::vector<quint64> &attributes() const { return m_attributes; }
+
+    /**
+     * @brief Per-window changed flag as passed to append()
+     */
+    const std::vector<quint8> &changedFlags() const { return m_changed; }
+
+    /**
+     * @brief Swap contents with another snapshot
+     * @param other Snapshot to swap with
+     */
+    void swap(WindowSnapshot &other) noexcept;
+
+    /**
+     * @brief Compute the differences between two snapshots
+     * @param before Older snapshot
+     * @param after Newer snapshot
+     * @param diff Receives the result; its previous contents are discarded
+     */
+    static void diff(const WindowSnapshot &before, const WindowSnapshot &after, SnapshotDiff &diff);
+
+private:
+    struct Entry
+    {
+        quintptr handle;
+        quint64 attributes;
+        bool changed;
+    };
+
+    // Unsorted entries collected during a scan; retained to avoid reallocation
+    std::vector<Entry> m_pending;
+
+    std::vector<quintptr> m_handles;
+    std::vector<quint64> m_attributes;
+    std::vector<quint8> m_changed; ///< Bytes rather than std::vector<bool>, for direct indexing
+    size_t m_changedCount = 0;
+};
+
+#endif // WINDOWSNAPSHOT_H
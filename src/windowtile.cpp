@@ -1,8 +1,10 @@
 #include "windowtile.h"
 #include "config.h"
+#include "lazyfieldstats.h"
 #include <QAction>
 #include <QHBoxLayout>
 #include <QMenu>
+#include <QToolTip>
 
 WindowTile::WindowTile(const WindowInfo &info, QWidget *parent)
     : QWidget(parent), m_info(info)
@@ -10,47 +12,111 @@ WindowTile::WindowTile(const WindowInfo &info, QWidget *parent)
     setupUi();
     setupStyle();
     setCursor(Qt::PointingHandCursor);
-    // Set a fixed height for consistency, width can be flexible or fixed
-    setFixedHeight(WinSelectorConfig::WindowTile::height());
-    setFixedWidth(WinSelectorConfig::WindowTile::width()); // Initial fixed width, can be adjusted
 }
 
 QSize WindowTile::sizeHint() const
 {
     // Return the fixed size for proper layout calculations
-    return QSize(WinSelectorConfig::WindowTile::width(), WinSelectorConfig::WindowTile::height());
+    const SettingsValues &config = WinSelectorConfig::snapshot();
+    return QSize(config.tileWidth, config.tileHeight);
+}
+
+void WindowTile::applySettings()
+{
+    const SettingsValues &config = WinSelectorConfig::snapshot();
+    // Fixed size for consistent columns in the flow layout
+    setFixedSize(config.tileWidth, config.tileHeight);
+    layout()->setContentsMargins(config.tileContentMargin, config.tileContentMargin,
+                                 config.tileContentMargin, config.tileContentMargin);
+    layout()->setSpacing(config.tileInternalSpacing);
+    m_iconLabel->setFixedSize(config.tileIconSize, config.tileIconSize);
+
+    // Render the icon and the elided title again for the new size
+    m_labelsInitialized = false;
+    setInfo(m_info);
 }
 
 void WindowTile::setInfo(const WindowInfo &info)
 {
+    // Tiles are refreshed every cycle; only touch the labels when the visible
+    // content actually changed so an idle refresh does not allocate.
+    const bool iconChanged = !m_labelsInitialized || info.iconId != m_info.iconId;
+    const bool titleChanged = !m_labelsInitialized || info.title != m_info.title;
+
     m_info = info;
+    m_labelsInitialized = true;
+    if (!iconChanged && !titleChanged)
+    {
+        return;
+    }
 
-    if (!m_info.icon.isNull())
+    const SettingsValues &config = WinSelectorConfig::snapshot();
+    if (iconChanged)
     {
-        m_iconLabel->setPixmap(m_info.icon.pixmap(WinSelectorConfig::WindowTile::iconSize(), WinSelectorConfig::WindowTile::iconSize()));
+        const QIcon icon = m_info.icon();
+        if (!icon.isNull())
+        {
+            m_iconLabel->setPixmap(icon.pixmap(config.tileIconSize, config.tileIconSize));
+        }
+        else
+        {
+            m_iconLabel->setText("?");
+        }
     }
-    else
+
+    if (titleChanged)
     {
-        m_iconLabel->setText("?");
+        updateTitle();
+        // The full title is shown by event() when a tooltip is actually requested
+        LazyFieldStats::deferred(LazyFieldStats::Field::Tooltip);
+        m_tooltipRequested = false;
     }
+}
 
+void WindowTile::updateTitle()
+{
+    const SettingsValues &config = WinSelectorConfig::snapshot();
     // Calculate available width for title
     // Fixed width - margins(left+right) - spacing - icon
-    int availableWidth = WinSelectorConfig::WindowTile::width() - (WinSelectorConfig::WindowTile::contentMargin() * 2) - WinSelectorConfig::WindowTile::internalSpacing() - WinSelectorConfig::WindowTile::iconSize();
+    int availableWidth = config.tileWidth - (config.tileContentMargin * 2) - config.tileInternalSpacing - config.tileIconSize;
+    if (m_badgeLabel)
+    {
+        availableWidth -= config.tileInternalSpacing + m_badgeLabel->sizeHint().width();
+    }
     QFontMetrics metrics(m_titleLabel->font());
-    QString elidedTitle = metrics.elidedText(m_info.title, Qt::ElideRight, availableWidth);
+    QString elidedTitle = metrics.elidedText(m_info.title, Qt::ElideRight, qMax(0, availableWidth));
     m_titleLabel->setText(elidedTitle);
-    m_titleLabel->setToolTip(m_info.title);
+}
+
+void WindowTile::setGroup(int count, bool expanded)
+{
+    if (count == m_groupCount && expanded == m_groupExpanded)
+    {
+        return;
+    }
+    m_groupCount = count;
+    m_groupExpanded = expanded;
+
+    if (!m_badgeLabel)
+    {
+        m_badgeLabel = new QLabel(this);
+        m_badgeLabel->setObjectName("groupBadge");
+        m_badgeLabel->setAlignment(Qt::AlignCenter);
+        layout()->addWidget(m_badgeLabel);
+    }
+    const int previousWidth = m_badgeLabel->sizeHint().width();
+    m_badgeLabel->setText(QString("%1 %2").arg(QChar(expanded ? 0x25BE : 0x25B8)).arg(count));
+    if (m_labelsInitialized && m_badgeLabel->sizeHint().width() != previousWidth)
+    {
+        updateTitle();
+    }
 }
 
 void WindowTile::setupUi()
 {
     QHBoxLayout *layout = new QHBoxLayout(this);
-    layout->setContentsMargins(WinSelectorConfig::WindowTile::contentMargin(), WinSelectorConfig::WindowTile::contentMargin(), WinSelectorConfig::WindowTile::contentMargin(), WinSelectorConfig::WindowTile::contentMargin());
-    layout->setSpacing(WinSelectorConfig::WindowTile::internalSpacing());
 
     m_iconLabel = new QLabel(this);
-    m_iconLabel->setFixedSize(WinSelectorConfig::WindowTile::iconSize(), WinSelectorConfig::WindowTile::iconSize());
     m_iconLabel->setScaledContents(true);
 
     m_titleLabel = new QLabel(this);
@@ -58,28 +124,73 @@ void WindowTile::setupUi()
     layout->addWidget(m_iconLabel);
     layout->addWidget(m_titleLabel);
 
-    setInfo(m_info);
+    // Sizes, margins and the initial labels
+    applySettings();
 }
 
 void WindowTile::setupStyle()
 {
     // Basic styling
     setAttribute(Qt::WA_StyledBackground, true);
-    
-    QString bgColor = m_isActive ? "#E3F2FD" : "#FFFFFF"; // Light Blue for active
-    QString borderColor = m_isActive ? "#2196F3" : "#ccc"; // Blue for active
-    
-    QString style = QString("WindowTile {"
-                  "   background-color: %1;"
-                  "   border: 1px solid %2;"
-                  "   border-radius: 5px;"
-                  "}"
-                  "WindowTile:hover {"
-                  "   background-color: #F0F0F0;"
-                  "   border-color: #999;"
-                  "}").arg(bgColor, borderColor);
-
-    setStyleSheet(style);
+
+    // Every state combination is built once and shared by every tile
+    static const QString styles[16] = {
+        styleSheetFor(false, false, false, false), styleSheetFor(true, false, false, false),
+        styleSheetFor(false, true, false, false),  styleSheetFor(true, true, false, false),
+        styleSheetFor(false, false, true, false),  styleSheetFor(true, false, true, false),
+        styleSheetFor(false, true, true, false),   styleSheetFor(true, true, true, false),
+        styleSheetFor(false, false, false, true),  styleSheetFor(true, false, false, true),
+        styleSheetFor(false, true, false, true),   styleSheetFor(true, true, false, true),
+        styleSheetFor(false, false, true, true),   styleSheetFor(true, false, true, true),
+        styleSheetFor(false, true, true, true),    styleSheetFor(true, true, true, true)};
+
+    const int index = (m_isActive ? 1 : 0) | (m_isFlashing ? 2 : 0) | (m_isMinimized ? 4 : 0) |
+                      (m_isSelected ? 8 : 0);
+    setStyleSheet(styles[index]);
+}
+
+QString WindowTile::styleSheetFor(bool active, bool flashing, bool minimized, bool selected)
+{
+    // Active wins over an attention request
+    QString bgColor = "#FFFFFF";
+    QString borderColor = "#ccc";
+    if (active)
+    {
+        bgColor = "#E3F2FD";     // Light Blue for active
+        borderColor = "#2196F3"; // Blue for active
+    }
+    else if (flashing)
+    {
+        bgColor = "#FFF3E0";     // Light Orange when the window wants attention
+        borderColor = "#FB8C00";
+    }
+    // The selection shows as a thicker border over any state
+    QString borderWidth = "1px";
+    if (selected)
+    {
+        borderColor = "#7E57C2"; // Purple for selected
+        borderWidth = "2px";
+    }
+    QString textColor = minimized ? "#888" : "#000";
+
+    return QString("WindowTile {"
+                   "   background-color: %1;"
+                   "   border: %4 solid %2;"
+                   "   border-radius: 5px;"
+                   "}"
+                   "WindowTile:hover {"
+                   "   background-color: #F0F0F0;"
+                   "   border-color: #999;"
+                   "}"
+                   "WindowTile QLabel {"
+                   "   color: %3;"
+                   "}"
+                   "WindowTile QLabel#groupBadge {"
+                   "   color: #FFFFFF;"
+                   "   background-color: #78909C;"
+                   "   border-radius: 7px;"
+                   "   padding: 0px 5px;"
+                   "}").arg(bgColor, borderColor, textColor, borderWidth);
 }
 
 void WindowTile::setActive(bool active)
@@ -91,6 +202,33 @@ void WindowTile::setActive(bool active)
     }
 }
 
+void WindowTile::setFlashing(bool flashing)
+{
+    if (m_isFlashing != flashing)
+    {
+        m_isFlashing = flashing;
+        setupStyle();
+    }
+}
+
+void WindowTile::setMinimized(bool minimized)
+{
+    if (m_isMinimized != minimized)
+    {
+        m_isMinimized = minimized;
+        setupStyle();
+    }
+}
+
+void WindowTile::setSelected(bool selected)
+{
+    if (m_isSelected != selected)
+    {
+        m_isSelected = selected;
+        setupStyle();
+    }
+}
+
 void WindowTile::setEnableShiftClickClose(bool enabled)
 {
     m_enableShiftClickClose = enabled;
@@ -102,29 +240,64 @@ void WindowTile::showContextMenu(const QPoint &globalPos)
 
     // "Launch" menu item
     QAction *launchAction = contextMenu.addAction("起動");
-    if (m_info.processPath.isEmpty())
+    if (m_info.processPath().isEmpty())
     {
         launchAction->setEnabled(false);  // Disable if path is not available
     }
     connect(launchAction, &QAction::triggered, this,
             [this]()
-            { emit launchRequested(m_info.processPath); });
+            { emit launchRequested(m_info.processPath()); });
+
+    contextMenu.addSeparator();
+
+    // A group tile applies its operations to every window of the group
+    if (isGroupHeader())
+    {
+        auto addGroupAction = [this, &contextMenu](const char *text, Action action)
+        {
+            connect(contextMenu.addAction(text), &QAction::triggered, this,
+                    [this, action]()
+                    { emit groupActionRequested(m_info.processName(), action); });
+        };
+        addGroupAction("すべて最小化", Action::Minimize);
+        addGroupAction("すべて元に戻す", Action::Restore);
+        addGroupAction("すべて閉じる", Action::Close);
+        contextMenu.exec(globalPos);
+        return;
+    }
+
+    // A selected tile applies its operations to the whole selection
+    auto addAction = [this, &contextMenu](const char *text, Action action)
+    {
+        connect(contextMenu.addAction(text), &QAction::triggered, this,
+                [this, action]()
+                { emit actionRequested(m_info.hwnd, action); });
+    };
+    addAction(m_isSelected ? "選択したウィンドウを最小化" : "最小化", Action::Minimize);
+    addAction(m_isSelected ? "選択したウィンドウを元に戻す" : "元に戻す", Action::Restore);
+    addAction("他のウィンドウをすべて最小化", Action::MinimizeOthers);
 
     // "Close Window" menu item
-    QAction *closeAction = contextMenu.addAction("ウィンドウを閉じる");
-    connect(closeAction, &QAction::triggered, this,
-            [this]()
-            { emit closed(m_info.hwnd); });
+    addAction(m_isSelected ? "選択したウィンドウを閉じる" : "ウィンドウを閉じる", Action::Close);
 
     contextMenu.exec(globalPos);
 }
 
 void WindowTile::mousePressEvent(QMouseEvent *event)
 {
-    if (event->button() == Qt::LeftButton)
+    if (event->button() == Qt::LeftButton && isGroupHeader())
+    {
+        emit groupToggled(m_info.processName());
+    }
+    else if (event->button() == Qt::LeftButton)
     {
+        // Ctrl+Click adds the tile to the selection for the batch operations
+        if (event->modifiers() & Qt::ControlModifier)
+        {
+            emit selectionToggled(m_info.hwnd);
+        }
         // Check if Shift+Click close mode is enabled
-        if (m_enableShiftClickClose && (event->modifiers() & Qt::ShiftModifier))
+        else if (m_enableShiftClickClose && (event->modifiers() & Qt::ShiftModifier))
         {
             emit closed(m_info.hwnd);
         }
@@ -138,3 +311,31 @@ void WindowTile::mousePressEvent(QMouseEvent *event)
         showContextMenu(event->globalPosition().toPoint());
     }
 }
+
+void WindowTile::enterEvent(QEnterEvent *event)
+{
+    emit hoverChanged(m_info.hwnd, true);
+    QWidget::enterEvent(event);
+}
+
+void WindowTile::leaveEvent(QEvent *event)
+{
+    emit hoverChanged(m_info.hwnd, false);
+    QWidget::leaveEvent(event);
+}
+
+bool WindowTile::event(QEvent *event)
+{
+    if (event->type() == QEvent::ToolTip)
+    {
+        if (!m_tooltipRequested)
+        {
+            LazyFieldStats::requested(LazyFieldStats::Field::Tooltip);
+            m_tooltipRequested = true;
+        }
+        QHelpEvent *helpEvent = static_cast<QHelpEvent *>(event);
+        QToolTip::showText(helpEvent->globalPos(), m_info.title, this);
+        return true;
+    }
+    return QWidget::event(event);
+}
@@ -15,6 +15,17 @@ class WindowTile : public QWidget
 {
     Q_OBJECT
 public:
+    /**
+     * @brief Operations offered in the context menu for several windows at once
+     */
+    enum class Action
+    {
+        Close,          ///< Close the windows
+        Minimize,       ///< Minimize the windows
+        Restore,        ///< Restore the minimized windows
+        MinimizeOthers  ///< Minimize every listed window except this one
+    };
+
     /**
      * @brief Construct a new WindowTile
      * @param info Window information
@@ -24,9 +35,9 @@ public:
 
     /**
      * @brief Get the window information
-     * @return WindowInfo object
+     * @return Reference to the tile's WindowInfo
      */
-    WindowInfo getInfo() const { return m_info; }
+    const WindowInfo &getInfo() const { return m_info; }
 
     /**
      * @brief Set the window information
@@ -40,6 +51,48 @@ public:
      */
     void setActive(bool active);
 
+    /**
+     * @brief Set whether the window is requesting attention (taskbar flash)
+     * @param flashing true while the window wants attention
+     */
+    void setFlashing(bool flashing);
+
+    /**
+     * @brief Set whether the window is minimized
+     * @param minimized true if minimized
+     */
+    void setMinimized(bool minimized);
+
+    /**
+     * @brief Set whether the tile is part of the multi-selection
+     * @param selected true if selected
+     */
+    void setSelected(bool selected);
+
+    /**
+     * @brief Check whether the tile is part of the multi-selection
+     * @return true if selected
+     */
+    bool isSelected() const { return m_isSelected; }
+
+    /**
+     * @brief Turn the tile into the group tile of a process, or update its badge
+     *
+     * A group tile stands for all windows of its process: it shows the process
+     * name with a window count and toggles the group on click instead of
+     * activating a window. The info passed to setInfo() carries the process name
+     * as title.
+     * @param count Number of windows in the group
+     * @param expanded true if the windows of the group are shown as tiles
+     */
+    void setGroup(int count, bool expanded);
+
+    /**
+     * @brief Check whether the tile is a group tile
+     * @return true if setGroup() was called
+     */
+    bool isGroupHeader() const { return m_groupCount > 0; }
+
     /**
      * @brief Get the preferred size of the tile
      * @return Size hint
@@ -52,7 +105,10 @@ public:
      */
     void setEnableShiftClickClose(bool enabled);
 
-    // Configuration is now handled by Settings class
+    /**
+     * @brief Re-read the tile size, icon size, margins and spacing from the settings
+     */
+    void applySettings();
 
 signals:
     /**
@@ -73,6 +129,41 @@ signals:
      */
     void launchRequested(const QString &processPath);
 
+    /**
+     * @brief Signal emitted when the mouse enters or leaves the tile
+     * @param hwnd Handle of the associated window
+     * @param hovered true on enter, false on leave
+     */
+    void hoverChanged(HWND hwnd, bool hovered);
+
+    /**
+     * @brief Signal emitted when a group tile is clicked
+     * @param processName Process name of the group
+     */
+    void groupToggled(const QString &processName);
+
+    /**
+     * @brief Signal emitted when the tile is Ctrl+clicked to add or remove it from the selection
+     * @param hwnd Handle of the associated window
+     */
+    void selectionToggled(HWND hwnd);
+
+    /**
+     * @brief Signal emitted when a context menu operation is chosen on a window tile
+     *
+     * The operation applies to the whole selection if the tile is selected.
+     * @param hwnd Handle of the associated window
+     * @param action Operation to apply
+     */
+    void actionRequested(HWND hwnd, WindowTile::Action action);
+
+    /**
+     * @brief Signal emitted when a context menu operation is chosen on a group tile
+     * @param processName Process name of the group
+     * @param action Operation to apply to every window of the group
+     */
+    void groupActionRequested(const QString &processName, WindowTile::Action action);
+
 protected:
     /**
      * @brief Handle mouse press events
@@ -80,20 +171,62 @@ protected:
      */
     void mousePressEvent(QMouseEvent *event) override;
 
+    /**
+     * @brief Show the full window title as tooltip when one is requested
+     * @param event Event to handle
+     * @return true if the event was handled
+     */
+    bool event(QEvent *event) override;
+
+    /**
+     * @brief Report the mouse entering the tile (hover preview)
+     * @param event Enter event
+     */
+    void enterEvent(QEnterEvent *event) override;
+
+    /**
+     * @brief Report the mouse leaving the tile
+     * @param event Leave event
+     */
+    void leaveEvent(QEvent *event) override;
+
 private:
     WindowInfo m_info;
     bool m_isActive = false;
+    bool m_isFlashing = false;
+    bool m_isMinimized = false;
+    bool m_isSelected = false;
     bool m_enableShiftClickClose = false;
+    bool m_labelsInitialized = false;
+    bool m_tooltipRequested = false;
+    int m_groupCount = 0;
+    bool m_groupExpanded = false;
     QLabel *m_iconLabel;
     QLabel *m_titleLabel;
+    QLabel *m_badgeLabel = nullptr; ///< Created for group tiles only
 
     void setupUi();
 
+    /**
+     * @brief Elide the title into the space left by the icon and the badge
+     */
+    void updateTitle();
+
     /**
      * @brief Setup the style of the tile
      */
     void setupStyle();
 
+    /**
+     * @brief Build the style sheet for a combination of tile states
+     * @param active true for the active (foreground) style
+     * @param flashing true if the window requests attention
+     * @param minimized true if the window is minimized
+     * @param selected true if the tile is part of the multi-selection
+     * @return Style sheet string
+     */
+    static QString styleSheetFor(bool active, bool flashing, bool minimized, bool selected);
+
     /**
      * @brief Show context menu at the given position
      * @param globalPos Global position where menu should appear
@@ -0,0 +1,104 @@
+#include "activityjournal.h"
+#include <QTemporaryDir>
+#include <QTest>
+#include <vector>
+
+class ActivityJournalTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void recordsRoundTrip();
+    void longTitleIsCutAtCharacterBoundary();
+    void largestRecordFitsSmallestRing();
+};
+
+namespace
+{
+    std::vector<ActivityJournal::Record> readAll(const QString &path)
+    {
+        std::vector<ActivityJournal::Record> records;
+        ActivityJournal::read(path,
+                              [&records](const ActivityJournal::Record &record)
+                              {
+                                  records.push_back(record);
+                                  return true;
+                              });
+        return records;
+    }
+}
+
+void ActivityJournalTest::recordsRoundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("Journal.dat"));
+    {
+        ActivityJournal journal(path);
+        journal.record(ActivityJournal::EventType::Appeared, 0x1a2b, 42, u"Notepad");
+        journal.record(ActivityJournal::EventType::Activated, 0x1a2b, 42);
+        journal.record(ActivityJournal::EventType::Disappeared, 0x1a2b, 42);
+    }
+
+    const std::vector<ActivityJournal::Record> records = readAll(path);
+    QCOMPARE(records.size(), size_t(3));
+    QCOMPARE(records[0].type, ActivityJournal::EventType::Appeared);
+    QCOMPARE(records[0].handle, quint64(0x1a2b));
+    QCOMPARE(records[0].processId, quint32(42));
+    QCOMPARE(records[0].text, QStringLiteral("Notepad"));
+    QCOMPARE(records[1].type, ActivityJournal::EventType::Activated);
+    QVERIFY(records[1].text.isEmpty());
+    QCOMPARE(records[2].type, ActivityJournal::EventType::Disappeared);
+}
+
+void ActivityJournalTest::longTitleIsCutAtCharacterBoundary()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("Journal.dat"));
+
+    // Three UTF-8 bytes per character; MaxTextBytes is not a multiple of three
+    const QString title(ActivityJournal::MaxTextBytes, QChar(u'あ'));
+    {
+        ActivityJournal journal(path);
+        journal.record(ActivityJournal::EventType::TitleChanged, 1, 1, title);
+        journal.record(ActivityJournal::EventType::Activated, 1, 1);
+    }
+
+    const std::vector<ActivityJournal::Record> records = readAll(path);
+    QCOMPARE(records.size(), size_t(2));
+    const QString &stored = records[0].text;
+    QCOMPARE(stored.size(), qsizetype(ActivityJournal::MaxTextBytes / 3));
+    QVERIFY(title.startsWith(stored));
+    QCOMPARE(records[1].type, ActivityJournal::EventType::Activated);
+}
+
+void ActivityJournalTest::largestRecordFitsSmallestRing()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("Journal.dat"));
+
+    // Each record is larger than the requested ring; the ring must grow so
+    // that none of them overwrites itself
+    const QString title(4 * ActivityJournal::MaxTextBytes, QChar(u'x'));
+    {
+        ActivityJournal journal(path, 1);
+        for (int i = 0; i < 5; ++i)
+        {
+            journal.record(ActivityJournal::EventType::Appeared, quint64(i), 7, title);
+        }
+    }
+
+    const std::vector<ActivityJournal::Record> records = readAll(path);
+    QCOMPARE(records.size(), size_t(5));
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        QCOMPARE(records[i].handle, quint64(i));
+        QCOMPARE(records[i].processId, quint32(7));
+        QCOMPARE(records[i].text, title.left(ActivityJournal::MaxTextBytes));
+    }
+}
+
+QTEST_APPLESS_MAIN(ActivityJournalTest)
+#include "tst_activityjournal.moc"
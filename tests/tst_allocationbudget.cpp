@@ -0,0 +1,117 @@
+#include "allocationtracker.h"
+#include "windowsnapshot.h"
+#include <QTest>
+
+/**
+ * @brief Fails when the steady-state part of the scan starts allocating again
+ *
+ * Built with WINSELECTOR_ALLOC_TRACKING, so the counting operator new hooks are active.
+ */
+class AllocationBudgetTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void hooksAreCompiledIn();
+    void steadyStateSnapshotCycleDoesNotAllocate();
+    void changedTitlesDoNotAllocateOnceWarm();
+    void budgetRejectsRegression();
+};
+
+namespace
+{
+    constexpr int WindowCount = 1000;
+
+    // A direct call cannot be elided by the compiler the way a new-expression can
+    void allocateOnce()
+    {
+        ::operator delete(::operator new(16));
+    }
+
+    // Same sequence WindowScanner::scan() runs on its two snapshots
+    void scanCycle(WindowSnapshot &current, WindowSnapshot &previous, SnapshotDiff &diff, bool retitled)
+    {
+        previous.swap(current);
+        current.clear();
+        current.reserve(WindowCount);
+        // EnumWindows reports windows in z-order, not by handle
+        for (int i = WindowCount; i > 0; --i)
+        {
+            current.append(static_cast<quintptr>(i) * 16, static_cast<quint32>(i / 4), static_cast<quint32>(i % 7),
+                           retitled);
+        }
+        current.finalize();
+        WindowSnapshot::diff(previous, current, diff);
+    }
+
+    quint64 measuredCycle(WindowSnapshot &current, WindowSnapshot &previous, SnapshotDiff &diff, bool retitled)
+    {
+        AllocationTracker::beginRefresh();
+        {
+            AllocationTracker::StageScope scope(AllocationTracker::Stage::Scan);
+            scanCycle(current, previous, diff, retitled);
+        }
+        return AllocationTracker::total().allocations;
+    }
+}
+
+void AllocationBudgetTest::hooksAreCompiledIn()
+{
+    QVERIFY(AllocationTracker::isEnabled());
+
+    AllocationTracker::beginRefresh();
+    {
+        AllocationTracker::StageScope scope(AllocationTracker::Stage::Sort);
+        allocateOnce();
+    }
+    QCOMPARE(AllocationTracker::counters(AllocationTracker::Stage::Sort).allocations, quint64(1));
+    QCOMPARE(AllocationTracker::counters(AllocationTracker::Stage::Scan).allocations, quint64(0));
+}
+
+void AllocationBudgetTest::steadyStateSnapshotCycleDoesNotAllocate()
+{
+    WindowSnapshot current;
+    WindowSnapshot previous;
+    SnapshotDiff diff;
+    // Both snapshots have reached their capacity after two scans
+    scanCycle(current, previous, diff, false);
+    scanCycle(current, previous, diff, false);
+
+    QCOMPARE(measuredCycle(current, previous, diff, false), quint64(0));
+    QVERIFY(diff.isEmpty());
+    QVERIFY(AllocationTracker::reportRefresh(true, 0));
+}
+
+void AllocationBudgetTest::changedTitlesDoNotAllocateOnceWarm()
+{
+    WindowSnapshot current;
+    WindowSnapshot previous;
+    SnapshotDiff diff;
+    scanCycle(current, previous, diff, false);
+    scanCycle(current, previous, diff, true);
+    QCOMPARE(diff.changed.size(), size_t(WindowCount));
+
+    // The diff lists keep their capacity as well
+    QCOMPARE(measuredCycle(current, previous, diff, true), quint64(0));
+    QCOMPARE(diff.changed.size(), size_t(WindowCount));
+}
+
+void AllocationBudgetTest::budgetRejectsRegression()
+{
+    AllocationTracker::beginRefresh();
+    {
+        AllocationTracker::StageScope scope(AllocationTracker::Stage::UpdateTiles);
+        for (int i = 0; i < 3; ++i)
+        {
+            allocateOnce();
+        }
+    }
+    QVERIFY(!AllocationTracker::reportRefresh(true, 2));
+    QVERIFY(AllocationTracker::reportRefresh(true, 3));
+    // Only refreshes that changed nothing are held to the budget
+    QVERIFY(AllocationTracker::reportRefresh(false, 2));
+    QVERIFY(AllocationTracker::reportRefresh(true, -1));
+}
+
+QTEST_APPLESS_MAIN(AllocationBudgetTest)
+#include "tst_allocationbudget.moc"
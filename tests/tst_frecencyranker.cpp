@@ -0,0 +1,185 @@
+#include "frecencyranker.h"
+#include <QDataStream>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+class FrecencyRankerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void ordersByFrequencyAndRecency();
+    void activationReportsOrderChange();
+    void ranksMatchFullOrder();
+    void saveAndLoadKeepScores();
+    void loadRescalesOtherHalfLife();
+    void loadRejectsFileWithoutHalfLife();
+};
+
+namespace
+{
+    constexpr double Hour = 3600.0;
+    constexpr qint64 Start = 1700000000;
+
+    bool fuzzyEqual(double a, double b)
+    {
+        return std::isfinite(a) && std::isfinite(b) && std::abs(a - b) <= 1e-9 * std::max(std::abs(a), std::abs(b));
+    }
+}
+
+void FrecencyRankerTest::ordersByFrequencyAndRecency()
+{
+    FrecencyRanker ranker(Hour);
+    ranker.recordActivation(QStringLiteral("often"), Start);
+    ranker.recordActivation(QStringLiteral("often"), Start + 10);
+    ranker.recordActivation(QStringLiteral("often"), Start + 20);
+    ranker.recordActivation(QStringLiteral("once"), Start + 30);
+    QCOMPARE(ranker.rank(QStringLiteral("often")), 0);
+    QCOMPARE(ranker.rank(QStringLiteral("once")), 1);
+    QCOMPARE(ranker.rank(QStringLiteral("never")), FrecencyRanker::Unranked);
+
+    // Three activations a few hours ago count less than one now
+    ranker.recordActivation(QStringLiteral("recent"), Start + qint64(4 * Hour));
+    QCOMPARE(ranker.rank(QStringLiteral("recent")), 0);
+    QVERIFY(fuzzyEqual(ranker.score(QStringLiteral("recent"), Start + qint64(5 * Hour)), 0.5));
+}
+
+void FrecencyRankerTest::activationReportsOrderChange()
+{
+    FrecencyRanker ranker(Hour);
+    const quint64 initial = ranker.revision();
+    QVERIFY(ranker.recordActivation(QStringLiteral("b"), Start));
+    QVERIFY(ranker.recordActivation(QStringLiteral("a"), Start + 5));
+    QVERIFY(ranker.revision() != initial);
+    QCOMPARE(ranker.rank(QStringLiteral("a")), 0);
+
+    // The leader stays ahead, and so does the rest of the order
+    QVERIFY(ranker.recordActivation(QStringLiteral("b"), Start + 10));
+    const quint64 revision = ranker.revision();
+    QVERIFY(!ranker.recordActivation(QStringLiteral("b"), Start + 20));
+    QCOMPARE(ranker.revision(), revision);
+    QCOMPARE(ranker.rank(QStringLiteral("b")), 0);
+    QCOMPARE(ranker.rank(QStringLiteral("a")), 1);
+
+    // A new application is ranked even if it comes last
+    QVERIFY(ranker.recordActivation(QStringLiteral("c"), Start - qint64(48 * Hour)));
+    QCOMPARE(ranker.rank(QStringLiteral("c")), 2);
+    QVERIFY(ranker.revision() != revision);
+}
+
+void FrecencyRankerTest::ranksMatchFullOrder()
+{
+    FrecencyRanker ranker(Hour);
+    QStringList keys;
+    for (int i = 0; i < 40; ++i)
+    {
+        keys.append(QStringLiteral("app%1").arg(i));
+    }
+
+    std::mt19937 random(7);
+    qint64 time = Start;
+    for (int step = 0; step < 2000; ++step)
+    {
+        time += qint64(random() % 600);
+        const QString &key = keys.at(int(random() % keys.size()));
+        const int before = ranker.rank(key);
+        const bool changed = ranker.recordActivation(key, time);
+        QCOMPARE(changed, before == FrecencyRanker::Unranked || ranker.rank(key) < before);
+    }
+
+    // Ranks follow the scores, best first, without gaps
+    std::vector<std::pair<double, QString>> expected;
+    for (const QString &key : keys)
+    {
+        if (ranker.rank(key) != FrecencyRanker::Unranked)
+        {
+            expected.emplace_back(ranker.score(key, time), key);
+        }
+    }
+    std::sort(expected.begin(), expected.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+    QCOMPARE(int(expected.size()), ranker.size());
+    for (int i = 0; i < int(expected.size()); ++i)
+    {
+        QCOMPARE(ranker.rank(expected[size_t(i)].second), i);
+    }
+}
+
+void FrecencyRankerTest::saveAndLoadKeepScores()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("Frecency.dat"));
+
+    FrecencyRanker saved(Hour);
+    saved.recordActivation(QStringLiteral("a"), Start);
+    saved.recordActivation(QStringLiteral("b"), Start + 60);
+    saved.recordActivation(QStringLiteral("b"), Start + 120);
+    QVERIFY(saved.save(path));
+
+    FrecencyRanker loaded(Hour);
+    QVERIFY(loaded.load(path));
+    QCOMPARE(loaded.size(), 2);
+    QCOMPARE(loaded.rank(QStringLiteral("b")), 0);
+    QCOMPARE(loaded.rank(QStringLiteral("a")), 1);
+    const qint64 now = Start + 1000;
+    QVERIFY(fuzzyEqual(loaded.score(QStringLiteral("a"), now), saved.score(QStringLiteral("a"), now)));
+    QVERIFY(fuzzyEqual(loaded.score(QStringLiteral("b"), now), saved.score(QStringLiteral("b"), now)));
+}
+
+void FrecencyRankerTest::loadRescalesOtherHalfLife()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("Frecency.dat"));
+
+    FrecencyRanker saved(Hour);
+    saved.recordActivation(QStringLiteral("a"), Start);
+    saved.recordActivation(QStringLiteral("a"), Start + 100);
+    saved.recordActivation(QStringLiteral("b"), Start + 1800);
+    saved.recordActivation(QStringLiteral("c"), Start + 3600);
+    QVERIFY(saved.save(path));
+
+    FrecencyRanker loaded(24 * Hour);
+    QVERIFY(loaded.load(path));
+    for (const char *key : {"a", "b", "c"})
+    {
+        const QString name = QString::fromLatin1(key);
+        QCOMPARE(loaded.rank(name), saved.rank(name));
+        // Same value at the newest activation, then the new half-life applies
+        const qint64 latest = Start + 3600;
+        const double score = saved.score(name, latest);
+        QVERIFY(fuzzyEqual(loaded.score(name, latest), score));
+        QVERIFY(fuzzyEqual(loaded.score(name, latest + qint64(24 * Hour)), score / 2));
+    }
+}
+
+void FrecencyRankerTest::loadRejectsFileWithoutHalfLife()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("Frecency.dat"));
+
+    // Version 1 layout: magic, version, count, then key/log-score pairs
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QDataStream out(&file);
+        out.setVersion(QDataStream::Qt_6_0);
+        out << quint32(0x57534652) << quint16(1) << quint32(1) << QStringLiteral("old") << 1000.0;
+    }
+
+    FrecencyRanker ranker(Hour);
+    ranker.recordActivation(QStringLiteral("kept"), Start);
+    QVERIFY(!ranker.load(path));
+    QCOMPARE(ranker.size(), 1);
+    QCOMPARE(ranker.rank(QStringLiteral("kept")), 0);
+    QCOMPARE(ranker.rank(QStringLiteral("old")), FrecencyRanker::Unranked);
+}
+
+QTEST_APPLESS_MAIN(FrecencyRankerTest)
+#include "tst_frecencyranker.moc"
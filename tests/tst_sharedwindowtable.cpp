@@ -0,0 +1,206 @@
+#include "sharedwindowtable.h"
+#include <QTest>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Runs the sequence lock with a live writer and concurrent readers
+ *
+ * Every publication is derived from its generation number, so a reader can
+ * tell a torn copy (rows, strings or header from different generations) from
+ * a consistent one.
+ */
+class SharedWindowTableTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void readsPublishedTable();
+    void concurrentReadersNeverSeeTornRows();
+};
+
+namespace
+{
+    // Not the production key, so a running instance is never touched
+    const QString TestKey = QStringLiteral("WinSelector-Test-SharedWindowTable");
+
+    constexpr quint32 Generations = 20000;
+    constexpr int ReaderCount = 3;
+
+    quint32 rowCount(quint32 generation)
+    {
+        return 1 + generation % 64;
+    }
+
+    quint64 handleOf(quint32 generation, quint32 row)
+    {
+        return (quint64(generation) << 16) | row;
+    }
+
+    QString processName(quint32 generation)
+    {
+        static const QString names[] = {QStringLiteral("a.exe"), QStringLiteral("editor.exe"),
+                                        QStringLiteral("very-long-process-name.exe")};
+        return names[generation % 3];
+    }
+
+    // Lengths vary per generation, so the string offsets of the rows move too
+    QString title(quint32 generation, quint32 row)
+    {
+        return QStringLiteral("gen %1 row %2 ").arg(generation).arg(row) +
+               QString(int((generation + row) % 23), QChar(char16_t(u'a' + generation % 26)));
+    }
+
+    void publish(SharedWindowTable &table, quint32 generation)
+    {
+        table.beginPublish();
+        for (quint32 row = 0; row < rowCount(generation); ++row)
+        {
+            table.append(quintptr(handleOf(generation, row)), generation, generation & 7, processName(generation),
+                         title(generation, row));
+        }
+        table.endPublish(quintptr(handleOf(generation, 0)), qint64(generation));
+    }
+
+    // Empty if the snapshot is exactly the publication of one generation
+    QString inconsistency(const SharedWindowTableReader::Snapshot &snapshot)
+    {
+        const quint32 generation = quint32(snapshot.publishedMs);
+        if (snapshot.foreground != handleOf(generation, 0))
+        {
+            return QStringLiteral("foreground of another generation");
+        }
+        if (snapshot.windows.size() != rowCount(generation) || snapshot.truncated)
+        {
+            return QStringLiteral("row count of another generation");
+        }
+        for (quint32 row = 0; row < rowCount(generation); ++row)
+        {
+            const SharedWindowTableReader::Window &window = snapshot.windows[row];
+            if (window.handle != handleOf(generation, row) || window.processId != generation ||
+                window.flags != (generation & 7))
+            {
+                return QStringLiteral("torn row %1 in generation %2").arg(row).arg(generation);
+            }
+            if (window.processName != processName(generation) || window.title != title(generation, row))
+            {
+                return QStringLiteral("torn string in row %1 of generation %2").arg(row).arg(generation);
+            }
+        }
+        return QString();
+    }
+}
+
+void SharedWindowTableTest::readsPublishedTable()
+{
+    SharedWindowTable table;
+    if (!table.create(TestKey))
+    {
+        QSKIP("Shared memory is not available");
+    }
+    publish(table, 5);
+
+    SharedWindowTableReader reader;
+    QVERIFY(reader.attach(TestKey));
+    SharedWindowTableReader::Snapshot snapshot;
+    QVERIFY(reader.read(snapshot));
+    QCOMPARE(snapshot.publishedMs, qint64(5));
+    QCOMPARE(inconsistency(snapshot), QString());
+}
+
+void SharedWindowTableTest::concurrentReadersNeverSeeTornRows()
+{
+    SharedWindowTable table;
+    if (!table.create(TestKey))
+    {
+        QSKIP("Shared memory is not available");
+    }
+    publish(table, 0);
+
+    std::atomic<bool> writing{true};
+    std::atomic<int> attached{0};
+    std::atomic<quint64> consistentReads{0};
+    std::atomic<quint64> busyReads{0};
+    std::mutex errorMutex;
+    QString firstError;
+
+    const auto fail = [&](const QString &error)
+    {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (firstError.isEmpty())
+        {
+            firstError = error;
+        }
+    };
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < ReaderCount; ++i)
+    {
+        readers.emplace_back(
+            [&]()
+            {
+                SharedWindowTableReader reader;
+                const bool ok = reader.attach(TestKey);
+                ++attached;
+                if (!ok)
+                {
+                    fail(QStringLiteral("attach failed"));
+                    return;
+                }
+                SharedWindowTableReader::Snapshot snapshot;
+                qint64 lastGeneration = 0;
+                while (writing.load(std::memory_order_relaxed))
+                {
+                    if (!reader.read(snapshot, 4))
+                    {
+                        ++busyReads;
+                        continue;
+                    }
+                    const QString error = inconsistency(snapshot);
+                    if (!error.isEmpty())
+                    {
+                        fail(error);
+                        return;
+                    }
+                    if (snapshot.publishedMs < lastGeneration)
+                    {
+                        fail(QStringLiteral("generation went backwards"));
+                        return;
+                    }
+                    lastGeneration = snapshot.publishedMs;
+                    ++consistentReads;
+                }
+            });
+    }
+
+    while (attached.load() < ReaderCount)
+    {
+        std::this_thread::yield();
+    }
+    for (quint32 generation = 1; generation <= Generations; ++generation)
+    {
+        publish(table, generation);
+    }
+    writing = false;
+    for (std::thread &reader : readers)
+    {
+        reader.join();
+    }
+
+    QCOMPARE(firstError, QString());
+    QVERIFY(consistentReads.load() > 0);
+    qDebug() << consistentReads.load() << "consistent reads," << busyReads.load() << "retried out";
+
+    // Once the writer is idle, the first attempt succeeds
+    SharedWindowTableReader reader;
+    QVERIFY(reader.attach(TestKey));
+    SharedWindowTableReader::Snapshot snapshot;
+    QVERIFY(reader.read(snapshot, 1));
+    QCOMPARE(snapshot.publishedMs, qint64(Generations));
+    QCOMPARE(inconsistency(snapshot), QString());
+}
+
+QTEST_APPLESS_MAIN(SharedWindowTableTest)
+#include "tst_sharedwindowtable.moc"
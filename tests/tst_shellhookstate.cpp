@@ -0,0 +1,235 @@
+#include "shellhookstate.h"
+#include "windowgroups.h"
+#include <QTest>
+
+class ShellHookStateTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void decodeMapsShellCodes();
+    void activatedMovesForeground();
+    void activatedAnswersFlashAndRestores();
+    void flashIgnoresForegroundWindow();
+    void minimizeChangedSetsAndClearsFlag();
+    void createdClearsStateOfReusedHandle();
+    void destroyedReportsClearedFlags();
+    void destroyedUpdatesGroupCounts();
+    void replacedMovesStateToReplacement();
+    void replacedBeforeReplacingMovesStateToReplacement();
+};
+
+namespace
+{
+    constexpr quintptr WindowA = 0x100;
+    constexpr quintptr WindowB = 0x200;
+    constexpr quintptr WindowC = 0x300;
+
+    ShellHook::Event event(ShellHook::EventType type, quintptr handle, bool minimized = false)
+    {
+        ShellHook::Event result;
+        result.type = type;
+        result.handle = handle;
+        result.minimized = minimized;
+        return result;
+    }
+
+    // Feeds changed windows to the groups the way MainWindow::applyChangedStates() does
+    void syncGroups(WindowGroups &groups, const ShellWindowState &state, const std::vector<quintptr> &changed)
+    {
+        for (quintptr handle : changed)
+        {
+            groups.setFlags(handle, state.flags(handle));
+        }
+    }
+}
+
+void ShellHookStateTest::decodeMapsShellCodes()
+{
+    using ShellHook::EventType;
+    QCOMPARE(ShellHook::decode(ShellHook::WindowCreated, WindowA).type, EventType::Created);
+    QCOMPARE(ShellHook::decode(ShellHook::WindowDestroyed, WindowA).type, EventType::Destroyed);
+    QCOMPARE(ShellHook::decode(ShellHook::WindowActivated, WindowA).type, EventType::Activated);
+    QCOMPARE(ShellHook::decode(ShellHook::RudeAppActivated, WindowA).type, EventType::Activated);
+    QCOMPARE(ShellHook::decode(ShellHook::Flash, WindowA).type, EventType::Flash);
+    QCOMPARE(ShellHook::decode(ShellHook::GetMinRect, WindowA).type, EventType::MinimizeChanged);
+    QCOMPARE(ShellHook::decode(ShellHook::WindowReplacing, WindowA).type, EventType::Replacing);
+    QCOMPARE(ShellHook::decode(ShellHook::WindowReplaced, WindowA).type, EventType::Replaced);
+    // A plain redraw (title change) is picked up by the scan
+    QCOMPARE(ShellHook::decode(ShellHook::Redraw, WindowA).type, EventType::None);
+    QCOMPARE(ShellHook::decode(ShellHook::WindowActivated, WindowB).handle, WindowB);
+}
+
+void ShellHookStateTest::activatedMovesForeground()
+{
+    ShellWindowState state;
+    std::vector<quintptr> changed;
+    state.apply(event(ShellHook::EventType::Activated, WindowA), changed);
+    QCOMPARE(state.foreground(), WindowA);
+    QCOMPARE(state.flags(WindowA), quint8(ShellWindowState::Active));
+    QCOMPARE(changed, std::vector<quintptr>{WindowA});
+
+    changed.clear();
+    state.apply(event(ShellHook::EventType::Activated, WindowB), changed);
+    QCOMPARE(state.foreground(), WindowB);
+    QCOMPARE(state.flags(WindowA), quint8(0));
+    QCOMPARE(state.flags(WindowB), quint8(ShellWindowState::Active));
+    QCOMPARE(changed, (std::vector<quintptr>{WindowA, WindowB}));
+
+    // Activating the foreground window again changes nothing
+    changed.clear();
+    state.apply(event(ShellHook::EventType::Activated, WindowB), changed);
+    QVERIFY(changed.empty());
+}
+
+void ShellHookStateTest::activatedAnswersFlashAndRestores()
+{
+    ShellWindowState state;
+    std::vector<quintptr> changed;
+    state.apply(event(ShellHook::EventType::Flash, WindowA), changed);
+    state.apply(event(ShellHook::EventType::MinimizeChanged, WindowA, true), changed);
+    QCOMPARE(state.flags(WindowA), quint8(ShellWindowState::Flashing | ShellWindowState::Minimized));
+
+    changed.clear();
+    state.apply(event(ShellHook::EventType::Activated, WindowA), changed);
+    QCOMPARE(state.flags(WindowA), quint8(ShellWindowState::Active));
+    QCOMPARE(changed, std::vector<quintptr>{WindowA});
+}
+
+void ShellHookStateTest::flashIgnoresForegroundWindow()
+{
+    ShellWindowState state;
+    std::vector<quintptr> changed;
+    state.apply(event(ShellHook::EventType::Activated, WindowA), changed);
+
+    changed.clear();
+    state.apply(event(ShellHook::EventType::Flash, WindowA), changed);
+    QVERIFY(changed.empty());
+    QCOMPARE(state.flags(WindowA), quint8(ShellWindowState::Active));
+
+    state.apply(event(ShellHook::EventType::Flash, WindowB), changed);
+    QCOMPARE(state.flags(WindowB), quint8(ShellWindowState::Flashing));
+    QCOMPARE(changed, std::vector<quintptr>{WindowB});
+}
+
+void ShellHookStateTest::minimizeChangedSetsAndClearsFlag()
+{
+    ShellWindowState state;
+    std::vector<quintptr> changed;
+    state.apply(event(ShellHook::EventType::MinimizeChanged, WindowA, true), changed);
+    QCOMPARE(state.flags(WindowA), quint8(ShellWindowState::Minimized));
+
+    state.apply(event(ShellHook::EventType::MinimizeChanged, WindowA, false), changed);
+    QCOMPARE(state.flags(WindowA), quint8(0));
+    QCOMPARE(changed, (std::vector<quintptr>{WindowA, WindowA}));
+}
+
+void ShellHookStateTest::createdClearsStateOfReusedHandle()
+{
+    ShellWindowState state;
+    std::vector<quintptr> changed;
+    state.apply(event(ShellHook::EventType::Flash, WindowA), changed);
+
+    // The handle was reused by a new window without a Destroyed notification in between
+    changed.clear();
+    state.apply(event(ShellHook::EventType::Created, WindowA), changed);
+    QCOMPARE(state.flags(WindowA), quint8(0));
+    QCOMPARE(changed, std::vector<quintptr>{WindowA});
+
+    // A created window without state is not reported
+    changed.clear();
+    state.apply(event(ShellHook::EventType::Created, WindowB), changed);
+    QVERIFY(changed.empty());
+}
+
+void ShellHookStateTest::destroyedReportsClearedFlags()
+{
+    ShellWindowState state;
+    std::vector<quintptr> changed;
+    state.apply(event(ShellHook::EventType::Activated, WindowA), changed);
+    state.apply(event(ShellHook::EventType::Flash, WindowB), changed);
+
+    changed.clear();
+    state.apply(event(ShellHook::EventType::Destroyed, WindowA), changed);
+    QCOMPARE(state.flags(WindowA), quint8(0));
+    QCOMPARE(state.foreground(), quintptr(0));
+    QCOMPARE(changed, std::vector<quintptr>{WindowA});
+
+    changed.clear();
+    state.apply(event(ShellHook::EventType::Destroyed, WindowB), changed);
+    QCOMPARE(state.flags(WindowB), quint8(0));
+    QCOMPARE(changed, std::vector<quintptr>{WindowB});
+}
+
+void ShellHookStateTest::destroyedUpdatesGroupCounts()
+{
+    ShellWindowState state;
+    WindowGroups groups;
+    groups.setMinimumSize(2);
+    const QString key = QStringLiteral("editor.exe");
+    groups.add(WindowA, key, 0);
+    groups.add(WindowB, key, 0);
+    groups.add(WindowC, key, 0);
+
+    std::vector<quintptr> changed;
+    state.apply(event(ShellHook::EventType::Activated, WindowA), changed);
+    state.apply(event(ShellHook::EventType::Flash, WindowB), changed);
+    state.apply(event(ShellHook::EventType::MinimizeChanged, WindowB, true), changed);
+    syncGroups(groups, state, changed);
+    QCOMPARE(groups.find(key)->active, 1);
+    QCOMPARE(groups.find(key)->flashing, 1);
+    QCOMPARE(groups.find(key)->minimized, 1);
+    groups.takeDirty();
+
+    changed.clear();
+    state.apply(event(ShellHook::EventType::Destroyed, WindowA), changed);
+    state.apply(event(ShellHook::EventType::Destroyed, WindowB), changed);
+    syncGroups(groups, state, changed);
+    QCOMPARE(groups.find(key)->active, 0);
+    QCOMPARE(groups.find(key)->flashing, 0);
+    QCOMPARE(groups.find(key)->minimized, 0);
+    QCOMPARE(groups.takeDirty(), QList<QString>{key});
+}
+
+void ShellHookStateTest::replacedMovesStateToReplacement()
+{
+    ShellWindowState state;
+    std::vector<quintptr> changed;
+    state.apply(event(ShellHook::EventType::Activated, WindowA), changed);
+    state.apply(event(ShellHook::EventType::Flash, WindowB), changed);
+
+    // WindowC (e.g. the ghost window of a hung WindowA) takes its place
+    changed.clear();
+    state.apply(event(ShellHook::EventType::Replacing, WindowC), changed);
+    QVERIFY(changed.empty());
+    state.apply(event(ShellHook::EventType::Replaced, WindowA), changed);
+    QCOMPARE(state.flags(WindowA), quint8(0));
+    QCOMPARE(state.flags(WindowC), quint8(ShellWindowState::Active));
+    QCOMPARE(state.foreground(), WindowC);
+    QCOMPARE(changed, (std::vector<quintptr>{WindowA, WindowC}));
+    QCOMPARE(state.flags(WindowB), quint8(ShellWindowState::Flashing));
+}
+
+void ShellHookStateTest::replacedBeforeReplacingMovesStateToReplacement()
+{
+    ShellWindowState state;
+    std::vector<quintptr> changed;
+    state.apply(event(ShellHook::EventType::Flash, WindowA), changed);
+
+    changed.clear();
+    state.apply(event(ShellHook::EventType::Replaced, WindowA), changed);
+    QVERIFY(changed.empty());
+    state.apply(event(ShellHook::EventType::Replacing, WindowB), changed);
+    QCOMPARE(state.flags(WindowA), quint8(0));
+    QCOMPARE(state.flags(WindowB), quint8(ShellWindowState::Flashing));
+    QCOMPARE(changed, (std::vector<quintptr>{WindowA, WindowB}));
+
+    // The pair is complete; the next Replacing starts a new one
+    changed.clear();
+    state.apply(event(ShellHook::EventType::Replacing, WindowC), changed);
+    QVERIFY(changed.empty());
+    QCOMPARE(state.flags(WindowB), quint8(ShellWindowState::Flashing));
+}
+
+QTEST_APPLESS_MAIN(ShellHookStateTest)
+#include "tst_shellhookstate.moc"
@@ -0,0 +1,168 @@
+#include "thumbnailservice.h"
+#include <QSignalSpy>
+#include <QTest>
+
+class ThumbnailServiceTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void cacheStaysWithinByteLimit();
+    void capturesAreBoundedAndDropsCounted();
+    void repeatedRequestStartsOneCapture();
+    void downscaleKeepsAspectRatio();
+    void downscaleReturnsFittingImage();
+};
+
+namespace
+{
+    constexpr int MaxSide = 64;
+
+    // 64x36 thumbnails of 9216 bytes; the cache holds three of them
+    const QSize CaptureSize(640, 360);
+    constexpr qsizetype CacheBytes = 3 * 64 * 36 * 4 + 100;
+
+    // The service owns the source; the test keeps a pointer to count its captures
+    struct Fixture
+    {
+        SyntheticThumbnailSource *source = new SyntheticThumbnailSource(CaptureSize);
+        ThumbnailService service{std::unique_ptr<ThumbnailSource>(source), MaxSide, CacheBytes};
+    };
+
+    // The final smooth scale may round a channel by one
+    bool nearColor(QRgb a, QRgb b)
+    {
+        return qAbs(qRed(a) - qRed(b)) <= 1 && qAbs(qGreen(a) - qGreen(b)) <= 1 && qAbs(qBlue(a) - qBlue(b)) <= 1;
+    }
+}
+
+void ThumbnailServiceTest::cacheStaysWithinByteLimit()
+{
+    Fixture fixture;
+    ThumbnailService &service = fixture.service;
+    constexpr int Captures = 40;
+
+    // Keeps the pool full; each capture is a new window, so the cache keeps evicting
+    quintptr nextHandle = 0;
+    int finished = 0;
+    qsizetype peakBytes = 0;
+    const auto feed = [&]()
+    {
+        while (nextHandle < quintptr(Captures) && service.inFlight() < ThumbnailService::MaxInFlight)
+        {
+            service.request(++nextHandle, 0);
+        }
+    };
+    connect(&service, &ThumbnailService::thumbnailReady, this,
+            [&](quintptr)
+            {
+                peakBytes = qMax(peakBytes, service.cache().bytes());
+                ++finished;
+                feed();
+            });
+    feed();
+    QTRY_COMPARE(finished, Captures);
+
+    QVERIFY(peakBytes > 0);
+    QVERIFY(peakBytes <= service.cache().maxBytes());
+    QCOMPARE(service.cache().count(), qsizetype(3));
+    QCOMPARE(service.metrics().dropped, quint64(0));
+    QCOMPARE(service.metrics().captures, quint64(Captures));
+
+    QVERIFY(service.thumbnail(1).isNull());
+
+    // A smaller limit evicts right away
+    service.setCacheBytes(CacheBytes / 3);
+    QVERIFY(service.cache().bytes() <= service.cache().maxBytes());
+    QCOMPARE(service.cache().count(), qsizetype(1));
+}
+
+void ThumbnailServiceTest::capturesAreBoundedAndDropsCounted()
+{
+    Fixture fixture;
+    ThumbnailService &service = fixture.service;
+    service.setCacheBytes(4 * CacheBytes);
+
+    // Results are handed back through the event loop, so nothing finishes
+    // until the test lets it run
+    for (quintptr handle = 1; handle <= 10; ++handle)
+    {
+        service.request(handle, 0);
+        QVERIFY(service.inFlight() <= ThumbnailService::MaxInFlight);
+    }
+    QCOMPARE(service.inFlight(), ThumbnailService::MaxInFlight);
+    QCOMPARE(service.metrics().requests, quint64(10));
+    QCOMPARE(service.metrics().dropped, quint64(10 - ThumbnailService::MaxInFlight));
+
+    QTRY_COMPARE(service.inFlight(), 0);
+    QCOMPARE(service.metrics().captures, quint64(ThumbnailService::MaxInFlight));
+    QCOMPARE(fixture.source->captureCount(), quint64(ThumbnailService::MaxInFlight));
+
+    // Cached thumbnails are hits and start no capture; dropped windows can be requested again
+    service.request(1, 0);
+    QCOMPARE(service.metrics().hits, quint64(1));
+    QCOMPARE(service.inFlight(), 0);
+    service.request(10, 0);
+    QCOMPARE(service.inFlight(), 1);
+    QTRY_COMPARE(service.inFlight(), 0);
+    QCOMPARE(fixture.source->captureCount(), quint64(ThumbnailService::MaxInFlight + 1));
+}
+
+void ThumbnailServiceTest::repeatedRequestStartsOneCapture()
+{
+    Fixture fixture;
+    ThumbnailService &service = fixture.service;
+    QSignalSpy ready(&service, &ThumbnailService::thumbnailReady);
+
+    service.request(7, 0);
+    service.request(7, 0);
+    service.request(7, 0);
+    QCOMPARE(service.inFlight(), 1);
+    QCOMPARE(service.metrics().dropped, quint64(0));
+
+    QTRY_COMPARE(service.inFlight(), 0);
+    QCOMPARE(fixture.source->captureCount(), quint64(1));
+    QCOMPARE(ready.count(), 1);
+    QCOMPARE(ready.at(0).at(0).value<quintptr>(), quintptr(7));
+    QCOMPARE(service.thumbnail(7).size(), QSize(MaxSide, 36));
+
+    // A forgotten window is captured again
+    service.forget(7);
+    QVERIFY(service.thumbnail(7).isNull());
+    service.request(7, 0);
+    QTRY_COMPARE(ready.count(), 2);
+    QCOMPARE(fixture.source->captureCount(), quint64(2));
+}
+
+void ThumbnailServiceTest::downscaleKeepsAspectRatio()
+{
+    QImage wide(1024, 512, QImage::Format_RGB32);
+    wide.fill(qRgb(10, 200, 30));
+    const QImage wideThumbnail = ThumbnailService::downscale(wide, 100);
+    QCOMPARE(wideThumbnail.size(), QSize(100, 50));
+    QVERIFY(nearColor(wideThumbnail.pixel(50, 25), qRgb(10, 200, 30)));
+
+    // Odd sizes: the halving drops the last row or column, the ratio must still hold
+    QImage tall(501, 1203, QImage::Format_ARGB32);
+    tall.fill(Qt::white);
+    const QImage tallThumbnail = ThumbnailService::downscale(tall, 100);
+    QCOMPARE(tallThumbnail.height(), 100);
+    QVERIFY(qAbs(tallThumbnail.width() - 501 * 100 / 1203) <= 1);
+    QCOMPARE(tallThumbnail.format(), QImage::Format_ARGB32_Premultiplied);
+}
+
+void ThumbnailServiceTest::downscaleReturnsFittingImage()
+{
+    QImage image(80, 60, QImage::Format_ARGB32);
+    image.fill(Qt::red);
+    const QImage result = ThumbnailService::downscale(image, 100);
+    QCOMPARE(result.cacheKey(), image.cacheKey());
+    QCOMPARE(result.format(), QImage::Format_ARGB32);
+
+    QImage square(100, 100, QImage::Format_RGB32);
+    square.fill(Qt::blue);
+    QCOMPARE(ThumbnailService::downscale(square, 100).cacheKey(), square.cacheKey());
+}
+
+QTEST_GUILESS_MAIN(ThumbnailServiceTest)
+#include "tst_thumbnailservice.moc"
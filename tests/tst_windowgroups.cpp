@@ -0,0 +1,147 @@
+#include "windowgroups.h"
+#include "shellhookstate.h"
+#include <QTest>
+#include <algorithm>
+
+class WindowGroupsTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void groupsFromMinimumSize();
+    void aggregatesFollowFlags();
+    void removeDropsEmptyGroup();
+    void placeholderJoinsGroupWhenResolved();
+    void renamedWindowMovesBetweenGroups();
+    void sameKeyIsNoChange();
+};
+
+namespace
+{
+    const QString Editor = QStringLiteral("editor.exe");
+    const QString Shell = QStringLiteral("shell.exe");
+
+    QList<QString> sorted(QList<QString> keys)
+    {
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    }
+}
+
+void WindowGroupsTest::groupsFromMinimumSize()
+{
+    WindowGroups groups;
+    groups.setMinimumSize(2);
+    groups.add(1, Editor, 0);
+    QVERIFY(!groups.isCollapsed(1));
+    groups.add(2, Editor, 0);
+    QVERIFY(groups.isGrouped(*groups.find(Editor)));
+    QVERIFY(groups.isCollapsed(1) && groups.isCollapsed(2));
+
+    groups.setExpanded(Editor, true);
+    QVERIFY(!groups.isCollapsed(1));
+
+    // Windows without a process name are never grouped
+    groups.add(3, QString(), 0);
+    QVERIFY(!groups.groupOf(3));
+}
+
+void WindowGroupsTest::aggregatesFollowFlags()
+{
+    WindowGroups groups;
+    groups.setMinimumSize(2);
+    groups.add(1, Editor, ShellWindowState::Minimized);
+    groups.add(2, Editor, 0);
+    groups.takeDirty();
+
+    groups.setFlags(2, ShellWindowState::Minimized | ShellWindowState::Flashing);
+    const WindowGroups::Group *group = groups.find(Editor);
+    QCOMPARE(group->minimized, 2);
+    QCOMPARE(group->flashing, 1);
+    QCOMPARE(groups.takeDirty(), QList<QString>{Editor});
+
+    // Only changes the group tile shows mark it dirty
+    groups.setFlags(2, ShellWindowState::Minimized | ShellWindowState::Flashing | ShellWindowState::Active);
+    QCOMPARE(groups.takeDirty(), QList<QString>{Editor});
+    groups.setFlags(1, ShellWindowState::Minimized | ShellWindowState::Flashing);
+    QVERIFY(groups.takeDirty().isEmpty());
+    QCOMPARE(group->flashing, 2);
+}
+
+void WindowGroupsTest::removeDropsEmptyGroup()
+{
+    WindowGroups groups;
+    groups.setMinimumSize(2);
+    groups.add(1, Editor, ShellWindowState::Active);
+    groups.add(2, Editor, 0);
+    groups.remove(1);
+    QCOMPARE(groups.find(Editor)->count(), 1);
+    QCOMPARE(groups.find(Editor)->active, 0);
+    groups.remove(2);
+    QVERIFY(!groups.find(Editor));
+    QCOMPARE(groups.takeDirty(), QList<QString>{Editor});
+}
+
+void WindowGroupsTest::placeholderJoinsGroupWhenResolved()
+{
+    WindowGroups groups;
+    groups.setMinimumSize(3);
+    groups.add(1, Editor, 0);
+    groups.add(2, Editor, 0);
+    // First scan: the process name was not read within the budget
+    groups.add(3, QString(), ShellWindowState::Flashing);
+    QVERIFY(!groups.groupOf(3));
+    QVERIFY(!groups.isGrouped(*groups.find(Editor)));
+    groups.takeDirty();
+
+    // Next scan resolves it; the group reaches its minimum size
+    QVERIFY(groups.setKey(3, Editor, ShellWindowState::Flashing));
+    const WindowGroups::Group *group = groups.find(Editor);
+    QCOMPARE(group->count(), 3);
+    QCOMPARE(group->flashing, 1);
+    QVERIFY(groups.isGrouped(*group));
+    QVERIFY(groups.isCollapsed(3));
+    QCOMPARE(groups.takeDirty(), QList<QString>{Editor});
+
+    groups.remove(3);
+    QCOMPARE(groups.find(Editor)->flashing, 0);
+}
+
+void WindowGroupsTest::renamedWindowMovesBetweenGroups()
+{
+    WindowGroups groups;
+    groups.setMinimumSize(2);
+    groups.add(1, Editor, ShellWindowState::Active);
+    groups.add(2, Editor, 0);
+    groups.add(3, Shell, 0);
+    groups.takeDirty();
+
+    // The handle was reused by another process
+    QVERIFY(groups.setKey(1, Shell, ShellWindowState::Active));
+    QCOMPARE(groups.groupOf(1), groups.find(Shell));
+    QCOMPARE(groups.find(Editor)->count(), 1);
+    QCOMPARE(groups.find(Editor)->active, 0);
+    QCOMPARE(groups.find(Shell)->count(), 2);
+    QCOMPARE(groups.find(Shell)->active, 1);
+    QCOMPARE(sorted(groups.takeDirty()), (QList<QString>{Editor, Shell}));
+
+    // Leaving for no name at all ungroups it
+    QVERIFY(groups.setKey(1, QString(), ShellWindowState::Active));
+    QVERIFY(!groups.groupOf(1));
+    QCOMPARE(groups.find(Shell)->active, 0);
+    QVERIFY(!groups.isCollapsed(1));
+}
+
+void WindowGroupsTest::sameKeyIsNoChange()
+{
+    WindowGroups groups;
+    groups.setMinimumSize(2);
+    groups.add(1, Editor, 0);
+    groups.takeDirty();
+    QVERIFY(!groups.setKey(1, Editor, 0));
+    QVERIFY(!groups.setKey(2, QString(), 0));
+    QVERIFY(groups.takeDirty().isEmpty());
+}
+
+QTEST_APPLESS_MAIN(WindowGroupsTest)
+#include "tst_windowgroups.moc"
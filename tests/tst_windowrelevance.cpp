@@ -0,0 +1,113 @@
+#include "windowrelevance.h"
+#include <QTest>
+
+class WindowRelevanceTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void unownedWindowIsRelevant();
+    void ownedWindowIsHidden();
+    void windowOwnedByOwnedWindowIsHidden();
+    void visibleOwnerFurtherUpTheChainHidesWindow();
+    void windowOwnedOnlyByHiddenWindowsIsRelevant();
+    void unownedToolWindowIsHidden();
+    void ownedToolWindowIsHidden();
+    void appWindowIsRelevantDespiteOwner();
+    void shellAndCloakedWindowsAreHidden();
+};
+
+namespace
+{
+    WindowAttributes topLevel()
+    {
+        WindowAttributes attributes;
+        attributes.visible = true;
+        attributes.className = u"Notepad";
+        return attributes;
+    }
+
+    // Owner chain, nearest owner first
+    WindowAttributes ownedBy(std::initializer_list<bool> ownersVisible)
+    {
+        WindowAttributes attributes = topLevel();
+        for (bool visible : ownersVisible)
+        {
+            attributes.ownerVisible[attributes.ownerCount++] = visible;
+        }
+        return attributes;
+    }
+}
+
+void WindowRelevanceTest::unownedWindowIsRelevant()
+{
+    QCOMPARE(WindowRelevance::classify(topLevel()), WindowRelevance::Reason::Relevant);
+}
+
+void WindowRelevanceTest::ownedWindowIsHidden()
+{
+    QCOMPARE(WindowRelevance::classify(ownedBy({true})), WindowRelevance::Reason::Owned);
+}
+
+void WindowRelevanceTest::windowOwnedByOwnedWindowIsHidden()
+{
+    // A dialog opened from a dialog of the main window
+    QCOMPARE(WindowRelevance::classify(ownedBy({true, true})), WindowRelevance::Reason::Owned);
+}
+
+void WindowRelevanceTest::visibleOwnerFurtherUpTheChainHidesWindow()
+{
+    // The nearest owner was hidden (e.g. a wizard page), the main window is not
+    QCOMPARE(WindowRelevance::classify(ownedBy({false, true})), WindowRelevance::Reason::Owned);
+    QCOMPARE(WindowRelevance::classify(ownedBy({false, false, false, true})), WindowRelevance::Reason::Owned);
+}
+
+void WindowRelevanceTest::windowOwnedOnlyByHiddenWindowsIsRelevant()
+{
+    // Main window owned by a framework's hidden application window
+    QCOMPARE(WindowRelevance::classify(ownedBy({false})), WindowRelevance::Reason::Relevant);
+    QCOMPARE(WindowRelevance::classify(ownedBy({false, false})), WindowRelevance::Reason::Relevant);
+}
+
+void WindowRelevanceTest::unownedToolWindowIsHidden()
+{
+    WindowAttributes attributes = topLevel();
+    attributes.exStyle = WindowRelevance::ExStyleToolWindow;
+    QCOMPARE(WindowRelevance::classify(attributes), WindowRelevance::Reason::ToolWindow);
+}
+
+void WindowRelevanceTest::ownedToolWindowIsHidden()
+{
+    WindowAttributes attributes = ownedBy({true, true});
+    attributes.exStyle = WindowRelevance::ExStyleToolWindow;
+    QCOMPARE(WindowRelevance::classify(attributes), WindowRelevance::Reason::ToolWindow);
+
+    attributes = ownedBy({false});
+    attributes.exStyle = WindowRelevance::ExStyleToolWindow;
+    QCOMPARE(WindowRelevance::classify(attributes), WindowRelevance::Reason::ToolWindow);
+}
+
+void WindowRelevanceTest::appWindowIsRelevantDespiteOwner()
+{
+    WindowAttributes attributes = ownedBy({true, true});
+    attributes.exStyle = WindowRelevance::ExStyleAppWindow | WindowRelevance::ExStyleToolWindow;
+    QCOMPARE(WindowRelevance::classify(attributes), WindowRelevance::Reason::Relevant);
+}
+
+void WindowRelevanceTest::shellAndCloakedWindowsAreHidden()
+{
+    WindowAttributes attributes = topLevel();
+    attributes.className = u"Shell_TrayWnd";
+    QCOMPARE(WindowRelevance::classify(attributes), WindowRelevance::Reason::ShellWindow);
+
+    attributes = topLevel();
+    attributes.cloakedFlags = WindowRelevance::CloakedShell;
+    QCOMPARE(WindowRelevance::classify(attributes), WindowRelevance::Reason::OtherVirtualDesktop);
+
+    attributes = topLevel();
+    attributes.visible = false;
+    QCOMPARE(WindowRelevance::classify(attributes), WindowRelevance::Reason::Invisible);
+}
+
+QTEST_APPLESS_MAIN(WindowRelevanceTest)
+#include "tst_windowrelevance.moc"
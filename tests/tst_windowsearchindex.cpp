@@ -0,0 +1,168 @@
+#include "windowsearchindex.h"
+#include <QTest>
+#include <algorithm>
+#include <vector>
+
+class WindowSearchIndexTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void scoreRanksMatchKinds();
+    void scoreIgnoresCase();
+    void narrowingKeepsMatchesOfLongerQuery();
+    void upsertAfterSearchRescansIndex();
+    void removeAfterSearchRescansIndex();
+    void removeMovesLastEntryIntoHole();
+};
+
+namespace
+{
+    // Handles of the matches, in ascending order
+    std::vector<quintptr> handles(const std::vector<WindowSearchIndex::Match> &matches)
+    {
+        std::vector<quintptr> result;
+        for (const WindowSearchIndex::Match &match : matches)
+        {
+            result.push_back(match.handle);
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    int scoreOf(const std::vector<WindowSearchIndex::Match> &matches, quintptr handle)
+    {
+        for (const WindowSearchIndex::Match &match : matches)
+        {
+            if (match.handle == handle)
+            {
+                return match.score;
+            }
+        }
+        return 0;
+    }
+
+    void addReports(WindowSearchIndex &index)
+    {
+        index.upsert(1, u"Budget report", u"excel.exe");
+        index.upsert(2, u"Report draft", u"word.exe");
+        index.upsert(3, u"Release notes", u"notepad.exe");
+        index.upsert(4, u"Inbox", u"outlook.exe");
+    }
+}
+
+void WindowSearchIndexTest::scoreRanksMatchKinds()
+{
+    const QString query = QStringLiteral("note");
+    const int prefix = WindowSearchIndex::score(u"notepad", query);
+    const int wordPrefix = WindowSearchIndex::score(u"my notes", query);
+    const int substring = WindowSearchIndex::score(u"keynote", query);
+    const int fuzzy = WindowSearchIndex::score(u"no tea", query);
+    QVERIFY(prefix > wordPrefix);
+    QVERIFY(wordPrefix > substring);
+    QVERIFY(substring > fuzzy);
+    QVERIFY(fuzzy > 0);
+    QCOMPARE(WindowSearchIndex::score(u"tone", query), 0);
+
+    // A later word start beats the first, mid-word occurrence
+    QCOMPARE(WindowSearchIndex::score(u"keynote notes", query), WindowSearchIndex::score(u"keynote-notes", query));
+    QVERIFY(WindowSearchIndex::score(u"keynote notes", query) > WindowSearchIndex::score(u"keynotes", query));
+
+    // Within a kind, earlier and tighter matches score higher
+    QVERIFY(WindowSearchIndex::score(u"a note", query) > WindowSearchIndex::score(u"a long note", query));
+    QVERIFY(WindowSearchIndex::score(u"n o t e", query) > WindowSearchIndex::score(u"n  o  t  e", query));
+}
+
+void WindowSearchIndexTest::scoreIgnoresCase()
+{
+    WindowSearchIndex index;
+    index.upsert(1, u"Notepad", u"notepad.exe");
+    index.upsert(2, u"Inbox - Outlook", u"OUTLOOK.EXE");
+    QCOMPARE(handles(index.search(u"NOTEP")), std::vector<quintptr>{1});
+    QCOMPARE(handles(index.search(u"outlook.exe")), std::vector<quintptr>{2});
+    QVERIFY(index.search(QStringView()).empty());
+}
+
+void WindowSearchIndexTest::narrowingKeepsMatchesOfLongerQuery()
+{
+    WindowSearchIndex index;
+    addReports(index);
+
+    // Each keystroke narrows the previous matches; the result equals a fresh search
+    for (const QString &query : {QStringLiteral("r"), QStringLiteral("re"), QStringLiteral("rep"),
+                                 QStringLiteral("repo"), QStringLiteral("report")})
+    {
+        const std::vector<quintptr> narrowed = handles(index.search(query));
+        WindowSearchIndex fresh;
+        addReports(fresh);
+        QCOMPARE(narrowed, handles(fresh.search(query)));
+    }
+    QCOMPARE(handles(index.search(u"report")), (std::vector<quintptr>{1, 2}));
+    QVERIFY(scoreOf(index.search(u"report"), 2) > scoreOf(index.search(u"report"), 1));
+
+    // A query that does not extend the previous one starts over
+    QCOMPARE(handles(index.search(u"inbox")), std::vector<quintptr>{4});
+}
+
+void WindowSearchIndexTest::upsertAfterSearchRescansIndex()
+{
+    WindowSearchIndex index;
+    index.upsert(1, u"Report", u"word.exe");
+    index.upsert(2, u"Inbox", u"outlook.exe");
+    QCOMPARE(handles(index.search(u"rep")), std::vector<quintptr>{1});
+
+    // The retitled window did not match "rep", but must be found by "repo"
+    index.upsert(2, u"Repository", u"outlook.exe");
+    QCOMPARE(handles(index.search(u"repo")), (std::vector<quintptr>{1, 2}));
+
+    // So must a new window
+    index.upsert(3, u"Repo view", u"git.exe");
+    QCOMPARE(handles(index.search(u"repos")), std::vector<quintptr>{2});
+    QCOMPARE(handles(index.search(u"repo")), (std::vector<quintptr>{1, 2, 3}));
+
+    // An unchanged upsert keeps the previous matches for narrowing
+    index.upsert(3, u"Repo view", u"git.exe");
+    QCOMPARE(handles(index.search(u"repo v")), std::vector<quintptr>{3});
+}
+
+void WindowSearchIndexTest::removeAfterSearchRescansIndex()
+{
+    WindowSearchIndex index;
+    index.upsert(1, u"Report", u"word.exe");
+    index.upsert(2, u"Inbox", u"outlook.exe");
+    index.upsert(3, u"Repository", u"git.exe");
+    QCOMPARE(handles(index.search(u"re")), (std::vector<quintptr>{1, 3}));
+
+    // Removing the middle entry moves the matching last one into its place;
+    // the positions of the previous search must not be reused
+    index.remove(2);
+    QCOMPARE(handles(index.search(u"rep")), (std::vector<quintptr>{1, 3}));
+    index.remove(42);
+    QCOMPARE(index.size(), size_t(2));
+}
+
+void WindowSearchIndexTest::removeMovesLastEntryIntoHole()
+{
+    WindowSearchIndex index;
+    for (quintptr handle = 1; handle <= 5; ++handle)
+    {
+        index.upsert(handle, QStringLiteral("Window %1").arg(handle), u"app.exe");
+    }
+    index.remove(2);
+    index.remove(1);
+    QCOMPARE(index.size(), size_t(3));
+    QCOMPARE(handles(index.search(u"window")), (std::vector<quintptr>{3, 4, 5}));
+
+    // The moved entries are still addressed by their handles
+    index.upsert(5, u"Renamed", u"app.exe");
+    index.remove(4);
+    QCOMPARE(handles(index.search(u"window")), std::vector<quintptr>{3});
+    QCOMPARE(handles(index.search(u"renamed")), std::vector<quintptr>{5});
+    index.remove(3);
+    index.remove(5);
+    QCOMPARE(index.size(), size_t(0));
+    QVERIFY(index.search(u"window").empty());
+}
+
+QTEST_APPLESS_MAIN(WindowSearchIndexTest)
+#include "tst_windowsearchindex.moc"
@@ -0,0 +1,99 @@
+#include "windowsnapshot.h"
+#include <QTest>
+#include <initializer_list>
+#include <vector>
+
+class WindowSnapshotTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void identicalScansHaveNoDifferences();
+    void changedFlagIsReported();
+    void processAndIconChangesAreReported();
+    void mergeReportsAddedRemovedAndChanged();
+};
+
+namespace
+{
+    struct Window
+    {
+        quintptr handle;
+        quint32 processId;
+        quint32 iconId;
+        bool changed;
+    };
+
+    void fill(WindowSnapshot &snapshot, std::initializer_list<Window> windows)
+    {
+        snapshot.clear();
+        for (const Window &window : windows)
+        {
+            snapshot.append(window.handle, window.processId, window.iconId, window.changed);
+        }
+        snapshot.finalize();
+    }
+}
+
+void WindowSnapshotTest::identicalScansHaveNoDifferences()
+{
+    WindowSnapshot before;
+    WindowSnapshot after;
+    // Appended out of order, as EnumWindows reports them
+    fill(before, {{0x30, 1, 5, false}, {0x10, 1, 4, false}, {0x20, 2, 6, false}});
+    fill(after, {{0x10, 1, 4, false}, {0x30, 1, 5, false}, {0x20, 2, 6, false}});
+    QCOMPARE(after.handles(), (std::vector<quintptr>{0x10, 0x20, 0x30}));
+
+    SnapshotDiff diff;
+    WindowSnapshot::diff(before, after, diff);
+    QVERIFY(diff.isEmpty());
+}
+
+void WindowSnapshotTest::changedFlagIsReported()
+{
+    WindowSnapshot before;
+    WindowSnapshot after;
+    fill(before, {{0x10, 1, 4, false}, {0x20, 2, 6, false}});
+    // Same process and icon; only the scanner knows the title differs
+    fill(after, {{0x10, 1, 4, false}, {0x20, 2, 6, true}});
+
+    SnapshotDiff diff;
+    WindowSnapshot::diff(before, after, diff);
+    QCOMPARE(diff.changed, std::vector<quintptr>{0x20});
+    QVERIFY(diff.added.empty() && diff.removed.empty());
+
+    // The flag belongs to one scan; the next unchanged scan reports nothing
+    before.swap(after);
+    fill(after, {{0x10, 1, 4, false}, {0x20, 2, 6, false}});
+    WindowSnapshot::diff(before, after, diff);
+    QVERIFY(diff.isEmpty());
+}
+
+void WindowSnapshotTest::processAndIconChangesAreReported()
+{
+    WindowSnapshot before;
+    WindowSnapshot after;
+    fill(before, {{0x10, 1, 4, false}, {0x20, 2, 6, false}, {0x30, 3, 7, false}});
+    fill(after, {{0x10, 9, 4, false}, {0x20, 2, 8, false}, {0x30, 3, 7, false}});
+
+    SnapshotDiff diff;
+    WindowSnapshot::diff(before, after, diff);
+    QCOMPARE(diff.changed, (std::vector<quintptr>{0x10, 0x20}));
+}
+
+void WindowSnapshotTest::mergeReportsAddedRemovedAndChanged()
+{
+    WindowSnapshot before;
+    WindowSnapshot after;
+    fill(before, {{0x10, 1, 4, false}, {0x20, 2, 6, false}, {0x30, 3, 7, false}});
+    fill(after, {{0x20, 2, 6, true}, {0x30, 3, 9, false}, {0x40, 4, 1, true}});
+
+    SnapshotDiff diff;
+    WindowSnapshot::diff(before, after, diff);
+    QCOMPARE(diff.removed, std::vector<quintptr>{0x10});
+    QCOMPARE(diff.added, std::vector<quintptr>{0x40});
+    QCOMPARE(diff.changed, (std::vector<quintptr>{0x20, 0x30}));
+}
+
+QTEST_APPLESS_MAIN(WindowSnapshotTest)
+#include "tst_windowsnapshot.moc"